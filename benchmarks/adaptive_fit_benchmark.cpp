@@ -0,0 +1,69 @@
+/**
+ * Time of fit_composite_bezier_curve_adaptive from one thread to all hardware threads,
+ * and the number of curves it needs compared with evenly spaced joints.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/math/roots.h>
+#include <bezier/parallel.h>
+
+#include "benchmark.h"
+
+using Eigen::Vector2d;
+using Eigen::VectorXd;
+
+int main(){
+
+    const int n_points = 2000;
+    const double tolerance = 1e-2;
+
+    std::vector<VectorXd> data_points;
+    Eigen::MatrixXd points(2, n_points);
+    for(int i = 0; i < n_points; ++i){
+        double x = 20.0 * i / n_points;
+        data_points.push_back(Vector2d(x, std::sin(x)));
+        points.col(i) = data_points.back();
+    }
+
+    std::vector<unsigned int> thread_counts;
+    for(unsigned int threads = 1; threads < bezier::default_number_of_threads(); threads *= 2){
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(bezier::default_number_of_threads());
+    unsigned long adaptive_curves = 0;
+    for(unsigned int threads : thread_counts){
+        bezier::FitOptions options;
+        options.number_of_threads = threads;
+        double adaptive = benchmark::time([&](){
+            bezier::AdaptiveFit fit = bezier::fit_composite_bezier_curve_adaptive(data_points, tolerance, 3, false,
+                                                                                   options);
+            adaptive_curves = fit.joints.size() + 1;
+            benchmark::do_not_optimize(fit);
+        }, 1);
+        std::printf("  adaptive fit, %u threads: %.3f s, %lu curves\n", threads, adaptive, adaptive_curves);
+    }
+
+    // fewest evenly spaced curves within the tolerance, with the error of a data point measured to its own curve
+    for(int n = 1; n <= n_points / 4; ++n){
+        std::vector<int> joints;
+        for(int k = 1; k < n; ++k){
+            joints.push_back(k * n_points / n - 1);
+        }
+        bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, joints, 3, false);
+        double largest = 0;
+        for(int i = 0; i < n; ++i){
+            int first = i == 0 ? 0 : joints[i - 1] + 1;
+            int last = i + 1 < n ? joints[i] : n_points - 1;
+            for(int j = first; j <= last; ++j){
+                largest = std::max(largest, std::sqrt(bezier::closest_point(curve.power_coefficients(i),
+                                                                            points.col(j)).second));
+            }
+        }
+        if(largest <= tolerance){
+            std::printf("  evenly spaced joints: %d curves\n", n);
+            break;
+        }
+    }
+
+    return 0;
+}
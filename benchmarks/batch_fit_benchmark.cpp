@@ -0,0 +1,66 @@
+/**
+ * Scaling of fitting many independent datasets of very different sizes with
+ * fit_composite_bezier_curves from one thread to all hardware threads, compared
+ * with fitting the datasets one at a time.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/parallel.h>
+
+#include "benchmark.h"
+
+using Eigen::Vector2d;
+
+int main(){
+
+    const int n_datasets = 10000;
+
+    // noisy circles with 20 to about 600 data points
+    std::vector<bezier::FitDataset> batch;
+    long n_points = 0;
+    for(int i = 0; i < n_datasets; ++i){
+        bezier::FitDataset dataset;
+        int n = 20 + (i * i) % 577;
+        for(int j = 0; j < n; ++j){
+            double angle = 2 * M_PI * j / n;
+            dataset.data_points.push_back(Vector2d(std::cos(angle), std::sin(angle)) + 0.05 * Vector2d::Random());
+        }
+        for(int joint = 10; joint < n - 10; joint += 10){
+            dataset.joints.push_back(joint);
+        }
+        dataset.curve_degrees = {3};
+        dataset.closed_curve = true;
+        batch.push_back(dataset);
+        n_points += n;
+    }
+
+    std::printf("%d datasets, %ld data points, %u hardware threads\n", n_datasets, n_points,
+                bezier::default_number_of_threads());
+
+    double loop = benchmark::time([&](){
+        std::vector<bezier::CompositeBezierCurve> curves;
+        for(const bezier::FitDataset & dataset : batch){
+            curves.push_back(bezier::fit_composite_bezier_curve(dataset.data_points, dataset.joints,
+                                                                dataset.curve_degrees[0], dataset.closed_curve));
+        }
+        benchmark::do_not_optimize(curves);
+    }, 1);
+    benchmark::report("  fit_composite_bezier_curve per dataset", loop, n_datasets);
+
+    std::vector<unsigned int> thread_counts;
+    for(unsigned int threads = 1; threads < bezier::default_number_of_threads(); threads *= 2){
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(bezier::default_number_of_threads());
+    for(unsigned int threads : thread_counts){
+        bezier::FitOptions options;
+        options.number_of_threads = threads;
+        double batched = benchmark::time([&](){
+            std::vector<bezier::CompositeBezierCurve> curves = bezier::fit_composite_bezier_curves(batch, options);
+            benchmark::do_not_optimize(curves);
+        }, 1);
+        char name[64];
+        std::snprintf(name, sizeof(name), "  batch, %u threads (%.2fx)", threads, loop / batched);
+        benchmark::report(name, batched, n_datasets);
+    }
+}
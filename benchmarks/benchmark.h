@@ -0,0 +1,53 @@
+#ifndef BEZIER_BENCHMARK_H
+#define BEZIER_BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+
+namespace benchmark {
+
+    /**
+     * Measure the wall clock time of a function.
+     * The function is called once to warm up and then repeatedly,
+     * and the fastest run is reported.
+     * @param f : function to time
+     * @param repetitions : number of timed runs
+     * @return time in seconds of the fastest run
+     */
+    template <typename F>
+    double time(F f, int repetitions = 5){
+        f();
+        double best = -1;
+        for (int i = 0; i < repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto stop = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(stop - start).count();
+            if(best < 0 or elapsed < best){
+                best = elapsed;
+            }
+        }
+        return best;
+    }
+
+    /**
+     * Keep the compiler from optimizing away a computed value.
+     * @param value : value to keep
+     */
+    template <typename T>
+    void do_not_optimize(const T & value){
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * Print a result line on the form "<name>  <ns> ns/eval".
+     * @param name : name of the benchmark
+     * @param seconds : total time
+     * @param evaluations : number of evaluations during that time
+     */
+    inline void report(const char * name, double seconds, long evaluations){
+        std::printf("%-40s %10.2f ns/eval\n", name, 1e9 * seconds / evaluations);
+    }
+}
+
+#endif //BEZIER_BENCHMARK_H
@@ -0,0 +1,59 @@
+/**
+ * Compare evaluating a Bezier curve one parameter at a time with
+ * evaluating all parameters at once.
+ */
+
+#include <bezier/bezier.h>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+using Eigen::MatrixXd;
+
+int main(){
+
+    const int n_params = 1000000;
+    VectorXd ts = (VectorXd::Random(n_params).array() + 1) / 2;
+
+    for(int degree : {1, 3, 5}){
+        std::vector<VectorXd> control_points;
+        for (int i = 0; i < degree + 1; ++i) {
+            control_points.push_back(VectorXd::Random(2));
+        }
+        bezier::BezierCurve curve(control_points);
+
+        std::printf("degree %d, %d parameters\n", degree, n_params);
+
+        MatrixXd points(2, n_params);
+        double loop = benchmark::time([&](){
+            for (int j = 0; j < n_params; ++j) {
+                points.col(j) = curve(ts(j));
+            }
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  operator() per point", loop, n_params);
+
+        double batch = benchmark::time([&](){
+            points = curve.evaluate(ts);
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  evaluate(ts)", batch, n_params);
+
+        double sampled = benchmark::time([&](){
+            bezier::sample(&curve, points);
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  sample() uniform grid", sampled, n_params);
+
+        if(degree == 3){
+            bezier::CubicBezierCurve2d fixed(curve);
+            double fixed_loop = benchmark::time([&](){
+                for (int j = 0; j < n_params; ++j) {
+                    points.col(j) = fixed.evaluate(ts(j));
+                }
+                benchmark::do_not_optimize(points);
+            });
+            benchmark::report("  FixedBezierCurve<3, 2> per point", fixed_loop, n_params);
+        }
+    }
+}
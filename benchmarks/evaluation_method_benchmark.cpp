@@ -0,0 +1,76 @@
+/**
+ * Speed and accuracy of the Bezier curve evaluation methods.
+ * For each degree from 1 to 20 the time per evaluation and the maximum error
+ * against a long double de Casteljau reference are reported for each method.
+ */
+
+#include <bezier/bezier.h>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+
+typedef Eigen::Matrix<long double, Eigen::Dynamic, Eigen::Dynamic> MatrixXld;
+
+/**
+ * Reference evaluation with de Casteljau's algorithm in extended precision
+ */
+Eigen::Matrix<long double, Eigen::Dynamic, 1> reference(const MatrixXld & control_points, long double t){
+    MatrixXld points = control_points;
+    for (int r = 1; r < points.cols(); ++r) {
+        for (int i = 0; i < points.cols() - r; ++i) {
+            points.col(i) = (1 - t) * points.col(i) + t * points.col(i+1);
+        }
+    }
+    return points.col(0);
+}
+
+int main(){
+
+    const int n_params = 20000;
+    const int dimension = 2;
+    VectorXd ts = (VectorXd::Random(n_params).array() + 1) / 2;
+
+    const bezier::EvaluationMethod methods[] = {bezier::EvaluationMethod::Horner,
+                                                bezier::EvaluationMethod::DeCasteljau,
+                                                bezier::EvaluationMethod::Bernstein};
+
+    std::printf("%6s | %22s | %22s | %22s\n", "", "Horner", "DeCasteljau", "Bernstein");
+    std::printf("%6s | %10s %11s | %10s %11s | %10s %11s\n",
+                "degree", "ns/eval", "max error", "ns/eval", "max error", "ns/eval", "max error");
+
+    for(int degree = 1; degree <= 20; degree++){
+        std::vector<VectorXd> control_points;
+        MatrixXld control_matrix(dimension, degree + 1);
+        for (int i = 0; i < degree + 1; ++i) {
+            control_points.push_back(VectorXd::Random(dimension));
+            control_matrix.col(i) = control_points[i].cast<long double>();
+        }
+
+        MatrixXld expected(dimension, n_params);
+        for (int j = 0; j < n_params; ++j) {
+            expected.col(j) = reference(control_matrix, ts(j));
+        }
+
+        std::printf("%6d |", degree);
+        for(bezier::EvaluationMethod method : methods){
+            bezier::BezierCurve curve(control_points, method);
+
+            VectorXd point;
+            double seconds = benchmark::time([&](){
+                for (int j = 0; j < n_params; ++j) {
+                    point = curve(ts(j));
+                    benchmark::do_not_optimize(point);
+                }
+            });
+
+            long double max_error = 0;
+            for (int j = 0; j < n_params; ++j) {
+                long double error = (curve(ts(j)).cast<long double>() - expected.col(j)).cwiseAbs().maxCoeff();
+                max_error = std::max(max_error, error);
+            }
+            std::printf(" %10.2f %11.3Le |", 1e9 * seconds / n_params, max_error);
+        }
+        std::printf("\n");
+    }
+}
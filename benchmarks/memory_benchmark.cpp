@@ -0,0 +1,144 @@
+/**
+ * Compare the memory footprint of a composite Bezier curve in contiguous storage
+ * with holding one Bezier curve object per segment, and reading the segments
+ * through views with copying them out, and extending a curve segment by segment
+ * with rebuilding it.
+ */
+
+#include <bezier/bezier.h>
+
+#include <malloc.h>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+using Eigen::MatrixXd;
+
+/**
+ * Bytes currently allocated on the heap, including large blocks served by mmap
+ */
+size_t heap_in_use(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+template <typename F>
+size_t footprint(F f){
+    size_t before = heap_in_use();
+    f();
+    return heap_in_use() - before;
+}
+
+void report_footprint(const char * name, size_t bytes, long segments){
+    std::printf("%-40s %10.1f bytes/segment\n", name, static_cast<double>(bytes) / segments);
+}
+
+int main(){
+
+    const int n_params = 1000000;
+    VectorXd ts = (VectorXd::Random(n_params).array() + 1) / 2;
+
+    for(int n_segments : {1000, 100000}){
+        std::vector<std::vector<VectorXd>> control_points;
+        VectorXd joint = VectorXd::Random(2);
+        for(int i = 0; i < n_segments; ++i){
+            std::vector<VectorXd> segment = {joint, VectorXd::Random(2), VectorXd::Random(2), VectorXd::Random(2)};
+            joint = segment.back();
+            control_points.push_back(segment);
+        }
+
+        std::printf("%d cubic segments in 2D\n", n_segments);
+
+        std::vector<bezier::BezierCurve> * bezier_curves = nullptr;
+        size_t per_curve = footprint([&](){
+            bezier_curves = new std::vector<bezier::BezierCurve>(control_points.begin(), control_points.end());
+        });
+        report_footprint("  vector<BezierCurve>", per_curve, n_segments);
+
+        bezier::CompositeBezierCurve * composite = nullptr;
+        size_t contiguous = footprint([&](){
+            composite = new bezier::CompositeBezierCurve(control_points);
+        });
+        report_footprint("  CompositeBezierCurve", contiguous, n_segments);
+        std::printf("%-40s %10.1f x\n", "  reduction", static_cast<double>(per_curve) / contiguous);
+
+        VectorXd point(2);
+        double separate = benchmark::time([&](){
+            for(int j = 0; j < n_params; ++j){
+                std::pair<int, double> local_param = bezier::global_to_local_param(ts(j), n_segments);
+                (*bezier_curves)[local_param.first].evaluate_into(local_param.second, point);
+                benchmark::do_not_optimize(point);
+            }
+        });
+        benchmark::report("  vector<BezierCurve> evaluate_into", separate, n_params);
+
+        double flat = benchmark::time([&](){
+            for(int j = 0; j < n_params; ++j){
+                composite->evaluate_into(ts(j), point);
+                benchmark::do_not_optimize(point);
+            }
+        });
+        benchmark::report("  CompositeBezierCurve evaluate_into", flat, n_params);
+
+        double bounds = benchmark::time([&](){
+            std::array<VectorXd, 2> b = composite->bounds();
+            benchmark::do_not_optimize(b);
+        });
+        benchmark::report("  CompositeBezierCurve bounds per segment", bounds, n_segments);
+
+        // read every control point as a render pass does
+        double copied = benchmark::time([&](){
+            VectorXd sum = VectorXd::Zero(2);
+            for(const bezier::BezierCurve & curve : composite->bezier_curves()){
+                for(const VectorXd & control_point : curve.control_points()){
+                    sum += control_point;
+                }
+            }
+            benchmark::do_not_optimize(sum);
+        });
+        benchmark::report("  bezier_curves() walk per segment", copied, n_segments);
+
+        double viewed = benchmark::time([&](){
+            VectorXd sum = VectorXd::Zero(2);
+            for(const bezier::CompositeBezierCurve::Segment & segment : composite->segments()){
+                sum += segment.control_points().rowwise().sum();
+            }
+            benchmark::do_not_optimize(sum);
+        });
+        benchmark::report("  segments() walk per segment", viewed, n_segments);
+
+        // extend a curve one segment at a time as a sensor stream does
+        double appended = benchmark::time([&](){
+            bezier::CompositeBezierCurve streamed({control_points[0]});
+            for(int i = 1; i < n_segments; ++i){
+                streamed.append_segment(control_points[i]);
+            }
+            benchmark::do_not_optimize(streamed);
+        }, 1);
+        benchmark::report("  append_segment per segment", appended, n_segments);
+
+        double ring = benchmark::time([&](){
+            bezier::CompositeBezierCurve window({control_points[0]});
+            window.set_max_number_of_curves(100);
+            for(int i = 1; i < n_segments; ++i){
+                window.append_segment(control_points[i]);
+            }
+            benchmark::do_not_optimize(window);
+        }, 1);
+        benchmark::report("  append_segment, 100 segment window", ring, n_segments);
+
+        if(n_segments <= 1000){
+            double rebuilt = benchmark::time([&](){
+                for(int i = 1; i < n_segments; ++i){
+                    std::vector<std::vector<VectorXd>> prefix(control_points.begin(), control_points.begin() + i + 1);
+                    bezier::CompositeBezierCurve streamed(prefix);
+                    benchmark::do_not_optimize(streamed);
+                }
+            }, 1);
+            benchmark::report("  rebuild per segment", rebuilt, n_segments);
+        }
+
+        delete bezier_curves;
+        delete composite;
+    }
+}
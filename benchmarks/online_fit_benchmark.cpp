@@ -0,0 +1,56 @@
+/**
+ * Cost per data point of fitting a stream of data points with OnlineCompositeFitter
+ * after streams of increasing length, compared with fitting all data points so far
+ * with fit_composite_bezier_curve for every new data point.
+ */
+
+#include <bezier/bezier.h>
+
+#include "benchmark.h"
+
+using Eigen::Vector2d;
+using Eigen::VectorXd;
+
+int main(){
+
+    const int points_per_curve = 20;
+    const int window_size = 8;
+    const int n_timed = 2000;
+
+    std::vector<VectorXd> stream;
+    for(int i = 0; i < 200000 + n_timed; ++i){
+        double t = 0.01 * i;
+        stream.push_back(Vector2d(t, std::sin(t)) + 0.01 * Vector2d::Random());
+    }
+
+    for(int history : {1000, 10000, 100000, 200000}){
+        bezier::OnlineCompositeFitter fitter(3, points_per_curve, window_size);
+        fitter.add_points(std::vector<VectorXd>(stream.begin(), stream.begin() + history));
+        auto start = std::chrono::steady_clock::now();
+        for(int i = history; i < history + n_timed; ++i){
+            fitter.add_point(stream[i]);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        benchmark::do_not_optimize(fitter);
+        char name[64];
+        std::snprintf(name, sizeof(name), "  online, history %d", history);
+        benchmark::report(name, elapsed, n_timed);
+    }
+
+    for(int history : {1000, 10000}){
+        std::vector<int> joints;
+        for(int joint = points_per_curve - 1; joint < history - 1; joint += points_per_curve){
+            joints.push_back(joint);
+        }
+        std::vector<VectorXd> data_points(stream.begin(), stream.begin() + history);
+        double refit = benchmark::time([&](){
+            bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, joints, 3, false);
+            benchmark::do_not_optimize(curve);
+        }, 3);
+        char name[64];
+        std::snprintf(name, sizeof(name), "  full refit, history %d", history);
+        benchmark::report(name, refit, 1);
+    }
+
+    return 0;
+}
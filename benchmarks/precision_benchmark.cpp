@@ -0,0 +1,73 @@
+/**
+ * Compare the throughput of single and double precision curves
+ * for evaluation, sampling and fitting.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/math/horner.h>
+
+#include "benchmark.h"
+
+template <typename Scalar>
+void run(const char * name){
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Vector;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+    const int n_params = 1000000;
+    Vector ts = (Vector::Random(n_params).array() + 1) / 2;
+
+    std::vector<Vector> control_points;
+    for (int i = 0; i < 4; ++i) {
+        control_points.push_back(Vector::Random(3));
+    }
+    bezier::BasicBezierCurve<Scalar> cubic(control_points);
+
+    std::printf("%s, cubic in 3D, %d parameters, %zu bytes per control point\n",
+                name, n_params, 3 * sizeof(Scalar));
+
+    Matrix points(3, n_params);
+    double into = benchmark::time([&](){
+        for (int j = 0; j < n_params; ++j) {
+            cubic.evaluate_into(ts(j), points.col(j));
+        }
+        benchmark::do_not_optimize(points);
+    });
+    benchmark::report("  evaluate_into(t, point)", into, n_params);
+
+    Matrix soa_points(n_params, 3);
+    double vectorized = benchmark::time([&](){
+        cubic.evaluate_vectorized(ts, soa_points);
+        benchmark::do_not_optimize(soa_points);
+    });
+    benchmark::report("  evaluate_vectorized(ts, points)", vectorized, n_params);
+
+    double sampled = benchmark::time([&](){
+        bezier::sample(&cubic, points);
+        benchmark::do_not_optimize(points);
+    });
+    benchmark::report("  sample() uniform grid", sampled, n_params);
+
+    const int n_points = 10000;
+    std::vector<Vector> data;
+    std::vector<int> joints;
+    for (int i = 0; i < n_points; ++i) {
+        Scalar x = static_cast<Scalar>(i) / n_points * 100;
+        Vector point(2);
+        point << x, std::sin(x);
+        data.push_back(point);
+        if(i > 0 and i % 50 == 0){
+            joints.push_back(i);
+        }
+    }
+    double fitted = benchmark::time([&](){
+        bezier::BasicCompositeBezierCurve<Scalar> curve = bezier::fit_composite_bezier_curve(data, joints, 3, false);
+        benchmark::do_not_optimize(curve);
+    });
+    benchmark::report("  fit_composite_bezier_curve per point", fitted, n_points);
+}
+
+int main(){
+    std::printf("instruction set: %s\n", bezier::horner_batch_instruction_set());
+    run<double>("double");
+    run<float>("float");
+}
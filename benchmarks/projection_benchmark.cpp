@@ -0,0 +1,72 @@
+/**
+ * Compare projecting points onto composite Bezier curves with project, which prunes the
+ * Bezier curves with a bounding box hierarchy and runs on several threads, with computing
+ * the closest point on every Bezier curve.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/math/roots.h>
+#include <bezier/parallel.h>
+
+#include <limits>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+using Eigen::MatrixXd;
+
+int main(){
+
+    const int n_points = 100000;
+
+    std::printf("hardware threads: %u\n", bezier::default_number_of_threads());
+
+    for(int n_segments : {10, 1000, 100000}){
+        // random walk such that consecutive cubics are close to each other
+        std::vector<std::vector<VectorXd>> control_points;
+        VectorXd joint = VectorXd::Zero(2);
+        for(int i = 0; i < n_segments; ++i){
+            std::vector<VectorXd> segment = {joint};
+            for(int j = 0; j < 3; ++j){
+                segment.push_back(segment.back() + VectorXd::Random(2));
+            }
+            joint = segment.back();
+            control_points.push_back(segment);
+        }
+        bezier::CompositeBezierCurve composite(control_points);
+        std::array<VectorXd, 2> bounds = composite.bounds();
+        MatrixXd points = (MatrixXd::Random(2, n_points).array() + 1) / 2;
+        points = (points.array().colwise() * (bounds[1] - bounds[0]).array()).colwise() + bounds[0].array();
+
+        std::printf("composite of %d cubics in 2D, %d points\n", n_segments, n_points);
+
+        if(n_segments <= 1000){
+            double brute_force = benchmark::time([&](){
+                VectorXd distances(n_points);
+                for(int j = 0; j < n_points; ++j){
+                    distances(j) = std::numeric_limits<double>::infinity();
+                    for(auto segment : composite.segments()){
+                        distances(j) = std::min(distances(j),
+                                bezier::closest_point(segment.power_coefficients(), points.col(j)).second);
+                    }
+                }
+                benchmark::do_not_optimize(distances);
+            }, 1);
+            benchmark::report("  closest point on every segment", brute_force, n_points);
+        }
+
+        std::vector<unsigned int> thread_counts = {1};
+        if(bezier::default_number_of_threads() > 1){
+            thread_counts.push_back(bezier::default_number_of_threads());
+        }
+        for(unsigned int threads : thread_counts){
+            double project = benchmark::time([&](){
+                std::vector<bezier::CompositeBezierCurve::Projection> projections = composite.project(points, threads);
+                benchmark::do_not_optimize(projections);
+            });
+            char name[64];
+            std::snprintf(name, sizeof(name), "  project, %u threads", threads);
+            benchmark::report(name, project, n_points);
+        }
+    }
+}
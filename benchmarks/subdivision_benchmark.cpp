@@ -0,0 +1,97 @@
+/**
+ * Time splitting, degree elevation and degree reduction, both with the allocation free
+ * kernels on control point matrices and with the curve classes which construct new curves.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/math/subdivision.h>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+using Eigen::MatrixXd;
+
+int main(){
+
+    const int n_repetitions = 100000;
+
+    for(int degree : {3, 5, 9}){
+        MatrixXd points = MatrixXd::Random(2, degree + 1);
+        std::vector<VectorXd> control_points;
+        for(int j = 0; j < degree + 1; ++j){
+            control_points.push_back(points.col(j));
+        }
+        bezier::BezierCurve curve(control_points);
+
+        std::printf("degree %d in 2D\n", degree);
+
+        MatrixXd left(2, degree + 1), right(2, degree + 1);
+        double split = benchmark::time([&](){
+            for(int i = 0; i < n_repetitions; ++i){
+                bezier::split_control_points(points, 0.3, left, right);
+                benchmark::do_not_optimize(left);
+            }
+        });
+        benchmark::report("  split_control_points", split, n_repetitions);
+
+        double split_curve = benchmark::time([&](){
+            for(int i = 0; i < n_repetitions / 10; ++i){
+                std::array<bezier::BezierCurve, 2> parts = curve.split(0.3);
+                benchmark::do_not_optimize(parts);
+            }
+        });
+        benchmark::report("  BezierCurve::split", split_curve, n_repetitions / 10);
+
+        MatrixXd elevated(2, degree + 2);
+        double elevate = benchmark::time([&](){
+            for(int i = 0; i < n_repetitions; ++i){
+                bezier::elevate_control_points(points, elevated);
+                benchmark::do_not_optimize(elevated);
+            }
+        });
+        benchmark::report("  elevate_control_points by one", elevate, n_repetitions);
+
+        MatrixXd reduced(2, degree);
+        double reduce = benchmark::time([&](){
+            for(int i = 0; i < n_repetitions; ++i){
+                double error = bezier::reduce_control_points(points, reduced);
+                benchmark::do_not_optimize(error);
+            }
+        });
+        benchmark::report("  reduce_control_points by one", reduce, n_repetitions);
+    }
+
+    const int n_segments = 100000;
+    std::vector<std::vector<VectorXd>> control_points;
+    VectorXd joint = VectorXd::Random(2);
+    for(int i = 0; i < n_segments; ++i){
+        std::vector<VectorXd> segment = {joint};
+        for(int j = 0; j < 1 + i % 3; ++j){
+            segment.push_back(VectorXd::Random(2));
+        }
+        joint = segment.back();
+        control_points.push_back(segment);
+    }
+    bezier::CompositeBezierCurve composite(control_points);
+
+    std::printf("composite of %d curves of degree 1 to 3 in 2D\n", n_segments);
+
+    double elevate = benchmark::time([&](){
+        bezier::CompositeBezierCurve cubics = composite.elevate_degree(3);
+        benchmark::do_not_optimize(cubics);
+    }, 3);
+    benchmark::report("  elevate_degree(3) per curve", elevate, n_segments);
+
+    bezier::CompositeBezierCurve cubics = composite.elevate_degree(3);
+    double reduce = benchmark::time([&](){
+        bezier::CompositeBezierCurve reduced = cubics.reduce_degree(1e-12);
+        benchmark::do_not_optimize(reduced);
+    }, 3);
+    benchmark::report("  reduce_degree(1e-12) per curve", reduce, n_segments);
+
+    double split = benchmark::time([&](){
+        std::array<bezier::CompositeBezierCurve, 2> parts = composite.split(0.5);
+        benchmark::do_not_optimize(parts);
+    }, 3);
+    benchmark::report("  split(0.5) per curve", split, n_segments);
+}
@@ -0,0 +1,82 @@
+/**
+ * Compare the SIMD batch evaluation of cubic Bezier curves, and of composite
+ * Bezier curves at sorted parameters, with evaluating one parameter at a time.
+ */
+
+#include <bezier/bezier.h>
+#include <bezier/math/horner.h>
+
+#include "benchmark.h"
+
+using Eigen::VectorXd;
+using Eigen::MatrixXd;
+
+int main(){
+
+    const int n_params = 1000000;
+    VectorXd ts = (VectorXd::Random(n_params).array() + 1) / 2;
+
+    std::printf("instruction set: %s\n", bezier::horner_batch_instruction_set());
+
+    for(int dimension : {2, 3}){
+        std::vector<VectorXd> control_points;
+        for (int i = 0; i < 4; ++i) {
+            control_points.push_back(VectorXd::Random(dimension));
+        }
+        bezier::BezierCurve cubic(control_points);
+
+        std::printf("cubic in %dD, %d parameters\n", dimension, n_params);
+
+        MatrixXd points(dimension, n_params);
+        double loop = benchmark::time([&](){
+            for (int j = 0; j < n_params; ++j) {
+                points.col(j) = cubic(ts(j));
+            }
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  operator() per point", loop, n_params);
+
+        double batch = benchmark::time([&](){
+            points = cubic.evaluate(ts);
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  evaluate(ts)", batch, n_params);
+
+        MatrixXd soa_points(n_params, dimension);
+        double vectorized = benchmark::time([&](){
+            cubic.evaluate_vectorized(ts, soa_points);
+            benchmark::do_not_optimize(soa_points);
+        });
+        benchmark::report("  evaluate_vectorized(ts, points)", vectorized, n_params);
+    }
+
+    VectorXd sorted_ts = VectorXd::LinSpaced(n_params, 0, 1);
+    for(int n_segments : {10, 1000, 100000}){
+        std::vector<std::vector<VectorXd>> control_points;
+        VectorXd joint = VectorXd::Random(2);
+        for(int i = 0; i < n_segments; ++i){
+            std::vector<VectorXd> segment = {joint, VectorXd::Random(2), VectorXd::Random(2), VectorXd::Random(2)};
+            joint = segment.back();
+            control_points.push_back(segment);
+        }
+        bezier::CompositeBezierCurve composite(control_points);
+
+        std::printf("composite of %d cubics in 2D, %d sorted parameters\n", n_segments, n_params);
+
+        MatrixXd points(2, n_params);
+        double loop = benchmark::time([&](){
+            for (int j = 0; j < n_params; ++j) {
+                composite.evaluate_into(sorted_ts(j), points.col(j));
+            }
+            benchmark::do_not_optimize(points);
+        });
+        benchmark::report("  evaluate_into per point", loop, n_params);
+
+        MatrixXd soa_points(n_params, 2);
+        double sorted = benchmark::time([&](){
+            composite.evaluate_sorted(sorted_ts, soa_points);
+            benchmark::do_not_optimize(soa_points);
+        });
+        benchmark::report("  evaluate_sorted(ts, points)", sorted, n_params);
+    }
+}
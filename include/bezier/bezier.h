@@ -3,7 +3,9 @@
 
 #include <bezier/bezier_curve.h>
 #include <bezier/composite_bezier_curve.h>
+#include <bezier/fixed_bezier_curve.h>
 #include <bezier/fit_composite_bezier_curve.h>
+#include <bezier/online_composite_fitter.h>
 #include <bezier/postscript/bezier_postscript.h>
 #include <bezier/postscript/postscript.h>
 
@@ -1,10 +1,12 @@
 #ifndef BEZIER_BEZIER_CURVE_H
 #define BEZIER_BEZIER_CURVE_H
 
+#include <memory>
 #include <vector>
 #include <Eigen/Dense>
 
 #include <bezier/curve.h>
+#include <bezier/math/arc_length.h>
 #include <bezier/math/misc.h>
 
 
@@ -13,8 +15,41 @@ namespace bezier {
     using Eigen::VectorXd;
     using Eigen::MatrixXd;
 
+    /**
+     * Compute the coefficient matrix C of an n-degree Bezier curve, where
+     *
+     * C(j, i) = (-1)^(i+j) (n choose j) (j choose i) for i <= j and 0 otherwise.
+     *
+     * The binomial coefficients are taken from Pascal's triangle and are exact.
+     * @param degree : n
+     * @return coefficient matrix in R^(n+1 x n+1)
+     */
     Eigen::MatrixXd bezier_coefficients(int degree);
 
+    /**
+     * Retrieve the coefficient matrix of an n-degree Bezier curve from a process-wide cache.
+     * Each matrix is computed on first use and is kept for the lifetime of the program,
+     * so the returned reference stays valid and can be shared between curves.
+     * Safe to call concurrently from multiple threads.
+     * @tparam Scalar : float or double, each scalar type has its own cache
+     * @param degree : n
+     * @return coefficient matrix in R^(n+1 x n+1)
+     */
+    template <typename Scalar = double>
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> & cached_bezier_coefficients(int degree);
+
+    /**
+     * Methods for evaluating a Bezier curve.
+     */
+    enum class EvaluationMethod {
+        Horner,         // Horner's scheme on the power basis coefficients C * P. Fastest, but the
+                        // power basis is ill-conditioned and loses precision as the degree grows.
+        DeCasteljau,    // repeated linear interpolation of the control points. Numerically stable,
+                        // O(n^2 d) per evaluation.
+        Bernstein       // sum of the Bernstein polynomials with precomputed binomial coefficients.
+                        // O(n d) per evaluation and stable for moderate degrees.
+    };
+
     /**
      * Bezier curve class.
      * An n-degree Bezier curve is a function B:[0,1]->R^d which defined by n+1 control points in R^d.
@@ -31,30 +66,54 @@ namespace bezier {
      * P = (P_0, P_1, P_2, ... , P_n) in R^(n+1 x d)
      *
      * where P_i in R^d is control point i.
+     *
+     * @tparam Scalar : scalar type of the control points, float or double. Explicitly
+     * instantiated for both, see the BezierCurve and BezierCurvef typedefs.
      */
-    class BezierCurve : public Curve {
+    template <typename Scalar>
+    class BasicBezierCurve : public BasicCurve<Scalar> {
     public:
+        typedef typename BasicCurve<Scalar>::Vector Vector;
+        typedef typename BasicCurve<Scalar>::Matrix Matrix;
+
         /**
          * Construct the Bezier curve.
          * The degree and dimension are implictly derived from the arguments.
          * If a list of n+1 control points in R^d is supplied, then an n-degree
          * Bezier curve from [0,1]->R^d will be constructed.
          * @param control_points : control points defining the curve
+         * @param evaluation_method : method used to evaluate the curve
+         */
+        explicit BasicBezierCurve(const vector<Vector> & control_points,
+                                  EvaluationMethod evaluation_method = EvaluationMethod::Horner);
+
+        /**
+         * Construct the Bezier curve, the control points are moved in instead of copied.
+         * @param control_points : control points defining the curve
+         * @param evaluation_method : method used to evaluate the curve
          */
-        explicit BezierCurve(const vector<VectorXd> & control_points);
-        BezierCurve(const std::initializer_list<VectorXd> & control_points);
+        explicit BasicBezierCurve(vector<Vector> && control_points,
+                                  EvaluationMethod evaluation_method = EvaluationMethod::Horner);
+        BasicBezierCurve(const std::initializer_list<Vector> & control_points);
 
         /**
-         * Retrieve the control points
+         * Retrieve the control points without copying
          * @return control points
          */
-        vector<VectorXd> control_points() const;
+        const vector<Vector> & control_points() const;
 
         /**
-         * Retrieve the coefficient matrix.
+         * Retrieve the coefficient matrix without copying, shared by all curves of the same degree.
          * @return coefficient matrix in R^(n+1 x n+1)
          */
-        MatrixXd coefficient_matrix() const;
+        const Matrix & coefficient_matrix() const;
+
+        /**
+         * Retrieve the power basis coefficients, i.e. the curve written as
+         * B(t) = A_0 + A_1 t + ... + A_n t^n.
+         * @return (C * P)^T = (A_0, A_1, ..., A_n) in R^(d x n+1)
+         */
+        const Matrix & power_coefficients() const;
 
         /**
          * Retrieve the degree of the Bezier curve
@@ -68,28 +127,204 @@ namespace bezier {
          */
         unsigned int dimension() const override;
 
+        /**
+         * Retrieve the method used to evaluate the curve
+         * @return evaluation method
+         */
+        EvaluationMethod evaluation_method() const;
+
+        /**
+         * Set the method used to evaluate the curve
+         * @param evaluation_method : evaluation method
+         */
+        void set_evaluation_method(EvaluationMethod evaluation_method);
+
         /**
          * Evaluate the Bezier curve at t
+         * By default uses Horner's scheme on the power basis coefficients C * P, which are
+         * computed once at construction. The end points are returned exactly.
+         * @param t : parameter value
+         * @return vector in R^d
+         */
+        Vector operator()(Scalar t) const override;
+
+        /**
+         * Evaluate the Bezier curve at t into caller owned storage without allocating.
+         * Agrees exactly with operator().
+         * @param t : parameter value
+         * @param out : vector in R^d
+         */
+        void evaluate_into(Scalar t, Eigen::Ref<Vector> out) const override;
+        using BasicCurve<Scalar>::evaluate_into;
+
+        /**
+         * Evaluate the Bezier curve at several parameter values at once.
+         * With the Horner method the power matrix of all parameters is built once and multiplied
+         * with the precomputed power basis coefficients in a single matrix product.
+         * @param ts : parameter values in [0,1]
+         * @return matrix in R^(d x m) where column j is the curve evaluated at ts(j)
+         */
+        Matrix evaluate(const Vector & ts) const;
+
+        /**
+         * Evaluate the Bezier curve at several parameter values with a SIMD kernel.
+         * Horner's scheme is run on several parameters per instruction, see horner_batch.
+         * The output uses a structure of arrays layout, i.e. each coordinate is contiguous.
+         * The curve's evaluation method is not used.
+         * @param ts : m parameter values in [0,1]
+         * @param points : output in R^(m x d), column i holds coordinate i of all points
+         */
+        void evaluate_vectorized(const Eigen::Ref<const Vector> & ts, Eigen::Ref<Matrix> points) const;
+
+        /**
+         * Evaluate a derivative of the Bezier curve at t.
+         * Uses the power basis coefficients of the hodographs, which are computed at construction.
          * @param t : parameter value
+         * @param order : order of the derivative, 0 evaluates the curve itself
          * @return vector in R^d
          */
-        VectorXd operator()(double t) const override;
+        Vector derivative(Scalar t, unsigned int order = 1) const;
 
         /**
-         * Estimated bounds of the Bezier curve.
-         * Computed from the mininum and maximum values of the control points in each
-         * dimension, which are known to contain the curve.
-         * @return {lower bound, upper bound)
+         * Evaluate a derivative of the Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @param order : order of the derivative
+         * @return matrix in R^(d x m) where column j is the derivative at ts(j)
          */
-        std::array<Eigen::VectorXd, 2> bounds() const override;
+        Matrix derivative(const Vector & ts, unsigned int order = 1) const;
+
+        /**
+         * Evaluate the unit tangent of the Bezier curve at t.
+         * Where the first derivative vanishes the direction of the first non-vanishing
+         * derivative is used. A constant curve has the zero vector as tangent.
+         * @param t : parameter value
+         * @return vector in R^d
+         */
+        Vector tangent(Scalar t) const;
+
+        /**
+         * Evaluate the unit tangent of the Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @return matrix in R^(d x m) where column j is the tangent at ts(j)
+         */
+        Matrix tangent(const Vector & ts) const;
+
+        /**
+         * Evaluate the curvature of the Bezier curve at t
+         *
+         * k = sqrt(|B'|^2 |B''|^2 - (B' . B'')^2) / |B'|^3
+         *
+         * which holds in any dimension. Infinity is returned where the first derivative vanishes.
+         * @param t : parameter value
+         * @return curvature
+         */
+        Scalar curvature(Scalar t) const;
+
+        /**
+         * Evaluate the curvature of the Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @return vector in R^m where element j is the curvature at ts(j)
+         */
+        Vector curvature(const Vector & ts) const;
+
+        /**
+         * Tight bounds of the Bezier curve.
+         * Each coordinate attains its extrema at the end points or where its derivative vanishes,
+         * see polynomial_bounds. Computed once at construction.
+         * @return {lower bound, upper bound}
+         */
+        std::array<Vector, 2> bounds() const override;
+
+        /**
+         * Tight bounds of the Bezier curve on a sub interval.
+         * @param t0 : start of the interval in [0,1]
+         * @param t1 : end of the interval in [t0,1]
+         * @return {lower bound, upper bound}
+         */
+        std::array<Vector, 2> bounds(Scalar t0, Scalar t1) const;
+
+        /**
+         * Arc length of the Bezier curve.
+         * Computed with Gauss-Legendre quadrature on bracketed pieces into a lookup table on first use, see
+         * ArcLengthTable for the error bound. Copies of the curve share the table.
+         * @return arc length
+         */
+        Scalar length() const;
+
+        /**
+         * Bound of the error of length(), see ArcLengthTable.
+         * @return sum of the widths of the arc length brackets of the pieces
+         */
+        Scalar length_error() const;
+
+        /**
+         * Arc length of the Bezier curve between two parameters.
+         * @param t0 : start of the interval in [0,1]
+         * @param t1 : end of the interval in [t0,1]
+         * @return arc length
+         */
+        Scalar length(Scalar t0, Scalar t1) const;
+
+        /**
+         * Parameter at which the arc length from the start of the Bezier curve is s,
+         * i.e. the inverse of length(0, t).
+         * @param s : arc length in [0, length()]
+         * @return parameter value in [0,1]
+         */
+        Scalar param_at_length(Scalar s) const;
+
+        /**
+         * Parameters at several arc lengths, see param_at_length.
+         * @param lengths : arc lengths in [0, length()]
+         * @return vector in R^m where element j is the parameter at lengths(j)
+         */
+        Vector param_at_length(const Vector & lengths) const;
+
+        /**
+         * Split the Bezier curve at t with de Casteljau's algorithm
+         * @param t : parameter in [0,1]
+         * @return {curve on [0,t], curve on [t,1]}, both reparameterized to [0,1]
+         */
+        std::array<BasicBezierCurve, 2> split(Scalar t) const;
+
+        /**
+         * Elevate the degree of the Bezier curve, the curve itself is unchanged
+         * @param degree : new degree, at least n
+         * @return Bezier curve of the given degree
+         */
+        BasicBezierCurve elevate_degree(unsigned int degree) const;
+
+        /**
+         * Reduce the degree of the Bezier curve as far as a tolerance allows, see reduce_control_points.
+         * The end points are kept.
+         * @param tolerance : bound on the distance between the curves at equal parameters
+         * @return Bezier curve of the lowest degree within the tolerance
+         */
+        BasicBezierCurve reduce_degree(Scalar tolerance) const;
 
     private:
         unsigned int _degree;
         unsigned int _dimension;
-        vector<VectorXd> _control_points;
-        MatrixXd _coefficient_matrix;
-        MatrixXd _control_matrix;
+        vector<Vector> _control_points;
+        const Matrix * _coefficient_matrix; // shared, see cached_bezier_coefficients
+        Matrix _control_matrix;
+        Matrix _power_coefficients; // (C * P)^T in R^(d x n+1)
+        vector<Matrix> _hodographs; // power basis coefficients of derivative k+1 in R^(d x n-k)
+        std::array<Vector, 2> _bounds;
+        mutable std::shared_ptr<ArcLengthTable> _arc_length_table; // built on first use
+        EvaluationMethod _evaluation_method;
+
+        std::shared_ptr<const ArcLengthTable> arc_length_table() const;
+        void horner(Scalar t, Eigen::Ref<Vector> out) const;
+        void de_casteljau(Scalar t, Eigen::Ref<Vector> out) const;
+        void bernstein(Scalar t, Eigen::Ref<Vector> out) const;
     };
+
+    typedef BasicBezierCurve<double> BezierCurve;
+    typedef BasicBezierCurve<float> BezierCurvef;
+
+    extern template class BasicBezierCurve<double>;
+    extern template class BasicBezierCurve<float>;
 }
 
 
@@ -1,36 +1,261 @@
 #ifndef BEZIER_COMPOSITE_BEZIER_CURVE_H
 #define BEZIER_COMPOSITE_BEZIER_CURVE_H
 
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 
 #include <bezier/curve.h>
 #include <bezier/bezier_curve.h>
+#include <bezier/math/box_tree.h>
 
 namespace bezier {
 
     using std::vector;
     using Eigen::VectorXd;
+    using Eigen::MatrixXd;
 
     /**
      * Composite Bezier curve class.
      * A composite Bezier curve is a piecewise Bezier curve which is at least C^0 continuous.
      * It is here defined as a function B:[0,1]->R^d similarly to the Bezier curve parameterization.
+     *
+     * The control points of all Bezier curves are stored in a single contiguous d x N matrix where
+     * each joint is stored once, i.e. curve i of degree n_i uses the columns
+     * offsets[i], ..., offsets[i] + n_i and N = 1 + sum n_i. The power basis coefficients are kept
+     * in a second contiguous buffer. Evaluation works directly on these buffers and the curves are
+     * always evaluated with Horner's scheme. The tight bounds of each curve are computed once at
+     * construction, see polynomial_bounds.
+     *
+     * By default each Bezier curve covers an equal share 1/n of the domain. Optionally a knot vector
+     * 0 = k_0 < k_1 < ... < k_n = 1 can be given, e.g. the cumulative chord length, in which case
+     * curve i covers [k_i, k_(i+1)]. The curve containing t is then found with a binary search,
+     * which is narrowed down by a table of uniform buckets when there are many curves.
+     *
+     * Curves can be appended at the end and removed from the front in amortized constant time, e.g. to
+     * build a curve from streaming data. The buffers keep spare capacity and removed curves are only
+     * dropped once they take up as much space as the remaining ones. The bounds are maintained with
+     * a sliding window over the bounds of each curve. Optionally the number of curves can be limited,
+     * in which case the composite curve acts as a ring buffer which drops the oldest curve.
+     * @tparam Scalar : scalar type of the control points, float or double
      */
-    class CompositeBezierCurve : public Curve{
+    template <typename Scalar>
+    class BasicCompositeBezierCurve : public BasicCurve<Scalar> {
     public:
+        typedef typename BasicCurve<Scalar>::Vector Vector;
+        typedef typename BasicCurve<Scalar>::Matrix Matrix;
+
+        /**
+         * View of one of the Bezier curves of a composite Bezier curve.
+         * Refers to the contiguous storage of the composite curve, nothing is copied. Only valid as long
+         * as the composite curve is alive and unmodified.
+         */
+        class Segment {
+        public:
+            Segment(const BasicCompositeBezierCurve & composite, unsigned int index) :
+                    _composite(&composite), _index(index) {}
+
+            /**
+             * Retrieve the index of the Bezier curve in the composite curve
+             * @return i
+             */
+            unsigned int index() const { return _index; }
+
+            /**
+             * Retrieve the degree of the Bezier curve
+             * @return n
+             */
+            unsigned int degree() const { return _composite->degree(_index); }
+
+            /**
+             * Retrieve the output dimension of the Bezier curve
+             * @return d
+             */
+            unsigned int dimension() const { return _composite->_dimension; }
+
+            /**
+             * Retrieve the control points without copying
+             * @return matrix in R^(d x n+1) where column i is control point i
+             */
+            typename Matrix::ConstColsBlockXpr control_points() const {
+                return _composite->_control_points.middleCols(_composite->_offsets[_composite->_first_curve + _index],
+                                                              degree() + 1);
+            }
+
+            /**
+             * Retrieve the coefficient matrix, shared by all curves of the same degree
+             * @return coefficient matrix in R^(n+1 x n+1)
+             */
+            const Matrix & coefficient_matrix() const { return cached_bezier_coefficients<Scalar>(degree()); }
+
+            /**
+             * Retrieve the power basis coefficients without copying
+             * @return (A_0, A_1, ..., A_n) in R^(d x n+1)
+             */
+            typename Matrix::ConstColsBlockXpr power_coefficients() const {
+                return _composite->power_coefficients(_index);
+            }
+
+            /**
+             * Evaluate the Bezier curve at its local parameter t
+             * @param t : local parameter in [0,1]
+             * @return vector in R^d
+             */
+            Vector operator()(Scalar t) const {
+                if(t < 0 or t > 1){
+                    throw std::domain_error("Bezier curve only defined on [0,1].");
+                }
+                Vector point(dimension());
+                _composite->evaluate_segment(_index, t, point);
+                return point;
+            }
+
+            /**
+             * Tight bounds of the Bezier curve, computed at construction
+             * @return {lower bound, upper bound}
+             */
+            std::array<Vector, 2> bounds() const {
+                unsigned int c = _composite->_first_curve + _index;
+                return {_composite->_lower_bounds.col(c), _composite->_upper_bounds.col(c)};
+            }
+
+            /**
+             * Copy the Bezier curve out of the composite curve
+             * @return Bezier curve with the same control points
+             */
+            BasicBezierCurve<Scalar> to_bezier_curve() const {
+                vector<Vector> points;
+                for(unsigned int j = 0; j < degree() + 1; j++){
+                    points.push_back(control_points().col(j));
+                }
+                return BasicBezierCurve<Scalar>(points);
+            }
+
+        private:
+            const BasicCompositeBezierCurve * _composite;
+            unsigned int _index;
+        };
+
+        /**
+         * Iterator over the Bezier curves of a composite Bezier curve, dereferences to a Segment view.
+         */
+        class SegmentIterator {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Segment value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const Segment * pointer;
+            typedef Segment reference;
+
+            SegmentIterator(const BasicCompositeBezierCurve & composite, unsigned int index) :
+                    _composite(&composite), _index(index) {}
+
+            Segment operator*() const { return Segment(*_composite, _index); }
+            SegmentIterator & operator++() { _index++; return *this; }
+            SegmentIterator operator++(int) { SegmentIterator it = *this; _index++; return it; }
+            bool operator==(const SegmentIterator & other) const { return _index == other._index; }
+            bool operator!=(const SegmentIterator & other) const { return _index != other._index; }
+
+        private:
+            const BasicCompositeBezierCurve * _composite;
+            unsigned int _index;
+        };
+
+        /**
+         * Range of all Bezier curves of a composite Bezier curve, for use in range based for loops.
+         */
+        class SegmentRange {
+        public:
+            explicit SegmentRange(const BasicCompositeBezierCurve & composite) : _composite(&composite) {}
+            SegmentIterator begin() const { return SegmentIterator(*_composite, 0); }
+            SegmentIterator end() const { return SegmentIterator(*_composite, _composite->number_of_curves()); }
+            unsigned int size() const { return _composite->number_of_curves(); }
+            Segment operator[](unsigned int i) const { return Segment(*_composite, i); }
+
+        private:
+            const BasicCompositeBezierCurve * _composite;
+        };
+
+        /**
+         * Closest point on a composite Bezier curve to a query point, see project.
+         */
+        struct Projection {
+            unsigned int segment; // index of the Bezier curve containing the closest point
+            Scalar t; // local parameter of the closest point on the Bezier curve, see Segment
+            Scalar distance; // distance from the query point to the closest point
+        };
 
         /**
          * Construct the composite Bezier curve.
          * @param control_points : control points defining the Bezier curves.
+         * @param knots : n+1 strictly increasing knots, rescaled to [0,1]. Uniform if empty.
          */
-        explicit CompositeBezierCurve(const vector<vector<VectorXd>>& control_points);
+        explicit BasicCompositeBezierCurve(const vector<vector<Vector>>& control_points,
+                                           const vector<double> & knots = vector<double>());
 
         /**
          * Construct the composite Bezier curve.
          * @param bezier_curves : bezier curves defining the composite Bezier curve.
+         * @param knots : n+1 strictly increasing knots, rescaled to [0,1]. Uniform if empty.
+         */
+        explicit BasicCompositeBezierCurve(const vector<BasicBezierCurve<Scalar>> & bezier_curves,
+                                           const vector<double> & knots = vector<double>());
+        BasicCompositeBezierCurve(const std::initializer_list<BasicBezierCurve<Scalar>> &bezier_curves);
+
+        /**
+         * Construct the composite Bezier curve from contiguous storage, see control_points().
+         * @param control_points : matrix in R^(d x N) where the joints are stored once
+         * @param degrees : degree n_i of each Bezier curve where N = 1 + sum n_i
+         * @param knots : n+1 strictly increasing knots, rescaled to [0,1]. Uniform if empty.
+         */
+        BasicCompositeBezierCurve(const Matrix & control_points,
+                                  const vector<unsigned int> & degrees,
+                                  const vector<double> & knots = vector<double>());
+
+        /**
+         * Construct the composite Bezier curve from contiguous storage, the control points are moved in
+         * instead of copied.
+         * @param control_points : matrix in R^(d x N) where the joints are stored once
+         * @param degrees : degree n_i of each Bezier curve where N = 1 + sum n_i
+         * @param knots : n+1 strictly increasing knots, rescaled to [0,1]. Uniform if empty.
+         */
+        BasicCompositeBezierCurve(Matrix && control_points,
+                                  const vector<unsigned int> & degrees,
+                                  const vector<double> & knots = vector<double>());
+
+        /**
+         * Append a Bezier curve at the end in amortized constant time. Requires uniform knots.
+         * @param control_points : control points of the curve, the first one must equal the end point
+         */
+        void append_segment(const vector<Vector> & control_points);
+
+        /**
+         * Append a Bezier curve at the end in amortized constant time. Requires non-uniform knots.
+         * @param control_points : control points of the curve, the first one must equal the end point
+         * @param knot_span : k_(n+1) - k_n of the new curve before the knots are rescaled to [0,1]
+         */
+        void append_segment(const vector<Vector> & control_points, double knot_span);
+
+        /**
+         * Remove the first Bezier curve in amortized constant time.
+         * The remaining curves are reparameterized to cover [0,1].
+         */
+        void pop_front_segment();
+
+        /**
+         * Limit the number of Bezier curves, appending a curve then removes the first one if the limit is reached.
+         * The curves beyond the limit are removed immediately.
+         * @param max_number_of_curves : maximum number of curves, 0 for no limit
+         */
+        void set_max_number_of_curves(unsigned int max_number_of_curves);
+
+        /**
+         * Retrieve the maximum number of Bezier curves
+         * @return maximum number of curves, 0 if there is no limit
          */
-        explicit CompositeBezierCurve(const vector<BezierCurve> & bezier_curves);
-        CompositeBezierCurve(const std::initializer_list<BezierCurve> &bezier_curves);
+        unsigned int max_number_of_curves() const;
 
         /**
          * Evaluate the composite Bezier curve at t.
@@ -38,7 +263,71 @@ namespace bezier {
          * @param t : parameter
          * @return vector in R^d
          */
-        VectorXd operator()(double t) const override;
+        Vector operator()(Scalar t) const override;
+
+        /**
+         * Evaluate the composite Bezier curve at t into caller owned storage without allocating.
+         * @param t : parameter
+         * @param out : vector in R^d
+         */
+        void evaluate_into(Scalar t, Eigen::Ref<Vector> out) const override;
+        using BasicCurve<Scalar>::evaluate_into;
+
+        /**
+         * Evaluate the composite Bezier curve at non-decreasing parameter values.
+         * The Bezier curves are walked in order instead of looking up the curve of each parameter, and
+         * the parameters that fall in the same curve are evaluated as one block with the SIMD kernel,
+         * see horner_batch. Does not allocate. The output uses the same structure of arrays layout as
+         * BasicBezierCurve::evaluate_vectorized.
+         * @param ts : m non-decreasing parameter values in [0,1]
+         * @param points : output in R^(m x d), column i holds coordinate i of all points
+         */
+        void evaluate_sorted(const Eigen::Ref<const Vector> & ts, Eigen::Ref<Matrix> points) const;
+
+        /**
+         * Evaluate a derivative of the composite Bezier curve at t.
+         * At a joint the derivative of the following Bezier curve is used.
+         * @param t : parameter
+         * @param order : order of the derivative, 0 evaluates the curve itself
+         * @return vector in R^d
+         */
+        Vector derivative(Scalar t, unsigned int order = 1) const;
+
+        /**
+         * Evaluate a derivative of the composite Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @param order : order of the derivative
+         * @return matrix in R^(d x m) where column j is the derivative at ts(j)
+         */
+        Matrix derivative(const Vector & ts, unsigned int order = 1) const;
+
+        /**
+         * Evaluate the unit tangent of the composite Bezier curve at t.
+         * @param t : parameter
+         * @return vector in R^d
+         */
+        Vector tangent(Scalar t) const;
+
+        /**
+         * Evaluate the unit tangent of the composite Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @return matrix in R^(d x m) where column j is the tangent at ts(j)
+         */
+        Matrix tangent(const Vector & ts) const;
+
+        /**
+         * Evaluate the curvature of the composite Bezier curve at t.
+         * @param t : parameter
+         * @return curvature
+         */
+        Scalar curvature(Scalar t) const;
+
+        /**
+         * Evaluate the curvature of the composite Bezier curve at several parameter values.
+         * @param ts : parameter values in [0,1]
+         * @return vector in R^m where element j is the curvature at ts(j)
+         */
+        Vector curvature(const Vector & ts) const;
 
         /**
          * Retrieve dimension of the curve
@@ -47,21 +336,259 @@ namespace bezier {
         unsigned int dimension() const override;
 
         /**
-         * Bounds of the curve
+         * Tight bounds of the curve.
+         * Combines the bounds of each Bezier curve, which are computed at construction.
+         * @return {lower bound, upper bound}
+         */
+        std::array<Vector, 2> bounds() const override;
+
+        /**
+         * Tight bounds of the curve on a sub interval.
+         * The cached bounds are used for the Bezier curves inside the interval and only the
+         * curves containing t0 and t1 are bounded anew.
+         * @param t0 : start of the interval in [0,1]
+         * @param t1 : end of the interval in [t0,1]
          * @return {lower bound, upper bound}
          */
-        std::array<Eigen::VectorXd, 2> bounds() const override;
+        std::array<Vector, 2> bounds(Scalar t0, Scalar t1) const;
+
+        /**
+         * Arc length of the composite Bezier curve.
+         * Computed with Gauss-Legendre quadrature on bracketed pieces into a lookup table on first use, see
+         * ArcLengthTable for the error bound. Copies of the curve share the table and
+         * appended curves are added to it.
+         * @return arc length
+         */
+        Scalar length() const;
+
+        /**
+         * Bound of the error of length(), see ArcLengthTable.
+         * @return sum of the widths of the arc length brackets of the pieces of all Bezier curves
+         */
+        Scalar length_error() const;
+
+        /**
+         * Arc length of the composite Bezier curve between two parameters.
+         * @param t0 : start of the interval in [0,1]
+         * @param t1 : end of the interval in [t0,1]
+         * @return arc length
+         */
+        Scalar length(Scalar t0, Scalar t1) const;
+
+        /**
+         * Parameter at which the arc length from the start of the composite Bezier curve is s,
+         * i.e. the inverse of length(0, t).
+         * @param s : arc length in [0, length()]
+         * @return parameter value in [0,1]
+         */
+        Scalar param_at_length(Scalar s) const;
+
+        /**
+         * Parameters at several arc lengths, see param_at_length.
+         * @param lengths : arc lengths in [0, length()]
+         * @return vector in R^m where element j is the parameter at lengths(j)
+         */
+        Vector param_at_length(const Vector & lengths) const;
+
+        /**
+         * Project points onto the composite Bezier curve, i.e. find the closest point on the curve to each point.
+         * The Bezier curves are pruned with a hierarchy over their bounds, which is built on first use,
+         * and the closest point on each remaining curve is found from the roots of (B(t) - q) . B'(t),
+         * see closest_point. The points are distributed over several threads.
+         * @param points : matrix in R^(d x m) where column j is a query point
+         * @param number_of_threads : number of threads, 0 uses all hardware threads
+         * @return projection of each point
+         */
+        vector<Projection> project(const Matrix & points, unsigned int number_of_threads = 0) const;
+
+        /**
+         * Split the composite Bezier curve at t. The Bezier curve containing t is split with de Casteljau's
+         * algorithm unless t is a joint, and the knots of both parts are kept before they are rescaled.
+         * @param t : parameter in (0,1)
+         * @return {curve on [0,t], curve on [t,1]}, both reparameterized to [0,1]
+         */
+        std::array<BasicCompositeBezierCurve, 2> split(Scalar t) const;
+
+        /**
+         * Elevate all Bezier curves to the same degree, e.g. the largest one such that the curves
+         * can be processed together. The curve itself and its knots are unchanged.
+         * @param degree : new degree of every Bezier curve, at least the largest degree
+         * @return composite Bezier curve where every Bezier curve has the given degree
+         */
+        BasicCompositeBezierCurve elevate_degree(unsigned int degree) const;
+
+        /**
+         * Reduce the degree of each Bezier curve as far as a tolerance allows, see BasicBezierCurve::reduce_degree.
+         * The joints and knots are unchanged.
+         * @param tolerance : bound on the distance between the curves at equal parameters
+         * @return composite Bezier curve with the reduced Bezier curves
+         */
+        BasicCompositeBezierCurve reduce_degree(Scalar tolerance) const;
 
         /**
          * Retrieve the Bezier curves.
+         * The curves are copied out of the contiguous storage, prefer segments() to only read them.
          * @return list of Bezier curves.
          */
-        vector<BezierCurve> bezier_curves() const;
+        vector<BasicBezierCurve<Scalar>> bezier_curves() const;
+
+        /**
+         * Retrieve a view of one of the Bezier curves without copying
+         * @param i : index of the curve
+         * @return view of curve i
+         */
+        Segment segment(unsigned int i) const;
+
+        /**
+         * Retrieve views of all Bezier curves without copying
+         * @return range of views, e.g. for(auto segment : composite.segments())
+         */
+        SegmentRange segments() const;
+
+        /**
+         * Retrieve the number of Bezier curves
+         * @return number of curves
+         */
+        unsigned int number_of_curves() const;
+
+        /**
+         * Retrieve the knots, curve i covers [k_i, k_(i+1)]
+         * @return {k_0 = 0, k_1, ..., k_n = 1}
+         */
+        vector<double> knots() const;
+
+        /**
+         * Retrieve one of the knots without allocating, see knots()
+         * @param i : index of the knot in [0, number_of_curves()]
+         * @return k_i
+         */
+        double knot(unsigned int i) const;
+
+        /**
+         * Whether the curves cover equal shares of the domain
+         * @return true if k_i = i / n
+         */
+        bool has_uniform_knots() const;
+
+        /**
+         * Find the Bezier curve which contains t and the parameter of t within that curve.
+         * At a joint the following curve is returned.
+         * @param t : parameter in [0,1]
+         * @return {curve index, local parameter in [0,1]}
+         */
+        std::pair<int, double> local_param(double t) const;
+
+        /**
+         * Derivative of the local parameter of a Bezier curve with respect to the global parameter
+         * @param i : index of the curve
+         * @return 1 / (k_(i+1) - k_i)
+         */
+        double local_param_scale(unsigned int i) const;
+
+        /**
+         * Retrieve the control points of all Bezier curves without copying, the joints are stored once.
+         * @return matrix in R^(d x N), see offsets() for the columns of each curve
+         */
+        typename Matrix::ConstColsBlockXpr control_points() const;
+
+        /**
+         * Retrieve the column of the first control point of each Bezier curve in control_points()
+         * @return offset of each curve
+         */
+        vector<long> offsets() const;
+
+        /**
+         * Retrieve the column of the first control point of one of the Bezier curves without allocating,
+         * see offsets()
+         * @param i : index of the curve
+         * @return offset of curve i
+         */
+        long offset(unsigned int i) const;
+
+        /**
+         * Retrieve the degree of each Bezier curve
+         * @return degree of each curve
+         */
+        vector<unsigned int> degrees() const;
+
+        /**
+         * Retrieve the degree of one of the Bezier curves without allocating
+         * @param i : index of the curve
+         * @return degree of curve i
+         */
+        unsigned int degree(unsigned int i) const;
+
+        /**
+         * Retrieve the power basis coefficients of one of the Bezier curves without copying
+         * @param i : index of the curve
+         * @return (A_0, A_1, ..., A_n) in R^(d x n+1)
+         */
+        typename Matrix::ConstColsBlockXpr power_coefficients(unsigned int i) const;
+
     private:
+        // the per curve buffers are indexed from _first_curve, the curves before it have been removed
         unsigned int _dimension;
-        vector<BezierCurve> _bezier_curves;
+        Matrix _control_points; // d x (1 + sum n_i) and spare capacity, the joints are stored once
+        Matrix _power_coefficients; // d x sum (n_i + 1) and spare capacity, curve i starts at _offsets[i] + i
+        vector<long> _offsets; // column of the first control point of each curve in _control_points
+        vector<unsigned int> _degrees;
+        unsigned int _first_curve;
+        unsigned int _max_number_of_curves;
+
+        vector<double> _knots; // not rescaled, empty for uniform knots
+        bool _uniform_knots;
+        vector<int> _buckets; // curve containing b / n for each bucket b, empty for few curves or after changes
+        unsigned int _changes_since_buckets;
+
+        Matrix _lower_bounds; // d x number of curves and spare capacity, bounds of each curve
+        Matrix _upper_bounds;
+        // sliding window minimum and maximum of the bounds of each curve in each dimension,
+        // holds the index of a curve plus the number of curves dropped by compact(),
+        // only tracked once curves are appended or removed and empty otherwise
+        vector<std::deque<unsigned long>> _lower_window;
+        vector<std::deque<unsigned long>> _upper_window;
+        unsigned long _dropped_curves;
+        // built on first use, first_curve is the index of a curve plus the number of curves dropped by compact()
+        mutable std::shared_ptr<ArcLengthTable> _arc_length_table;
+        mutable std::shared_ptr<const BoxTree> _box_tree; // built on first use, reset when curves are added or removed
+
+        template <typename Curves>
+        void copy_control_points(const Curves & curves);
+        void initialize(const vector<double> & knots);
+        void initialize_knots(const vector<double> & knots);
+        void initialize_curve(unsigned int c, MatrixXd & control_matrix, MatrixXd & power_coefficients);
+        void track_bounds();
+        void push_bounds(unsigned int c);
+        void build_buckets();
+        void update_buckets();
+        void compact();
+        void reserve_curve(unsigned int degree);
+        void append(const vector<Vector> & control_points, double knot_span);
+        long end_column() const;
+        vector<double> unscaled_knots() const;
+
+        std::shared_ptr<const ArcLengthTable> arc_length_table() const;
+        ArcLengthTable * mutable_arc_length_table();
+        std::shared_ptr<const BoxTree> box_tree() const;
+        Scalar global_param(unsigned int i, double t) const;
+
+        void evaluate_segment(unsigned int i, Scalar t, Eigen::Ref<Vector> out, unsigned int order = 0) const;
+        void segment_bounds(unsigned int i, Scalar t0, Scalar t1, Eigen::Ref<Vector> min_bound,
+                            Eigen::Ref<Vector> max_bound) const;
     };
 
+    typedef BasicCompositeBezierCurve<double> CompositeBezierCurve;
+    typedef BasicCompositeBezierCurve<float> CompositeBezierCurvef;
+
+    extern template class BasicCompositeBezierCurve<double>;
+    extern template class BasicCompositeBezierCurve<float>;
+
+    /**
+     * Map a parameter of a composite curve with uniform knots to one of its curves
+     * @param t : parameter in [0,1]
+     * @param number_of_curves : n
+     * @return {curve index, local parameter in [0,1]}
+     */
     std::pair<int, double> global_to_local_param(double t, int number_of_curves);
 
 }
@@ -10,15 +10,38 @@ namespace bezier {
     /**
      * Curve class.
      * Abstract curve class for curves parameterized on [0,1].
+     * @tparam Scalar : scalar type of the curve's range space, float or double
      */
-    class Curve {
+    template <typename Scalar>
+    class BasicCurve {
     public:
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> Vector;
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+        virtual ~BasicCurve() = default;
+
         /**
          * Evaluate curve
          * @param t : param
          * @return curve value at t
          */
-        virtual Eigen::Matrix<double, Eigen::Dynamic, 1> operator()(double t) const = 0;
+        virtual Vector operator()(Scalar t) const = 0;
+
+        /**
+         * Evaluate curve into caller owned storage.
+         * The default implementation copies the result of operator(), curves which can be
+         * evaluated without allocating override it.
+         * @param t : param
+         * @param out : vector in R^d which is set to the curve value at t
+         */
+        virtual void evaluate_into(Scalar t, Eigen::Ref<Vector> out) const;
+
+        /**
+         * Evaluate curve at several parameter values into caller owned storage.
+         * @param ts : params
+         * @param out : matrix in R^(d x m), column j is set to the curve value at ts(j)
+         */
+        void evaluate_into(const Eigen::Ref<const Vector> & ts, Eigen::Ref<Matrix> out) const;
 
         /**
          * Dimension of the curve's range space
@@ -30,16 +53,34 @@ namespace bezier {
          * Bounds on the curve
          * @return {lower bound, upper bound}
          */
-        virtual std::array<Eigen::VectorXd, 2> bounds() const = 0;
+        virtual std::array<Vector, 2> bounds() const = 0;
     };
 
+    typedef BasicCurve<double> Curve;
+    typedef BasicCurve<float> Curvef;
+
     /**
      * Sample uniformuously from a curve in parameter space
      * @param curve : curve to sample from
      * @param n : number of samples
      * @return list of samples
      */
-    std::vector<Eigen::VectorXd> sample(const Curve * curve, int n);
+    template <typename Scalar>
+    std::vector<typename BasicCurve<Scalar>::Vector> sample(const BasicCurve<Scalar> * curve, int n);
+
+    /**
+     * Sample uniformuously from a curve in parameter space into preallocated storage.
+     * The number of samples is given by the number of columns of the output. Bezier curves
+     * and composite Bezier curves are sampled with forward differencing, which costs n vector
+     * additions per sample for an n-degree curve.
+     * @param curve : curve to sample from
+     * @param samples : output in R^(d x n), column j is the curve evaluated at j / (n-1)
+     */
+    template <typename Scalar>
+    void sample(const BasicCurve<Scalar> * curve, Eigen::Ref<typename BasicCurve<Scalar>::Matrix> samples);
+
+    extern template class BasicCurve<double>;
+    extern template class BasicCurve<float>;
 }
 
 #endif //BEZIER_CURVE_H
@@ -8,30 +8,154 @@ namespace bezier {
 
     using std::vector;
 
+    /**
+     * Knot vector of a fitted composite Bezier curve.
+     * Uniform : curve i is defined on [i/n, (i+1)/n].
+     * ChordLength : the knots are the cumulative chord length of the data points associated with each curve,
+     * such that the global parameter is approximately proportional to arc length.
+     */
+    enum class Knots { Uniform, ChordLength };
+
+    /**
+     * Iterative parameter correction of a fit.
+     * The fit alternates between projecting each data point onto the fitted curve, with one safeguarded
+     * Newton step on (B(t) - p) . B'(t) = 0 within the Bezier curve of the data point, and fitting
+     * again with the corrected parameterization. Neither step increases the squared error.
+     */
+    struct ParameterCorrection {
+        unsigned int max_iterations = 10; // maximum number of corrections, 0 fits the given parameterization only
+        double tolerance = 1e-9; // stop once no parameter changes by more than this
+        unsigned int number_of_threads = 0; // threads of the projection step, 0 uses all hardware threads
+    };
+
+    /**
+     * One of the datasets of a batch fit, see fit_composite_bezier_curves.
+     */
+    template <typename Scalar>
+    struct BasicFitDataset {
+        vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> data_points; // data points
+        vector<int> joints; // indices where to split the data points between curves
+        vector<int> curve_degrees; // degree of each curve, or one degree for all curves
+        bool closed_curve = false; // if the fitted curve should be closed
+    };
+
+    typedef BasicFitDataset<double> FitDataset;
+    typedef BasicFitDataset<float> FitDatasetf;
+
+    /**
+     * Options of a batch fit, see fit_composite_bezier_curves.
+     */
+    struct FitOptions {
+        Knots knots = Knots::Uniform; // knot vector of the fitted curves
+        ParameterCorrection correction; // parameter correction of each fit, off by default
+        unsigned int number_of_threads = 0; // threads fitting the datasets, 0 uses all hardware threads
+        unsigned int max_extra_curves = 8; // curves beyond the best fit after which the adaptive fit gives up
+
+        FitOptions() {
+            correction.max_iterations = 0;
+        }
+    };
+
+    /**
+     * Errors of the data points of one of the Bezier curves of a fit. The error of a data point is its
+     * distance to the closest point of the Bezier curve.
+     */
+    struct SegmentError {
+        long first_point; // index of the first data point of the curve
+        long number_of_points; // number of data points of the curve
+        long worst_point; // index of the data point with the largest error
+        double max_error; // largest error
+        double rms_error; // root mean square of the errors
+    };
+
+    /**
+     * Result of fit_composite_bezier_curve_adaptive.
+     */
+    template <typename Scalar>
+    struct BasicAdaptiveFit {
+        BasicCompositeBezierCurve<Scalar> curve; // fitted composite Bezier curve
+        vector<int> joints; // indices where the data points are split between curves
+        vector<SegmentError> errors; // errors of each curve
+        unsigned int searched_curves; // largest number of curves which the search fitted
+    };
+
+    typedef BasicAdaptiveFit<double> AdaptiveFit;
+    typedef BasicAdaptiveFit<float> AdaptiveFitf;
+
     /**
      * Least square fits a composite bezier curve to a set of parameterized data points
      * associated with each bezier curve in the composite curve.
+     * The fit is templated on the scalar type of the data points, float or double. The normal
+     * equations are always assembled and solved in double precision since the power basis is
+     * ill-conditioned, only the resulting control points are rounded to the scalar type.
      * @param data_points : data points for each curve
      * @param parameterization : parameterization associated with each data point in the data_points parameter
      * for the corresponding curve.
      * @param curve_degrees : degree of each curve.
      * @param closed_curve : if the fitted curve should be closed.
+     * @param knots : knot vector of the fitted curve.
+     * @return composite bezier curve
+     */
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<vector<double>> & parameterization,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots = Knots::Uniform);
+    /**
+     * Least square fit a composite Bezier curve with iterative parameter correction, see ParameterCorrection.
+     * The data matrices and the continuity constraints are set up once, only the parameter dependent
+     * parts of the normal equations are assembled in each iteration.
+     * @param data_points : data points for each curve
+     * @param parameterization : initial parameterization of the data points, set to the corrected one
+     * @param curve_degrees : degree of each curve.
+     * @param closed_curve : if the fitted curve should be closed.
+     * @param knots : knot vector of the fitted curve.
+     * @param correction : stopping criteria and number of threads
+     * @return composite bezier curve fitted to the corrected parameterization
+     */
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            vector<vector<double>> & parameterization,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots,
+            const ParameterCorrection & correction);
+
+    /**
+     * Least square fit a composite Bezier curve with iterative parameter correction starting from the
+     * chord length parameterization, see ParameterCorrection.
+     * @param data_points : data points for each curve
+     * @param curve_degrees : degree of each curve.
+     * @param closed_curve : if the fitted curve should be closed.
+     * @param knots : knot vector of the fitted curve.
+     * @param correction : stopping criteria and number of threads
      * @return composite bezier curve
      */
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<vector<VectorXd>> & data_points,
-                                                    const vector<vector<double>> & parameterization,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots,
+            const ParameterCorrection & correction);
+
     /**
      * Least square fit composite Bezier curve
      * @param data_points : data points associated with each curve
      * @param curve_degrees : degree of each curve
      * @param closed_curve : if the fitted curve should be closed
+     * @param knots : knot vector of the fitted curve
      * @return compsite bezier curve
      */
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<vector<VectorXd>> & data_points,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots = Knots::Uniform);
 
     /**
      * Least square fit composite Bezier curve
@@ -39,12 +163,16 @@ namespace bezier {
      * @param joints : indices where to split the data points between curves
      * @param curve_degrees : degree of each curve
      * @param closed_curve : if the fitted curve should be closed
+     * @param knots : knot vector of the fitted curve
      * @return composite bezier curve
      */
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<VectorXd> & data_points,
-                                                    const vector<int> & joints,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            const vector<int> & joints,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots = Knots::Uniform);
 
     /**
      * Least square fit composite Bezier curve
@@ -52,17 +180,83 @@ namespace bezier {
      * @param joints : indices where to split the data points between curves
      * @param curve_degrees : degree of each curve
      * @param closed_curve : if the fitted curve should be closed
+     * @param knots : knot vector of the fitted curve
      * @return composite bezier curve
      */
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<VectorXd> & data_points,
-                                                    const vector<int> & joints,
-                                                    int curve_degrees,
-                                                    bool closed_curve);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            const vector<int> & joints,
+            int curve_degrees,
+            bool closed_curve,
+            Knots knots = Knots::Uniform);
 
-    vector<double> chordlength_parameterization(const vector<VectorXd> &data_points,
-                                                const VectorXd &start_point = VectorXd(0));
+    /**
+     * Least square fit composite Bezier curves to many independent datasets.
+     * The datasets are fitted on several threads which take the next dataset when they are done,
+     * largest datasets first, such that datasets of very different sizes are balanced. Each thread
+     * keeps its buffers between datasets and each dataset is fitted on a single thread, also the
+     * parameter correction.
+     * @param batch : datasets, each one is fitted as fit_composite_bezier_curve with joints
+     * @param options : knots, parameter correction and number of threads
+     * @return composite bezier curve of each dataset in the order of the batch
+     */
+    template <typename Scalar>
+    vector<BasicCompositeBezierCurve<Scalar>> fit_composite_bezier_curves(const vector<BasicFitDataset<Scalar>> & batch,
+                                                                          const FitOptions & options = FitOptions());
+
+    /**
+     * Least square fit a composite Bezier curve with few curves which keeps the error of every data point within
+     * a tolerance, see SegmentError.
+     * Starting from a single curve, one joint is added at a time until all errors are within the tolerance. The
+     * candidates split one of the three curves with the largest errors at its worst data point or in the
+     * middle, space it and its neighbours evenly with one more curve, or space all curves evenly with one more
+     * curve. They are fitted in parallel and the one with the smallest largest error is kept. Once the
+     * tolerance is reached, the joints are removed one at a time as long as the tolerance is still met, each
+     * candidate spaces the curves around the removed joint evenly. The search is local: it never needs more curves than evenly spaced joints, but
+     * fewer curves at other joints may still reach the tolerance. Every curve keeps at least degree + 1 data
+     * points, a split at a worst data point is moved inwards if needed.
+     * Since the curves are joined with equal derivatives, neighbouring curves of very different lengths fit
+     * poorly and more curves do not always give smaller errors, parameter correction reduces this effect. The
+     * search therefore continues past fits with larger errors, but gives up once it has more than
+     * options.max_extra_curves curves beyond the best fit so far, or when no curve can be added, and returns
+     * the best fit.
+     * @param data_points : data points
+     * @param tolerance : largest error of a data point
+     * @param curve_degree : degree of each curve, at least 3
+     * @param closed_curve : if the fitted curve should be closed
+     * @param options : knots, parameter correction of each fit, threads of the candidate fits and the curves
+     * beyond the best fit before giving up
+     * @return fitted curve, its joints and the errors of each curve
+     */
+    template <typename Scalar>
+    BasicAdaptiveFit<Scalar> fit_composite_bezier_curve_adaptive(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            double tolerance,
+            int curve_degree,
+            bool closed_curve = false,
+            const FitOptions & options = FitOptions());
+
+    template <typename Scalar>
+    vector<double> chordlength_parameterization(const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> &data_points,
+                                                const typename BasicCurve<Scalar>::Vector &start_point =
+                                                        typename BasicCurve<Scalar>::Vector(0));
+
+    /**
+     * Cumulative chord length knots of partitioned data points.
+     * The length of curve i includes the link from the last data point of curve i-1 (for closed curves the
+     * first curve is linked to the last data point of the last curve).
+     * @param data_points : data points associated with each curve
+     * @param closed_curve : if the curve is closed
+     * @return n+1 knots starting at 0
+     */
+    template <typename Scalar>
+    vector<double> chordlength_knots(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                     bool closed_curve);
 
-    vector<vector<double>> initialize_parameterization(const vector<vector<VectorXd>> & data_points, bool closed_curve);
+    template <typename Scalar>
+    vector<vector<double>> initialize_parameterization(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                                       bool closed_curve);
 
     MatrixXd parameterization_matrix(const vector<double> &parameterization, int degree);
 }
@@ -0,0 +1,193 @@
+#ifndef BEZIER_FIXED_BEZIER_CURVE_H
+#define BEZIER_FIXED_BEZIER_CURVE_H
+
+#include <array>
+#include <initializer_list>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+#include <bezier/curve.h>
+#include <bezier/bezier_curve.h>
+
+namespace bezier {
+
+    /**
+     * Bezier curve with degree and dimension known at compile time.
+     * Behaves as BezierCurve, but stores its control points and power basis coefficients
+     * in fixed-size Eigen types. Evaluation through evaluate() performs no heap allocation
+     * and the Horner loop can be fully unrolled by the compiler.
+     *
+     * B(t) = T * C * P
+     *
+     * @tparam Degree : degree n of the curve
+     * @tparam Dim : dimension d of the curve's range space
+     * @tparam Scalar : scalar type of the control points
+     */
+    template <int Degree, int Dim, typename Scalar = double>
+    class FixedBezierCurve : public Curve {
+        static_assert(Degree >= 0, "The degree of a Bezier curve must be non-negative.");
+        static_assert(Dim > 0, "The dimension of a Bezier curve must be positive.");
+    public:
+        typedef Eigen::Matrix<Scalar, Dim, 1> Point;
+        typedef Eigen::Matrix<Scalar, Dim, Degree + 1> ControlMatrix;
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        /**
+         * Construct the Bezier curve.
+         * @param control_points : matrix in R^(d x n+1) where column i is control point i
+         */
+        explicit FixedBezierCurve(const ControlMatrix & control_points) : _control_points(control_points) {
+            Eigen::Matrix<Scalar, Degree + 1, Degree + 1> coefficient_matrix =
+                    cached_bezier_coefficients(Degree).template cast<Scalar>();
+            _power_coefficients = _control_points * coefficient_matrix.transpose();
+        }
+
+        /**
+         * Construct the Bezier curve.
+         * @param control_points : the n+1 control points in R^d
+         */
+        FixedBezierCurve(const std::initializer_list<Point> & control_points) :
+                FixedBezierCurve(to_control_matrix(control_points)) {}
+
+        /**
+         * Convert a Bezier curve with degree and dimension known at runtime.
+         * @param bezier : Bezier curve of degree n and dimension d
+         */
+        explicit FixedBezierCurve(const BezierCurve & bezier) : FixedBezierCurve(to_control_matrix(bezier)) {}
+
+        /**
+         * Retrieve the control points
+         * @return matrix in R^(d x n+1) where column i is control point i
+         */
+        const ControlMatrix & control_points() const {
+            return _control_points;
+        }
+
+        /**
+         * Retrieve the degree of the Bezier curve
+         * @return n
+         */
+        unsigned int degree() const {
+            return Degree;
+        }
+
+        /**
+         * Retrieve the output dimension of the Bezier curve
+         * @return d
+         */
+        unsigned int dimension() const override {
+            return Dim;
+        }
+
+        /**
+         * Evaluate the Bezier curve at t without allocating.
+         * Uses Horner's scheme on the power basis coefficients. The end points are returned exactly.
+         * @param t : parameter value
+         * @return vector in R^d
+         */
+        Point evaluate(Scalar t) const {
+            if(t < 0 or t > 1){
+                throw std::domain_error("Bezier curve only defined on [0,1].");
+            }
+            if(t == 1){
+                return _control_points.col(Degree);
+            }
+            Point point = _power_coefficients.col(Degree);
+            for(int j = Degree - 1; j >= 0; j--){
+                point = point * t + _power_coefficients.col(j);
+            }
+            return point;
+        }
+
+        /**
+         * Evaluate the Bezier curve at several parameter values at once.
+         * @param ts : parameter values in [0,1]
+         * @return matrix in R^(d x m) where column j is the curve evaluated at ts(j)
+         */
+        Eigen::Matrix<Scalar, Dim, Eigen::Dynamic> evaluate(const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & ts) const {
+            Eigen::Matrix<Scalar, Dim, Eigen::Dynamic> points(Dim, ts.rows());
+            for(int j = 0; j < ts.rows(); j++){
+                points.col(j) = evaluate(ts(j));
+            }
+            return points;
+        }
+
+        /**
+         * Evaluate the Bezier curve at t through the Curve interface
+         * @param t : parameter value
+         * @return vector in R^d
+         */
+        VectorXd operator()(double t) const override {
+            return evaluate(static_cast<Scalar>(t)).template cast<double>();
+        }
+
+        /**
+         * Evaluate the Bezier curve at t into caller owned storage without allocating.
+         * @param t : parameter value
+         * @param out : vector in R^d
+         */
+        void evaluate_into(double t, Eigen::Ref<Eigen::VectorXd> out) const override {
+            if(out.rows() != Dim){
+                throw std::invalid_argument("Output must have the same dimension as the curve.");
+            }
+            out = evaluate(static_cast<Scalar>(t)).template cast<double>();
+        }
+        using Curve::evaluate_into;
+
+        /**
+         * Estimated bounds of the Bezier curve.
+         * Computed from the mininum and maximum values of the control points in each dimension.
+         * @return {lower bound, upper bound}
+         */
+        std::array<Eigen::VectorXd, 2> bounds() const override {
+            return {_control_points.rowwise().minCoeff().template cast<double>(),
+                    _control_points.rowwise().maxCoeff().template cast<double>()};
+        }
+
+        /**
+         * Convert to a Bezier curve with degree and dimension known at runtime.
+         * @return Bezier curve with the same control points
+         */
+        BezierCurve to_bezier_curve() const {
+            vector<VectorXd> control_points;
+            for(int i = 0; i < Degree + 1; i++){
+                control_points.push_back(_control_points.col(i).template cast<double>());
+            }
+            return BezierCurve(control_points);
+        }
+
+    private:
+        static ControlMatrix to_control_matrix(const std::initializer_list<Point> & control_points){
+            if(control_points.size() != Degree + 1){
+                throw std::invalid_argument("A fixed size Bezier curve of degree n requires n+1 control points.");
+            }
+            ControlMatrix control_matrix;
+            int i = 0;
+            for(const Point & control_point : control_points){
+                control_matrix.col(i++) = control_point;
+            }
+            return control_matrix;
+        }
+
+        static ControlMatrix to_control_matrix(const BezierCurve & bezier){
+            if(bezier.degree() != Degree or bezier.dimension() != Dim){
+                throw std::invalid_argument("Degree and dimension of the Bezier curve must match the fixed size curve.");
+            }
+            ControlMatrix control_matrix;
+            const vector<VectorXd> & control_points = bezier.control_points();
+            for(int i = 0; i < Degree + 1; i++){
+                control_matrix.col(i) = control_points[i].cast<Scalar>();
+            }
+            return control_matrix;
+        }
+
+        ControlMatrix _control_points;
+        ControlMatrix _power_coefficients; // (C * P)^T in R^(d x n+1)
+    };
+
+    typedef FixedBezierCurve<3, 2> CubicBezierCurve2d;
+    typedef FixedBezierCurve<3, 3> CubicBezierCurve3d;
+}
+
+#endif //BEZIER_FIXED_BEZIER_CURVE_H
@@ -0,0 +1,88 @@
+#ifndef BEZIER_ARC_LENGTH_H
+#define BEZIER_ARC_LENGTH_H
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Arc length lookup table of one or more consecutive polynomial curves.
+     *
+     * The local parameter domain [0,1] of each curve is split into pieces on which the arc length is
+     * bracketed between the length of the chord and the length of the Bezier control polygon of the piece.
+     * The table holds the start of each piece and the arc length up to it, such that the length up to any
+     * parameter is found with one lookup and one Gauss-Legendre rule on a part of a piece, and the parameter
+     * at a given length is found with one lookup and a safeguarded Newton iteration inside a piece.
+     *
+     * Pieces are halved until the width of their bracket is at most arc_length_tolerance times the width of
+     * the piece times the length of the control polygon of the curve. The length of a piece is the Gauss-Legendre
+     * rule clamped to its bracket, so the sum of the widths of the brackets of a curve, kept in errors, bounds the
+     * error of its arc length. Pieces are not halved beyond a maximum depth, pieces accepted there are counted in
+     * unconverged and their brackets are still summed in errors, which may then exceed the tolerance.
+     */
+    struct ArcLengthTable {
+        std::vector<double> params; // start of each piece in the local parameter of its curve
+        std::vector<double> lengths; // arc length from the start of the first curve to each piece
+        std::vector<long> offsets; // first piece of each curve
+        std::vector<double> errors; // bound of the error of the arc length of each curve
+        std::vector<unsigned long> unconverged; // pieces of each curve accepted at the maximum depth
+        unsigned long first_curve = 0; // identifier of the first curve in the table
+        double length = 0; // arc length from the start of the first curve to the end of the last curve
+    };
+
+    /**
+     * Relative bound of the error of the arc length of a curve, see ArcLengthTable.
+     */
+    const double arc_length_tolerance = 1e-6;
+
+    /**
+     * Append a polynomial curve to an arc length table
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n, t in [0,1]
+     *
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1)
+     * @param table : table which gets one more curve
+     */
+    void append_arc_length(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, ArcLengthTable & table);
+    void append_arc_length(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, ArcLengthTable & table);
+
+    /**
+     * Arc length of a polynomial curve from the start of the first curve in a table.
+     * @param power_coefficients : power basis coefficients of the curve
+     * @param table : table containing the curve
+     * @param curve : index of the curve in the table, i.e. its identifier minus table.first_curve
+     * @param t : local parameter in [0,1]
+     * @return arc length
+     */
+    double arc_length_at(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, const ArcLengthTable & table,
+                         unsigned long curve, double t);
+    double arc_length_at(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, const ArcLengthTable & table,
+                         unsigned long curve, double t);
+
+    /**
+     * Curve in a table which contains the given arc length from the start of the first curve.
+     * The last curve is returned for lengths beyond the end.
+     * @param table : arc length table
+     * @param length : arc length
+     * @param first_curve : index of the first curve in the table to search
+     * @return index of the curve in the table
+     */
+    unsigned long curve_at_arc_length(const ArcLengthTable & table, double length, unsigned long first_curve = 0);
+
+    /**
+     * Local parameter of a polynomial curve at an arc length from the start of the first curve in a table.
+     * @param power_coefficients : power basis coefficients of the curve
+     * @param table : table containing the curve
+     * @param curve : index of the curve in the table, see curve_at_arc_length
+     * @param length : arc length, clamped to the curve
+     * @return local parameter in [0,1]
+     */
+    double param_at_arc_length(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                               const ArcLengthTable & table, unsigned long curve, double length);
+    double param_at_arc_length(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                               const ArcLengthTable & table, unsigned long curve, double length);
+}
+
+#endif //BEZIER_ARC_LENGTH_H
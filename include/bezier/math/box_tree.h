@@ -0,0 +1,88 @@
+#ifndef BEZIER_BOX_TREE_H
+#define BEZIER_BOX_TREE_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Bounding box hierarchy over a sequence of axis aligned boxes, e.g. the bounds of the curves of a
+     * composite curve. Consecutive boxes are grouped since consecutive curves are close to each other.
+     *
+     * Node 0 is the root and every node covers the boxes [begin, end). An inner node is followed by its
+     * first child, the second child is stored at second_child.
+     */
+    struct BoxTree {
+        Eigen::MatrixXd lower; // d x number of nodes, lower bound of each node
+        Eigen::MatrixXd upper;
+        std::vector<long> begin;
+        std::vector<long> end;
+        std::vector<long> second_child;
+    };
+
+    /**
+     * Build a bounding box hierarchy.
+     * @param lower : d x m, lower bound of each box
+     * @param upper : d x m, upper bound of each box
+     * @return hierarchy with 2m - 1 nodes
+     */
+    BoxTree build_box_tree(const Eigen::Ref<const Eigen::MatrixXd> & lower, const Eigen::Ref<const Eigen::MatrixXd> & upper);
+
+    /**
+     * Squared distance from a point to the box of a node, zero inside the box.
+     * @param tree : bounding box hierarchy
+     * @param node : index of the node
+     * @param point : point in R^d
+     * @return squared distance
+     */
+    inline double squared_box_distance(const BoxTree & tree, long node, const Eigen::Ref<const Eigen::VectorXd> & point){
+        double distance = 0;
+        for(long r = 0; r < point.rows(); r++){
+            double outside = std::max(std::max(tree.lower(r, node) - point(r), point(r) - tree.upper(r, node)), 0.0);
+            distance += outside * outside;
+        }
+        return distance;
+    }
+
+    /**
+     * Visit the boxes which may contain a point closer than the closest one found so far.
+     * The tree is traversed depth first, nearer children first, and nodes whose box is not closer
+     * than the best squared distance are skipped.
+     * @param tree : bounding box hierarchy
+     * @param point : point in R^d
+     * @param visit : called with the index of a box, returns the squared distance to the closest point in it
+     * @return smallest squared distance returned by visit
+     */
+    template <typename Visit>
+    double nearest_boxes(const BoxTree & tree, const Eigen::Ref<const Eigen::VectorXd> & point, Visit visit){
+        double best = std::numeric_limits<double>::infinity();
+        // the depth is logarithmic in the number of boxes
+        long stack[128];
+        int size = 0;
+        stack[size++] = 0;
+        while(size > 0){
+            long node = stack[--size];
+            if(squared_box_distance(tree, node, point) >= best){
+                continue;
+            }
+            if(tree.end[node] - tree.begin[node] == 1){
+                best = std::min(best, visit(tree.begin[node]));
+                continue;
+            }
+            long first = node + 1;
+            long second = tree.second_child[node];
+            if(squared_box_distance(tree, first, point) > squared_box_distance(tree, second, point)){
+                std::swap(first, second);
+            }
+            stack[size++] = second;
+            stack[size++] = first;
+        }
+        return best;
+    }
+}
+
+#endif //BEZIER_BOX_TREE_H
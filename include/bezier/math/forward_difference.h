@@ -0,0 +1,44 @@
+#ifndef BEZIER_FORWARD_DIFFERENCE_H
+#define BEZIER_FORWARD_DIFFERENCE_H
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Default number of forward differencing steps between two exact evaluations.
+     */
+    const int DEFAULT_REANCHOR_INTERVAL = 32;
+
+    /**
+     * Evaluate a polynomial curve on a uniform parameter grid with forward differencing.
+     * The curve is given in the power basis
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n
+     *
+     * and is evaluated at t_j = t0 + j * h for j = 0, ..., m-1. After initialization each
+     * sample costs n vector additions. The initial differences are derived from the Taylor
+     * shifted coefficients rather than from differences of values of p, which would cancel
+     * most significant digits for small h. Rounding errors still accumulate with the number
+     * of steps, so the differences are recomputed every reanchor_interval steps. The differences
+     * are always initialized in double precision, the single precision overload only
+     * accumulates in float.
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1)
+     * @param t0 : first parameter
+     * @param h : step between parameters
+     * @param samples : output in R^(d x m), column j is p(t_j)
+     * @param reanchor_interval : number of steps between exact evaluations
+     */
+    void forward_difference(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                            double t0,
+                            double h,
+                            Eigen::Ref<Eigen::MatrixXd> samples,
+                            int reanchor_interval = DEFAULT_REANCHOR_INTERVAL);
+    void forward_difference(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                            float t0,
+                            float h,
+                            Eigen::Ref<Eigen::MatrixXf> samples,
+                            int reanchor_interval = DEFAULT_REANCHOR_INTERVAL);
+}
+
+#endif //BEZIER_FORWARD_DIFFERENCE_H
@@ -0,0 +1,58 @@
+#ifndef BEZIER_HORNER_H
+#define BEZIER_HORNER_H
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Evaluate a polynomial curve, or one of its derivatives, at a single parameter with
+     * Horner's scheme. The curve is given in the power basis
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n
+     *
+     * and the k-th derivative is evaluated from the coefficients j!/(j-k)! A_j without
+     * materializing them. Does not allocate.
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1)
+     * @param t : parameter
+     * @param out : vector in R^d which is set to the k-th derivative of p at t
+     * @param order : k, 0 evaluates p itself
+     */
+    void horner(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, double t,
+                Eigen::Ref<Eigen::VectorXd> out, unsigned int order = 0);
+    void horner(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, float t,
+                Eigen::Ref<Eigen::VectorXf> out, unsigned int order = 0);
+
+    /**
+     * Evaluate a polynomial curve at many parameters with Horner's scheme.
+     * The curve is given in the power basis
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n
+     *
+     * and several parameters are evaluated per instruction in a structure of arrays layout.
+     * The instruction set is selected at runtime: AVX2 with FMA (4 parameters per instruction,
+     * two registers per iteration), SSE2 (2 parameters per instruction) or a scalar fallback.
+     * The single precision overload evaluates twice as many parameters per instruction.
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1), column-major
+     * @param dimension : d
+     * @param degree : n
+     * @param ts : m parameters
+     * @param n_params : m
+     * @param out : output, coordinate i of p(ts[j]) is written to out[i * out_stride + j]
+     * @param out_stride : distance between the coordinates in out, at least m
+     */
+    void horner_batch(const double * power_coefficients, int dimension, int degree,
+                      const double * ts, long n_params,
+                      double * out, long out_stride);
+    void horner_batch(const float * power_coefficients, int dimension, int degree,
+                      const float * ts, long n_params,
+                      float * out, long out_stride);
+
+    /**
+     * Name of the instruction set used by horner_batch on this CPU.
+     * @return "avx2", "sse2" or "scalar"
+     */
+    const char * horner_batch_instruction_set();
+}
+
+#endif //BEZIER_HORNER_H
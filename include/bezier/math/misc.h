@@ -1,8 +1,33 @@
 #ifndef BEZIER_MISC_H
 #define BEZIER_MISC_H
 
+#include <vector>
+#include <Eigen/Dense>
+
 namespace bezier {
     int factorial(int n);
+
+    /**
+     * Row n of Pascal's triangle, i.e. the binomial coefficients (n choose k) for k = 0, ..., n.
+     * Built with additions only, so the coefficients are exact as long as they fit in a double
+     * mantissa (n <= 56).
+     * @param n : row
+     * @return {(n choose 0), (n choose 1), ..., (n choose n)}
+     */
+    std::vector<double> binomial_coefficients(int n);
+
+    /**
+     * Curvature of a curve from its first and second derivative
+     *
+     * k = sqrt(|B'|^2 |B''|^2 - (B' . B'')^2) / |B'|^3
+     *
+     * which holds in any dimension and does not depend on the parameterization.
+     * @param first : B'
+     * @param second : B''
+     * @return curvature, infinity where the first derivative vanishes
+     */
+    double curvature(const Eigen::Ref<const Eigen::VectorXd> & first, const Eigen::Ref<const Eigen::VectorXd> & second);
+    float curvature(const Eigen::Ref<const Eigen::VectorXf> & first, const Eigen::Ref<const Eigen::VectorXf> & second);
 }
 
 #endif //BEZIER_MISC_H
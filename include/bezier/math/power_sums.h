@@ -0,0 +1,37 @@
+#ifndef BEZIER_POWER_SUMS_H
+#define BEZIER_POWER_SUMS_H
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Accumulate the power sums of the parameters of data points and of the data points weighted by them,
+     * from which the normal equations of a least squares fit of a polynomial curve of degree n are assembled
+     * without the parameterization matrix T with rows (1 t t^2 ... t^n):
+     *
+     * T^T T = (sum t^(j+k))_jk, see hankel_normal_matrix, and T^T D = (sum t^k p)_k
+     *
+     * The data points are read column by column and the sums are updated in a single pass.
+     * @param ts : parameters t of the m data points
+     * @param points : data points p in R^(d x m)
+     * @param power_sums : sum t^k for k = 0, ..., 2n, incremented
+     * @param weighted_sums : column k is sum t^k p for k = 0, ..., n, i.e. (T^T D)^T in R^(d x n+1), incremented
+     */
+    void accumulate_power_sums(const Eigen::Ref<const Eigen::VectorXd> & ts,
+                               const Eigen::Ref<const Eigen::MatrixXd> & points,
+                               Eigen::Ref<Eigen::VectorXd> power_sums,
+                               Eigen::Ref<Eigen::MatrixXd> weighted_sums);
+
+    /**
+     * Hankel matrix of power sums, the normal matrix T^T T of a least squares fit of a polynomial curve
+     * of degree n, see accumulate_power_sums. A scale s gives the normal matrix of the parameters s t.
+     * @param power_sums : sum t^k for k = 0, ..., 2n
+     * @param scale : s
+     * @param normal_matrix : set to (s^(j+k) sum t^(j+k))_jk in R^(n+1 x n+1)
+     */
+    void hankel_normal_matrix(const Eigen::Ref<const Eigen::VectorXd> & power_sums, double scale,
+                              Eigen::Ref<Eigen::MatrixXd> normal_matrix);
+}
+
+#endif //BEZIER_POWER_SUMS_H
@@ -0,0 +1,64 @@
+#ifndef BEZIER_ROOTS_H
+#define BEZIER_ROOTS_H
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Real roots of a polynomial in an interval
+     *
+     * p(t) = a_0 + a_1 t + a_2 t^2 + ... + a_n t^n
+     *
+     * Polynomials of degree one and two are solved in closed form. For higher degrees the roots of
+     * p' split the interval into pieces on which p is monotone, and the root in a piece whose ends
+     * differ in sign is refined with Newton's method, safeguarded by bisection. Roots of even
+     * multiplicity where p does not change sign are not guaranteed to be found, and the zero
+     * polynomial has no roots.
+     * @param coefficients : (a_0, a_1, ..., a_n)
+     * @param t0 : start of the interval
+     * @param t1 : end of the interval
+     * @return roots in [t0, t1] in increasing order
+     */
+    std::vector<double> polynomial_roots(const Eigen::Ref<const Eigen::VectorXd> & coefficients, double t0, double t1);
+
+    /**
+     * Tight bounds of a polynomial curve on an interval
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n
+     *
+     * Each coordinate attains its extrema at the ends of the interval or at a root of its
+     * derivative, see polynomial_roots. Does not allocate for degrees up to 32.
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1)
+     * @param t0 : start of the interval
+     * @param t1 : end of the interval, t0 <= t1
+     * @param min_bound : vector in R^d which is set to the minimum of each coordinate on [t0, t1]
+     * @param max_bound : vector in R^d which is set to the maximum of each coordinate on [t0, t1]
+     */
+    void polynomial_bounds(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, double t0, double t1,
+                           Eigen::Ref<Eigen::VectorXd> min_bound, Eigen::Ref<Eigen::VectorXd> max_bound);
+    void polynomial_bounds(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, float t0, float t1,
+                           Eigen::Ref<Eigen::VectorXf> min_bound, Eigen::Ref<Eigen::VectorXf> max_bound);
+
+    /**
+     * Closest point of a polynomial curve on [0,1] to a point q
+     *
+     * p(t) = A_0 + A_1 t + A_2 t^2 + ... + A_n t^n
+     *
+     * The squared distance |p(t) - q|^2 is smallest at an end point or at a root of
+     * (p(t) - q) . p'(t), a polynomial of degree 2n - 1, see polynomial_roots. Does not allocate
+     * for degrees up to 16.
+     * @param power_coefficients : (A_0, A_1, ..., A_n) in R^(d x n+1)
+     * @param point : q in R^d
+     * @return {t, |p(t) - q|^2} where t is the parameter of the closest point
+     */
+    std::pair<double, double> closest_point(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                                            const Eigen::Ref<const Eigen::VectorXd> & point);
+    std::pair<double, double> closest_point(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                                            const Eigen::Ref<const Eigen::VectorXf> & point);
+}
+
+#endif //BEZIER_ROOTS_H
@@ -0,0 +1,55 @@
+#ifndef BEZIER_SUBDIVISION_H
+#define BEZIER_SUBDIVISION_H
+
+#include <Eigen/Dense>
+
+namespace bezier {
+
+    /**
+     * Split a Bezier curve at t into the curves on [0,t] and [t,1] with de Casteljau's algorithm.
+     * Does not allocate.
+     * @param control_points : (P_0, P_1, ..., P_n) in R^(d x n+1)
+     * @param t : parameter in [0,1]
+     * @param left : matrix in R^(d x n+1) which is set to the control points of the curve on [0,t]
+     * @param right : matrix in R^(d x n+1) which is set to the control points of the curve on [t,1]
+     */
+    void split_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points, double t,
+                              Eigen::Ref<Eigen::MatrixXd> left, Eigen::Ref<Eigen::MatrixXd> right);
+    void split_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points, float t,
+                              Eigen::Ref<Eigen::MatrixXf> left, Eigen::Ref<Eigen::MatrixXf> right);
+
+    /**
+     * Elevate the degree of a Bezier curve without changing the curve. Each step from degree m to m+1 is
+     *
+     * Q_i = i / (m+1) P_(i-1) + (1 - i / (m+1)) P_i
+     *
+     * Does not allocate.
+     * @param control_points : (P_0, P_1, ..., P_n) in R^(d x n+1)
+     * @param elevated : matrix in R^(d x N+1) with N >= n which is set to the control points of degree N
+     */
+    void elevate_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points,
+                                Eigen::Ref<Eigen::MatrixXd> elevated);
+    void elevate_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points,
+                                Eigen::Ref<Eigen::MatrixXf> elevated);
+
+    /**
+     * Reduce the degree of a Bezier curve
+     *
+     * The end points are kept, such that joints of composite curves stay in place, and the other
+     * control points Q are the least squares solution of E Q = P where E elevates the degree back
+     * to n. The reduced curve differs from the original one by a Bezier curve with control points
+     * P - E Q, so by the convex hull property the distance between the curves is at most the
+     * largest |P_i - (E Q)_i|. The least squares operator of each pair of degrees is computed once
+     * and kept for the lifetime of the program.
+     * @param control_points : (P_0, P_1, ..., P_n) in R^(d x n+1)
+     * @param reduced : matrix in R^(d x m+1) with 1 <= m <= n, or m = 0 if n = 0, which is set to
+     * the control points of degree m
+     * @return upper bound of the distance between the curves at equal parameters
+     */
+    double reduce_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points,
+                                 Eigen::Ref<Eigen::MatrixXd> reduced);
+    double reduce_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points,
+                                 Eigen::Ref<Eigen::MatrixXf> reduced);
+}
+
+#endif //BEZIER_SUBDIVISION_H
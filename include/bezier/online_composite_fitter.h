@@ -0,0 +1,145 @@
+#ifndef BEZIER_ONLINE_COMPOSITE_FITTER_H
+#define BEZIER_ONLINE_COMPOSITE_FITTER_H
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <bezier/composite_bezier_curve.h>
+
+namespace bezier {
+
+    using std::vector;
+    using Eigen::MatrixXd;
+
+    /**
+     * Least squares fit of an open composite Bezier curve to streaming data points.
+     *
+     * The data points are split into consecutive groups of points_per_curve data points, one group per
+     * Bezier curve, and are parameterized by chord length within each curve as in fit_composite_bezier_curve.
+     * Only the last window_size curves are fitted. When a data point starts a new curve and the window is
+     * full, the first curve of the window is frozen: its control points no longer change and the next
+     * curve continues it with C^1 continuity. As long as no curve has been frozen the fit equals
+     * fit_composite_bezier_curve with the same joints.
+     *
+     * Each curve keeps the power sums of the chord lengths of its data points and of its data points
+     * weighted by them, such that its normal equations can be assembled for any total chord length without
+     * the data points. A data point only changes the normal equations of the last curve, so only the last
+     * two blocks of the tridiagonal system of the window are assembled again before the window is solved.
+     * The cost of a data point depends on the degree and the window size but not on the number of data
+     * points so far.
+     * @tparam Scalar : scalar type of the data points and the fitted curve, float or double
+     */
+    template <typename Scalar>
+    class BasicOnlineCompositeFitter {
+    public:
+        typedef typename BasicCurve<Scalar>::Vector Vector;
+        typedef typename BasicCurve<Scalar>::Matrix Matrix;
+
+        /**
+         * @param degree : degree of each Bezier curve, at least 3
+         * @param points_per_curve : number of data points of each Bezier curve, at least degree + 1
+         * @param window_size : number of Bezier curves which are fitted, at least 1
+         */
+        BasicOnlineCompositeFitter(unsigned int degree, unsigned int points_per_curve, unsigned int window_size);
+
+        /**
+         * Add a data point and fit the window again.
+         * @param point : data point, all data points must have the same dimension
+         */
+        void add_point(const Vector & point);
+
+        /**
+         * Add several data points and fit the window again once, curves which are frozen on the way
+         * are fitted to the data points up to the start of the next curve.
+         * @param points : data points
+         */
+        void add_points(const vector<Vector> & points);
+
+        /**
+         * Retrieve the frozen Bezier curves followed by the fitted Bezier curves of the window.
+         * Copies the frozen curves, see frozen_curve() and window_curve() to avoid it.
+         * @return composite Bezier curve with uniform knots
+         */
+        BasicCompositeBezierCurve<Scalar> curve() const;
+
+        /**
+         * Retrieve the Bezier curves which have been frozen.
+         * @return composite Bezier curve with uniform knots
+         */
+        const BasicCompositeBezierCurve<Scalar> & frozen_curve() const;
+
+        /**
+         * Retrieve the fitted Bezier curves of the window. The last curve of the window is only fitted once
+         * it has enough data points, degree + 1 for the first curve and degree - 1 for the others.
+         * @return composite Bezier curve with uniform knots, starting at the end point of frozen_curve()
+         */
+        BasicCompositeBezierCurve<Scalar> window_curve() const;
+
+        /**
+         * @return number of frozen Bezier curves
+         */
+        unsigned int number_of_frozen_curves() const;
+
+        /**
+         * @return number of fitted Bezier curves in the window
+         */
+        unsigned int number_of_fitted_curves() const;
+
+        /**
+         * @return number of data points added so far
+         */
+        unsigned long number_of_points() const;
+
+    private:
+        // data of a Bezier curve in the window, s is the chord length from the last data point of the
+        // previous curve, or from the first data point for the first curve
+        struct WindowCurve {
+            Eigen::VectorXd power_sums; // sum s^k for k = 0, ..., 2n
+            MatrixXd weighted_sums; // d x (n+1), column k is sum s^k p
+            double length = 0; // s of the last data point
+            unsigned int number_of_points = 0;
+            MatrixXd normal_matrix; // T^T T of the chord length parameterization t = s / length
+            MatrixXd projection; // T^T D
+        };
+
+        unsigned int _degree;
+        unsigned int _points_per_curve;
+        unsigned int _window_size;
+        long _dimension;
+        unsigned long _number_of_points;
+        Eigen::VectorXd _last_point;
+
+        std::deque<WindowCurve> _window;
+        std::unique_ptr<BasicCompositeBezierCurve<Scalar>> _frozen;
+        MatrixXd _first_control_points; // 2 x d, first two control points of the window when curves are frozen
+        MatrixXd _fixed; // (n+1) x d, first two columns of C times _first_control_points
+
+        // the Bezier coefficient matrix C split into the unknown and the continuity parts, see _CompositeFit
+        MatrixXd _first_r; // C, all control points of the first curve are unknown
+        MatrixXd _r; // columns 2, ..., n of C
+        MatrixXd _first_q; // first two columns of C times the continuity matrix after the first curve
+        MatrixXd _q; // first two columns of C times the continuity matrix
+
+        // block tridiagonal system of the fitted curves, blocks before _first_dirty_block are up to date
+        vector<MatrixXd> _lower_diagonal, _diagonal, _upper_diagonal, _rhs;
+        unsigned int _first_dirty_block;
+        bool _solved;
+        Matrix _control_points; // d x (1 + n * fitted curves), control points of the fitted curves
+
+        void push_point(const Vector & point);
+        void freeze();
+        void update();
+        void assemble(unsigned int block, unsigned int fitted_curves);
+        unsigned int fitted_curves() const;
+        bool first_is_free() const;
+    };
+
+    typedef BasicOnlineCompositeFitter<double> OnlineCompositeFitter;
+    typedef BasicOnlineCompositeFitter<float> OnlineCompositeFitterf;
+
+    extern template class BasicOnlineCompositeFitter<double>;
+    extern template class BasicOnlineCompositeFitter<float>;
+}
+
+#endif //BEZIER_ONLINE_COMPOSITE_FITTER_H
@@ -0,0 +1,97 @@
+#ifndef BEZIER_PARALLEL_H
+#define BEZIER_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bezier {
+
+    /**
+     * Number of threads to use when none is given.
+     * @return number of hardware threads, at least one
+     */
+    inline unsigned int default_number_of_threads(){
+        return std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /**
+     * Call f(worker, begin, end) on consecutive chunks of [0, n) from several threads.
+     * Threads take the next chunk when they are done with their current one, such that uneven work
+     * is balanced. The calling thread takes part as worker 0 and the first exception thrown by f is
+     * rethrown once all threads are done. Chunks of the same worker are processed one after the
+     * other, so per worker state such as scratch buffers can be indexed by worker without locking.
+     * @param n : number of elements
+     * @param number_of_threads : number of threads including the calling one, 0 uses all hardware threads
+     * @param f : function called with the worker index in [0, number of threads) and the range [begin, end)
+     * of a chunk
+     * @param chunk_size : number of elements per chunk, 0 splits [0, n) into 8 chunks per thread
+     */
+    template <typename F>
+    void parallel_for_workers(long n, unsigned int number_of_threads, F f, long chunk_size = 0){
+        if(number_of_threads == 0){
+            number_of_threads = default_number_of_threads();
+        }
+        if(chunk_size <= 0){
+            chunk_size = std::max(n / (8 * static_cast<long>(number_of_threads)), 1L);
+        }
+        number_of_threads = static_cast<unsigned int>(
+                std::min(static_cast<long>(number_of_threads), (n + chunk_size - 1) / chunk_size));
+        if(number_of_threads <= 1){
+            if(n > 0){
+                f(0u, 0L, n);
+            }
+            return;
+        }
+
+        std::atomic<long> next(0);
+        std::exception_ptr exception;
+        std::mutex mutex;
+        auto work = [&](unsigned int worker){
+            try{
+                for(long begin = next.fetch_add(chunk_size); begin < n; begin = next.fetch_add(chunk_size)){
+                    f(worker, begin, std::min(begin + chunk_size, n));
+                }
+            }
+            catch(...){
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!exception){
+                    exception = std::current_exception();
+                }
+                next = n;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(number_of_threads - 1);
+        for(unsigned int i = 1; i < number_of_threads; i++){
+            threads.emplace_back(work, i);
+        }
+        work(0);
+        for(std::thread & thread : threads){
+            thread.join();
+        }
+        if(exception){
+            std::rethrow_exception(exception);
+        }
+    }
+
+    /**
+     * Call f(begin, end) on consecutive chunks of [0, n) from several threads, see parallel_for_workers.
+     * @param n : number of elements
+     * @param number_of_threads : number of threads including the calling one, 0 uses all hardware threads
+     * @param f : function called with the range [begin, end) of a chunk
+     * @param chunk_size : number of elements per chunk, 0 splits [0, n) into 8 chunks per thread
+     */
+    template <typename F>
+    void parallel_for(long n, unsigned int number_of_threads, F f, long chunk_size = 0){
+        parallel_for_workers(n, number_of_threads, [&f](unsigned int, long begin, long end){
+            f(begin, end);
+        }, chunk_size);
+    }
+}
+
+#endif //BEZIER_PARALLEL_H
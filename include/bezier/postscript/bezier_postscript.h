@@ -7,6 +7,7 @@
 
 #include <bezier/curve.h>
 #include <bezier/bezier_curve.h>
+#include <bezier/fixed_bezier_curve.h>
 
 #include <bezier/postscript/postscript.h>
 
@@ -25,13 +26,34 @@ namespace bezier {
                      const Curve *curve,
                      bool show_control_points=false);
 
-    void _write_control_points(PostScriptWriter & ps_writer, const vector<VectorXd> & points);
+    /**
+     * Write fixed size Bezier curve to PostScript
+     * @param ps_writer : PostScriptWriter to write to
+     * @param curve : fixed size Bezier curve
+     * @param show_control_points : true/false
+     */
+    template <int Degree, int Dim, typename Scalar>
+    void write_curve(PostScriptWriter &ps_writer,
+                     const FixedBezierCurve<Degree, Dim, Scalar> *curve,
+                     bool show_control_points=false){
+        BezierCurve bezier = curve->to_bezier_curve();
+        write_curve(ps_writer, &bezier, show_control_points);
+    }
+
+    void _write_control_points(PostScriptWriter & ps_writer, const Eigen::Ref<const Eigen::MatrixXd> & points);
 
     void _write_bezier_curve(PostScriptWriter & ps_writer, bool show_control_points, const BezierCurve & bezier);
 
-    void _write_line(PostScriptWriter & ps_writer, const BezierCurve & line);
+    void _write_bezier_curve(PostScriptWriter & ps_writer, bool show_control_points,
+                             const Eigen::Ref<const Eigen::MatrixXd> & control_points,
+                             const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients);
+
+    void _write_line(PostScriptWriter & ps_writer, const Eigen::Ref<const Eigen::MatrixXd> & control_points);
+
+    void _write_cubic(PostScriptWriter & ps_writer, const Eigen::Ref<const Eigen::MatrixXd> & control_points);
 
-    void _write_cubic(PostScriptWriter & ps_writer, const BezierCurve & cubic);
+    void _write_polynomial(PostScriptWriter & ps_writer, const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                           int n_samples);
 
     void _write_with_samples(PostScriptWriter & ps_writer, const Curve * curve, int n_samples);
 }
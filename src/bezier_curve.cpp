@@ -1,11 +1,25 @@
 #include <bezier/bezier_curve.h>
+#include <bezier/math/horner.h>
+#include <bezier/math/roots.h>
+#include <bezier/math/subdivision.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace bezier {
     using std::vector;
     using Eigen::VectorXd;
     using Eigen::MatrixXd;
 
-    BezierCurve::BezierCurve(const vector<VectorXd> &control_points) {
+    template <typename Scalar>
+    BasicBezierCurve<Scalar>::BasicBezierCurve(const vector<Vector> &control_points, EvaluationMethod evaluation_method) :
+            BasicBezierCurve(vector<Vector>(control_points), evaluation_method) {}
+
+    template <typename Scalar>
+    BasicBezierCurve<Scalar>::BasicBezierCurve(vector<Vector> &&control_points, EvaluationMethod evaluation_method) :
+            _evaluation_method(evaluation_method) {
         if (control_points.empty()){
             throw std::invalid_argument("Must at least provide one control point.");
         }
@@ -17,7 +31,7 @@ namespace bezier {
                 throw std::invalid_argument("All control points must have the same dimensionality.");
             }
         }
-        _control_points = control_points;
+        _control_points = std::move(control_points);
 
         // initialize control matrix
         _control_matrix.resize(_degree + 1, _dimension);
@@ -26,71 +40,467 @@ namespace bezier {
                 _control_matrix(j, i) = _control_points[j](i);
             }
         }
-        _coefficient_matrix = bezier_coefficients(_degree);
+        _coefficient_matrix = &cached_bezier_coefficients<Scalar>(_degree);
+        // the power basis loses precision quickly, always compute it in double precision
+        _power_coefficients = (cached_bezier_coefficients<double>(_degree)
+                               * _control_matrix.template cast<double>()).transpose().template cast<Scalar>();
+
+        // differentiate the power basis, d/dt A_j t^j = j A_j t^(j-1)
+        _hodographs.reserve(_degree);
+        const Matrix * coefficients = &_power_coefficients;
+        for(int order = 1; order < _degree+1; order++){
+            Matrix hodograph(_dimension, coefficients->cols() - 1);
+            for(int j = 0; j < hodograph.cols(); j++){
+                hodograph.col(j) = (j + 1) * coefficients->col(j + 1);
+            }
+            _hodographs.push_back(std::move(hodograph));
+            coefficients = &_hodographs.back();
+        }
+
+        _bounds = bounds(0, 1);
     }
 
-    BezierCurve::BezierCurve(const std::initializer_list<VectorXd> &control_points) :
-            BezierCurve(vector<VectorXd>(control_points.begin(), control_points.end())) {}
+    template <typename Scalar>
+    BasicBezierCurve<Scalar>::BasicBezierCurve(const std::initializer_list<Vector> &control_points) :
+            BasicBezierCurve(vector<Vector>(control_points.begin(), control_points.end())) {}
 
 
-    vector<VectorXd> BezierCurve::control_points() const {
+    template <typename Scalar>
+    const vector<typename BasicBezierCurve<Scalar>::Vector> & BasicBezierCurve<Scalar>::control_points() const {
         return _control_points;
     }
 
-    unsigned int BezierCurve::degree() const {
+    template <typename Scalar>
+    const typename BasicBezierCurve<Scalar>::Matrix & BasicBezierCurve<Scalar>::power_coefficients() const {
+        return _power_coefficients;
+    }
+
+    template <typename Scalar>
+    unsigned int BasicBezierCurve<Scalar>::degree() const {
         return _degree;
     }
 
-    unsigned int BezierCurve::dimension() const {
+    template <typename Scalar>
+    unsigned int BasicBezierCurve<Scalar>::dimension() const {
         return _dimension;
     }
 
-    MatrixXd BezierCurve::coefficient_matrix() const{
-        return _coefficient_matrix;
+    template <typename Scalar>
+    const typename BasicBezierCurve<Scalar>::Matrix & BasicBezierCurve<Scalar>::coefficient_matrix() const{
+        return *_coefficient_matrix;
     }
 
-    VectorXd BezierCurve::operator()(double t) const {
+    template <typename Scalar>
+    EvaluationMethod BasicBezierCurve<Scalar>::evaluation_method() const {
+        return _evaluation_method;
+    }
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::set_evaluation_method(EvaluationMethod evaluation_method) {
+        _evaluation_method = evaluation_method;
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Vector BasicBezierCurve<Scalar>::operator()(Scalar t) const {
+        Vector point(_dimension);
+        evaluate_into(t, point);
+        return point;
+    }
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::evaluate_into(Scalar t, Eigen::Ref<Vector> out) const {
         if(t < 0 or t > 1){
             throw std::domain_error("Bezier curve only defined on [0,1].");
         }
-        VectorXd tvec(_degree + 1);
-        double t_pow = 1;
-        for(int j = 0; j < _degree+1; j++){
-            tvec(j) = t_pow;
+        if(out.rows() != _dimension){
+            throw std::invalid_argument("Output must have the same dimension as the curve.");
+        }
+        // the curve interpolates its end points, return the exact value rather than the
+        // rounded sum of the power basis coefficients
+        if(t == 1){
+            out = _control_points[_degree];
+            return;
+        }
+        switch(_evaluation_method){
+            case EvaluationMethod::DeCasteljau:
+                de_casteljau(t, out);
+                break;
+            case EvaluationMethod::Bernstein:
+                bernstein(t, out);
+                break;
+            default:
+                horner(t, out);
+        }
+    }
+
+    /**
+     * Scratch space of n+1 scalars, kept on the stack for the degrees used in practice
+     */
+    template <typename Scalar>
+    class _ScratchBuffer {
+    public:
+        explicit _ScratchBuffer(unsigned int size) : _data(_stack) {
+            if(size > stack_size){
+                _heap.resize(size);
+                _data = _heap.data();
+            }
+        }
+        Scalar & operator[](unsigned int i) { return _data[i]; }
+    private:
+        static const unsigned int stack_size = 32;
+        Scalar _stack[stack_size];
+        vector<Scalar> _heap;
+        Scalar * _data;
+    };
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::horner(Scalar t, Eigen::Ref<Vector> out) const {
+        bezier::horner(_power_coefficients, t, out);
+    }
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::de_casteljau(Scalar t, Eigen::Ref<Vector> out) const {
+        // one dimension at a time, each column of the control matrix is contiguous
+        _ScratchBuffer<Scalar> points(_degree + 1);
+        for(int k = 0; k < _dimension; k++){
+            for(int i = 0; i < _degree+1; i++){
+                points[i] = _control_matrix(i, k);
+            }
+            for(int r = 1; r < _degree+1; r++){
+                for(int i = 0; i < _degree+1-r; i++){
+                    points[i] = (1 - t) * points[i] + t * points[i+1];
+                }
+            }
+            out(k) = points[0];
+        }
+    }
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::bernstein(Scalar t, Eigen::Ref<Vector> out) const {
+        // weights (n choose i) t^i (1-t)^(n-i), computed with one pass in each direction.
+        // The last row of the coefficient matrix is +-(n choose i).
+        _ScratchBuffer<Scalar> weights(_degree + 1);
+        Scalar t_pow = 1;
+        for(int i = 0; i < _degree+1; i++){
+            weights[i] = std::abs((*_coefficient_matrix)(_degree, i)) * t_pow;
             t_pow *= t;
         }
-        return tvec.transpose() * _coefficient_matrix * _control_matrix;
+        Scalar s_pow = 1;
+        for(int i = static_cast<int>(_degree); i >= 0; i--){
+            weights[i] *= s_pow;
+            s_pow *= 1 - t;
+        }
+        out.setZero();
+        for(int i = 0; i < _degree+1; i++){
+            out += weights[i] * _control_matrix.row(i).transpose();
+        }
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Matrix BasicBezierCurve<Scalar>::evaluate(const Vector &ts) const {
+        if((ts.array() < 0).any() or (ts.array() > 1).any()){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(_evaluation_method != EvaluationMethod::Horner){
+            Matrix points(_dimension, ts.rows());
+            for(int j = 0; j < ts.rows(); j++){
+                points.col(j) = operator()(ts(j));
+            }
+            return points;
+        }
+        // power matrix with column j equal to (1 t_j t_j^2 ... t_j^n)^T
+        Matrix tmat(_degree + 1, ts.rows());
+        tmat.row(0).setOnes();
+        for(int j = 1; j < _degree+1; j++){
+            tmat.row(j) = tmat.row(j-1).cwiseProduct(ts.transpose());
+        }
+        return _power_coefficients * tmat;
+    }
+
+    template <typename Scalar>
+    void BasicBezierCurve<Scalar>::evaluate_vectorized(const Eigen::Ref<const Vector> &ts, Eigen::Ref<Matrix> points) const {
+        if(points.rows() != ts.rows() or points.cols() != _dimension){
+            throw std::invalid_argument("Output must have one row per parameter and one column per dimension.");
+        }
+        if((ts.array() < 0).any() or (ts.array() > 1).any()){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        horner_batch(_power_coefficients.data(), _dimension, _degree, ts.data(), ts.rows(),
+                     points.data(), points.outerStride());
+
+        // keep the end point exact as in operator()
+        for(long j = 0; j < ts.rows(); j++){
+            if(ts(j) == 1){
+                points.row(j) = _control_points[_degree].transpose();
+            }
+        }
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Vector BasicBezierCurve<Scalar>::derivative(Scalar t, unsigned int order) const {
+        if(t < 0 or t > 1){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(order == 0){
+            return operator()(t);
+        }
+        if(order > _degree){
+            return Vector::Zero(_dimension);
+        }
+        Vector point(_dimension);
+        bezier::horner(_hodographs[order - 1], t, point);
+        return point;
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Matrix BasicBezierCurve<Scalar>::derivative(const Vector &ts, unsigned int order) const {
+        if((ts.array() < 0).any() or (ts.array() > 1).any()){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(order == 0){
+            return evaluate(ts);
+        }
+        if(order > _degree){
+            return Matrix::Zero(_dimension, ts.rows());
+        }
+        const Matrix & hodograph = _hodographs[order - 1];
+        Matrix derivatives(ts.rows(), _dimension);
+        horner_batch(hodograph.data(), _dimension, static_cast<int>(hodograph.cols() - 1), ts.data(), ts.rows(),
+                     derivatives.data(), derivatives.outerStride());
+        return derivatives.transpose();
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Vector BasicBezierCurve<Scalar>::tangent(Scalar t) const {
+        for(unsigned int order = 1; order < _degree+1; order++){
+            Vector direction = derivative(t, order);
+            Scalar norm = direction.norm();
+            if(norm > 0){
+                return direction / norm;
+            }
+        }
+        return Vector::Zero(_dimension);
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Matrix BasicBezierCurve<Scalar>::tangent(const Vector &ts) const {
+        Matrix tangents = derivative(ts, 1);
+        for(long j = 0; j < ts.rows(); j++){
+            Scalar norm = tangents.col(j).norm();
+            if(norm > 0){
+                tangents.col(j) /= norm;
+            }
+            else{
+                tangents.col(j) = tangent(ts(j));
+            }
+        }
+        return tangents;
     }
 
-    std::array<Eigen::VectorXd, 2> BezierCurve::bounds() const {
-        VectorXd min_bound = _control_points[0];
-        VectorXd max_bound = _control_points[0];
-        for (int i = 1; i < _control_points.size(); ++i) {
-            min_bound = min_bound.cwiseMin(_control_points[i]);
-            max_bound = max_bound.cwiseMax(_control_points[i]);
+    template <typename Scalar>
+    Scalar BasicBezierCurve<Scalar>::curvature(Scalar t) const {
+        return bezier::curvature(derivative(t, 1), derivative(t, 2));
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Vector BasicBezierCurve<Scalar>::curvature(const Vector &ts) const {
+        Matrix first = derivative(ts, 1);
+        Matrix second = derivative(ts, 2);
+        Vector curvatures(ts.rows());
+        for(long j = 0; j < ts.rows(); j++){
+            curvatures(j) = bezier::curvature(first.col(j), second.col(j));
+        }
+        return curvatures;
+    }
+
+    template <typename Scalar>
+    std::array<typename BasicBezierCurve<Scalar>::Vector, 2> BasicBezierCurve<Scalar>::bounds() const {
+        return _bounds;
+    }
+
+    template <typename Scalar>
+    std::array<typename BasicBezierCurve<Scalar>::Vector, 2> BasicBezierCurve<Scalar>::bounds(Scalar t0, Scalar t1) const {
+        if(t0 < 0 or t1 > 1){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(t0 > t1){
+            throw std::invalid_argument("Start of the interval must not be after its end.");
+        }
+        Vector min_bound(_dimension), max_bound(_dimension);
+        polynomial_bounds(_power_coefficients, t0, t1, min_bound, max_bound);
+        // the curve interpolates its end points, see operator()
+        if(t0 == 0){
+            min_bound = min_bound.cwiseMin(_control_points.front());
+            max_bound = max_bound.cwiseMax(_control_points.front());
+        }
+        if(t1 == 1){
+            min_bound = min_bound.cwiseMin(_control_points.back());
+            max_bound = max_bound.cwiseMax(_control_points.back());
         }
         return {min_bound, max_bound};
     }
 
+    template <typename Scalar>
+    std::shared_ptr<const ArcLengthTable> BasicBezierCurve<Scalar>::arc_length_table() const {
+        // concurrent callers may both build the table, either one is published
+        std::shared_ptr<const ArcLengthTable> table = std::atomic_load(&_arc_length_table);
+        if(!table){
+            std::shared_ptr<ArcLengthTable> built = std::make_shared<ArcLengthTable>();
+            append_arc_length(_power_coefficients, *built);
+            std::atomic_store(&_arc_length_table, built);
+            table = built;
+        }
+        return table;
+    }
+
+    template <typename Scalar>
+    Scalar BasicBezierCurve<Scalar>::length() const {
+        return static_cast<Scalar>(arc_length_table()->length);
+    }
+
+    template <typename Scalar>
+    Scalar BasicBezierCurve<Scalar>::length_error() const {
+        return static_cast<Scalar>(arc_length_table()->errors[0]);
+    }
+
+    template <typename Scalar>
+    Scalar BasicBezierCurve<Scalar>::length(Scalar t0, Scalar t1) const {
+        if(t0 < 0 or t1 > 1){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(t0 > t1){
+            throw std::invalid_argument("Start of the interval must not be after its end.");
+        }
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        return static_cast<Scalar>(arc_length_at(_power_coefficients, *table, 0, t1) -
+                                   arc_length_at(_power_coefficients, *table, 0, t0));
+    }
+
+    template <typename Scalar>
+    Scalar BasicBezierCurve<Scalar>::param_at_length(Scalar s) const {
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        if(s < 0 or s > static_cast<Scalar>(table->length)){
+            throw std::domain_error("Arc length must be in [0, length()].");
+        }
+        return static_cast<Scalar>(param_at_arc_length(_power_coefficients, *table, 0, s));
+    }
+
+    template <typename Scalar>
+    typename BasicBezierCurve<Scalar>::Vector BasicBezierCurve<Scalar>::param_at_length(const Vector &lengths) const {
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        Vector params(lengths.rows());
+        for(long j = 0; j < lengths.rows(); j++){
+            if(lengths(j) < 0 or lengths(j) > static_cast<Scalar>(table->length)){
+                throw std::domain_error("Arc length must be in [0, length()].");
+            }
+            params(j) = static_cast<Scalar>(param_at_arc_length(_power_coefficients, *table, 0, lengths(j)));
+        }
+        return params;
+    }
+
+    template <typename Scalar>
+    vector<typename BasicBezierCurve<Scalar>::Vector> _columns(const typename BasicBezierCurve<Scalar>::Matrix & points){
+        vector<typename BasicBezierCurve<Scalar>::Vector> columns;
+        columns.reserve(points.cols());
+        for(long j = 0; j < points.cols(); j++){
+            columns.push_back(points.col(j));
+        }
+        return columns;
+    }
+
+    template <typename Scalar>
+    std::array<BasicBezierCurve<Scalar>, 2> BasicBezierCurve<Scalar>::split(Scalar t) const {
+        if(t < 0 or t > 1){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        Matrix left(_dimension, _degree + 1), right(_dimension, _degree + 1);
+        split_control_points(_control_matrix.transpose(), t, left, right);
+        return {BasicBezierCurve(_columns<Scalar>(left), _evaluation_method),
+                BasicBezierCurve(_columns<Scalar>(right), _evaluation_method)};
+    }
+
+    template <typename Scalar>
+    BasicBezierCurve<Scalar> BasicBezierCurve<Scalar>::elevate_degree(unsigned int degree) const {
+        if(degree < _degree){
+            throw std::invalid_argument("Degree can not be lowered by elevation.");
+        }
+        Matrix elevated(_dimension, degree + 1);
+        elevate_control_points(_control_matrix.transpose(), elevated);
+        return BasicBezierCurve(_columns<Scalar>(elevated), _evaluation_method);
+    }
+
+    template <typename Scalar>
+    BasicBezierCurve<Scalar> BasicBezierCurve<Scalar>::reduce_degree(Scalar tolerance) const {
+        if(tolerance < 0){
+            throw std::invalid_argument("Tolerance must be non-negative.");
+        }
+        Matrix points = _control_matrix.transpose();
+        for(unsigned int degree = 1; degree < _degree; degree++){
+            Matrix reduced(_dimension, degree + 1);
+            if(reduce_control_points(points, reduced) <= tolerance){
+                return BasicBezierCurve(_columns<Scalar>(reduced), _evaluation_method);
+            }
+        }
+        return *this;
+    }
+
 
     MatrixXd bezier_coefficients(int degree){
-        MatrixXd coefficient_matrix(degree + 1, degree + 1);
+        if(degree < 0){
+            throw std::domain_error("Bezier curves are defined for degree >= 0.");
+        }
+        MatrixXd coefficient_matrix = MatrixXd::Zero(degree + 1, degree + 1);
 
+        vector<double> degree_row = binomial_coefficients(degree);
+        vector<double> row; // row j of Pascal's triangle
         for(int j = 0; j < degree+1; j++){
-            double coeff = factorial(degree) / factorial(degree - j);
-            for(int i = 0; i < degree+1; i++){
-                if(i <= j){
-                    coefficient_matrix(j, i) = coeff * std::pow(-1, i+j) / (factorial(i) * factorial(j - i));
-                }
-                else{
-                    coefficient_matrix(j, i) = 0;
-                }
+            row.push_back(1);
+            for(int k = j - 1; k > 0; k--){
+                row[k] += row[k - 1];
+            }
+            for(int i = 0; i <= j; i++){
+                double sign = (i + j) % 2 == 0 ? 1 : -1;
+                coefficient_matrix(j, i) = sign * degree_row[j] * row[i];
             }
         }
 
         return coefficient_matrix;
-    };
+    }
 
-}
+    template <typename Scalar>
+    const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> & cached_bezier_coefficients(int degree){
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Matrix;
+
+        // lock-free lookup for common degrees, the matrices are never freed once published
+        static const int table_size = 64;
+        static std::atomic<const Matrix*> table[table_size];
+        static std::map<int, std::unique_ptr<const Matrix>> storage;
+        static std::mutex mutex;
+
+        if(degree < 0){
+            throw std::domain_error("Bezier curves are defined for degree >= 0.");
+        }
+        if(degree < table_size){
+            const Matrix * coefficient_matrix = table[degree].load(std::memory_order_acquire);
+            if(coefficient_matrix != nullptr){
+                return *coefficient_matrix;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<const Matrix> & entry = storage[degree];
+        if(!entry){
+            entry.reset(new Matrix(bezier_coefficients(degree).template cast<Scalar>()));
+            if(degree < table_size){
+                table[degree].store(entry.get(), std::memory_order_release);
+            }
+        }
+        return *entry;
+    }
 
+    template const Eigen::MatrixXd & cached_bezier_coefficients<double>(int degree);
+    template const Eigen::MatrixXf & cached_bezier_coefficients<float>(int degree);
 
+    template class BasicBezierCurve<double>;
+    template class BasicBezierCurve<float>;
+}
@@ -1,82 +1,1032 @@
 #include <bezier/composite_bezier_curve.h>
+#include <bezier/math/horner.h>
+#include <bezier/math/roots.h>
+#include <bezier/math/subdivision.h>
+#include <bezier/parallel.h>
+
+#include <algorithm>
 #include <iostream>
 
 namespace bezier {
 
-    CompositeBezierCurve::CompositeBezierCurve(const vector<vector<VectorXd>> & control_points) {
-        if(control_points.empty()){
-            throw std::invalid_argument("A composite Bezier curve must have at least one Bezier curve.");
-        }
+    template <typename Scalar>
+    const vector<typename BasicCurve<Scalar>::Vector> & _control_points_of(
+            const vector<typename BasicCurve<Scalar>::Vector> & control_points){
+        return control_points;
+    }
 
+    template <typename Scalar>
+    const vector<typename BasicCurve<Scalar>::Vector> & _control_points_of(const BasicBezierCurve<Scalar> & curve){
+        return curve.control_points();
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar>::BasicCompositeBezierCurve(const vector<vector<Vector>> & control_points,
+                                                                 const vector<double> & knots) {
         for(const auto & cp : control_points){
-            _bezier_curves.emplace_back(cp);
+            if(cp.empty()){
+                throw std::invalid_argument("Must at least provide one control point.");
+            }
+            for(const auto & control_point : cp){
+                if(control_point.rows() != cp[0].rows()){
+                    throw std::invalid_argument("All control points must have the same dimensionality.");
+                }
+            }
         }
+        copy_control_points(control_points);
+        initialize(knots);
+    }
 
-        _dimension = _bezier_curves[0].dimension();
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar>::BasicCompositeBezierCurve(const vector<BasicBezierCurve<Scalar>> & bezier_curves,
+                                                                 const vector<double> & knots) {
+        copy_control_points(bezier_curves);
+        initialize(knots);
+    }
 
-        for(int i = 1; i < _bezier_curves.size(); i++){
-            if(_bezier_curves[i-1](1) != _bezier_curves[i](0)){
-                throw std::invalid_argument("A composite Bezier curve must be continuous.");
-            }
-            if(_bezier_curves[i].dimension() != _dimension){
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar>::BasicCompositeBezierCurve(const std::initializer_list<BasicBezierCurve<Scalar>> &bezier_curves) :
+            BasicCompositeBezierCurve(vector<BasicBezierCurve<Scalar>>(bezier_curves)){}
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar>::BasicCompositeBezierCurve(const Matrix & control_points,
+                                                                 const vector<unsigned int> & degrees,
+                                                                 const vector<double> & knots) :
+            BasicCompositeBezierCurve(Matrix(control_points), degrees, knots) {}
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar>::BasicCompositeBezierCurve(Matrix && control_points,
+                                                                 const vector<unsigned int> & degrees,
+                                                                 const vector<double> & knots) :
+            _dimension(static_cast<unsigned int>(control_points.rows())),
+            _control_points(std::move(control_points)),
+            _degrees(degrees) {
+        if(_degrees.empty()){
+            throw std::invalid_argument("A composite Bezier curve must have at least one Bezier curve.");
+        }
+        long number_of_control_points = 1;
+        for(unsigned int degree : _degrees){
+            number_of_control_points += degree;
+        }
+        if(_control_points.cols() != number_of_control_points){
+            throw std::invalid_argument("Number of control points does not match the degrees of the curves.");
+        }
+        initialize(knots);
+    }
+
+    template <typename Scalar>
+    template <typename Curves>
+    void BasicCompositeBezierCurve<Scalar>::copy_control_points(const Curves & curves) {
+        if(curves.empty()){
+            throw std::invalid_argument("A composite Bezier curve must have at least one Bezier curve.");
+        }
+
+        _dimension = static_cast<unsigned int>(_control_points_of<Scalar>(curves[0])[0].rows());
+        long number_of_control_points = 1;
+        for(int i = 0; i < curves.size(); i++){
+            const vector<Vector> & control_points = _control_points_of<Scalar>(curves[i]);
+            if(control_points[0].rows() != _dimension){
                 throw std::invalid_argument("All Bezier curves in a composite Bezier"
                                                     " curve must have the same dimensionality");
             }
+            if(i > 0 and _control_points_of<Scalar>(curves[i-1]).back() != control_points.front()){
+                throw std::invalid_argument("A composite Bezier curve must be continuous.");
+            }
+            number_of_control_points += control_points.size() - 1;
+        }
+
+        // the first control point of each curve is the joint with the previous one
+        _control_points.resize(_dimension, number_of_control_points);
+        _degrees.reserve(curves.size());
+        long offset = 0;
+        for(const auto & curve : curves){
+            const vector<Vector> & control_points = _control_points_of<Scalar>(curve);
+            for(int j = 0; j < control_points.size(); j++){
+                _control_points.col(offset + j) = control_points[j];
+            }
+            _degrees.push_back(static_cast<unsigned int>(control_points.size() - 1));
+            offset += control_points.size() - 1;
         }
     }
 
-    CompositeBezierCurve::CompositeBezierCurve(const vector<BezierCurve> & bezier_curves) {
-        if(bezier_curves.empty()){
-            throw std::invalid_argument("A composite Bezier curve must have at least one Bezier curve.");
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::initialize(const vector<double> & knots) {
+        _first_curve = 0;
+        _max_number_of_curves = 0;
+        _dropped_curves = 0;
+        _arc_length_table.reset();
+        _box_tree.reset();
+
+        unsigned int number_of_curves = static_cast<unsigned int>(_degrees.size());
+        _offsets.clear();
+        _offsets.reserve(number_of_curves);
+        long offset = 0;
+        for(unsigned int degree : _degrees){
+            _offsets.push_back(offset);
+            offset += degree;
         }
+        _power_coefficients.resize(_dimension, offset + number_of_curves);
+        _lower_bounds.resize(_dimension, number_of_curves);
+        _upper_bounds.resize(_dimension, number_of_curves);
+        _lower_window.clear();
+        _upper_window.clear();
 
-        _dimension = bezier_curves[0].dimension();
+        // the buffers are only reallocated when the degree changes
+        MatrixXd control_matrix;
+        MatrixXd power_coefficients;
+        for(unsigned int c = 0; c < number_of_curves; c++){
+            initialize_curve(c, control_matrix, power_coefficients);
+        }
 
-        for(int i = 1; i < bezier_curves.size(); i++){
-            if(bezier_curves[i-1](1) != bezier_curves[i](0)){
-                throw std::invalid_argument("A composite Bezier curve must be continuous.");
+        initialize_knots(knots);
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::initialize_curve(unsigned int c, MatrixXd & control_matrix,
+                                                             MatrixXd & power_coefficients) {
+        unsigned int degree = _degrees[c];
+        auto control_points = _control_points.middleCols(_offsets[c], degree + 1);
+
+        // same operands as in BasicBezierCurve such that both evaluate identically
+        control_matrix = control_points.transpose().template cast<double>();
+        power_coefficients.noalias() = cached_bezier_coefficients<double>(degree) * control_matrix;
+        _power_coefficients.middleCols(_offsets[c] + c, degree + 1) =
+                power_coefficients.transpose().template cast<Scalar>();
+        segment_bounds(c - _first_curve, 0, 1, _lower_bounds.col(c), _upper_bounds.col(c));
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::track_bounds() {
+        if(!_lower_window.empty()){
+            return;
+        }
+        _lower_window.assign(_dimension, std::deque<unsigned long>());
+        _upper_window.assign(_dimension, std::deque<unsigned long>());
+        for(unsigned int c = _first_curve; c < _degrees.size(); c++){
+            push_bounds(c);
+        }
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::push_bounds(unsigned int c) {
+        unsigned long id = c + _dropped_curves;
+        for(unsigned int r = 0; r < _dimension; r++){
+            std::deque<unsigned long> & lower = _lower_window[r];
+            while(!lower.empty() and _lower_bounds(r, lower.back() - _dropped_curves) >= _lower_bounds(r, c)){
+                lower.pop_back();
+            }
+            lower.push_back(id);
+            std::deque<unsigned long> & upper = _upper_window[r];
+            while(!upper.empty() and _upper_bounds(r, upper.back() - _dropped_curves) <= _upper_bounds(r, c)){
+                upper.pop_back();
+            }
+            upper.push_back(id);
+        }
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::initialize_knots(const vector<double> & knots) {
+        _uniform_knots = knots.empty();
+        _knots.clear();
+        if(_uniform_knots){
+            return;
+        }
+
+        if(knots.size() != number_of_curves() + 1){
+            throw std::invalid_argument("A composite Bezier curve of n curves requires n+1 knots.");
+        }
+        for(int i = 1; i < knots.size(); i++){
+            if(!(knots[i] > knots[i-1])){
+                throw std::invalid_argument("Knots must be strictly increasing.");
+            }
+        }
+        // the knots are rescaled to [0,1] on lookup such that curves can be appended and removed
+        _knots = knots;
+        build_buckets();
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::build_buckets() {
+        static const int bucket_threshold = 64;
+        int number_of_curves = static_cast<int>(this->number_of_curves());
+        _buckets.clear();
+        _changes_since_buckets = 0;
+        if(_uniform_knots or number_of_curves < bucket_threshold){
+            return;
+        }
+
+        // bucket b covers [b / n, (b+1) / n) and stores the curve containing b / n
+        const double * knots = _knots.data() + _first_curve;
+        double length = knots[number_of_curves] - knots[0];
+        _buckets.resize(number_of_curves + 1);
+        int curve = 0;
+        for(int b = 0; b < number_of_curves; b++){
+            double bucket_start = knots[0] + b / (double) number_of_curves * length;
+            while(knots[curve + 1] <= bucket_start){
+                curve++;
+            }
+            _buckets[b] = curve;
+        }
+        _buckets[number_of_curves] = number_of_curves - 1;
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::update_buckets() {
+        // appending or removing a curve rescales all knots, fall back to a binary search until
+        // enough changes have accumulated to rebuild the buckets in amortized constant time
+        if(_uniform_knots){
+            return;
+        }
+        _buckets.clear();
+        _changes_since_buckets++;
+        if(_changes_since_buckets > number_of_curves() / 2){
+            build_buckets();
+        }
+    }
+
+    template <typename Scalar>
+    long BasicCompositeBezierCurve<Scalar>::end_column() const {
+        return _offsets.back() + _degrees.back() + 1;
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::compact() {
+        long first_column = _offsets[_first_curve];
+        long first_coefficient = first_column + _first_curve;
+        long end_coefficient = end_column() + _degrees.size() - 1;
+        unsigned int number_of_curves = this->number_of_curves();
+
+        // move the remaining curves to the front of the buffers, the ranges may overlap
+        std::copy(_control_points.data() + first_column * _dimension, _control_points.data() + end_column() * _dimension,
+                  _control_points.data());
+        std::copy(_power_coefficients.data() + first_coefficient * _dimension,
+                  _power_coefficients.data() + end_coefficient * _dimension, _power_coefficients.data());
+        std::copy(_lower_bounds.data() + _first_curve * _dimension,
+                  _lower_bounds.data() + (_first_curve + number_of_curves) * _dimension, _lower_bounds.data());
+        std::copy(_upper_bounds.data() + _first_curve * _dimension,
+                  _upper_bounds.data() + (_first_curve + number_of_curves) * _dimension, _upper_bounds.data());
+
+        // only keep the arc length of the remaining curves
+        if(ArcLengthTable * table = mutable_arc_length_table()){
+            unsigned long first = _first_curve + _dropped_curves - table->first_curve;
+            long first_piece = table->offsets[first];
+            table->params.erase(table->params.begin(), table->params.begin() + first_piece);
+            table->lengths.erase(table->lengths.begin(), table->lengths.begin() + first_piece);
+            table->offsets.erase(table->offsets.begin(), table->offsets.begin() + first);
+            table->errors.erase(table->errors.begin(), table->errors.begin() + first);
+            table->unconverged.erase(table->unconverged.begin(), table->unconverged.begin() + first);
+            for(long & offset : table->offsets){
+                offset -= first_piece;
             }
-            if(bezier_curves[i].dimension() != _dimension){
+            table->first_curve += first;
+        }
+
+        _offsets.erase(_offsets.begin(), _offsets.begin() + _first_curve);
+        for(long & offset : _offsets){
+            offset -= first_column;
+        }
+        _degrees.erase(_degrees.begin(), _degrees.begin() + _first_curve);
+        if(!_uniform_knots){
+            _knots.erase(_knots.begin(), _knots.begin() + _first_curve);
+        }
+        _dropped_curves += _first_curve;
+        _first_curve = 0;
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::reserve_curve(unsigned int degree) {
+        // grow geometrically such that appending is amortized constant time
+        long columns = end_column() + degree;
+        if(columns > _control_points.cols()){
+            _control_points.conservativeResize(Eigen::NoChange, std::max(columns, 2 * _control_points.cols()));
+        }
+        long coefficients = end_column() + _degrees.size() + degree;
+        if(coefficients > _power_coefficients.cols()){
+            _power_coefficients.conservativeResize(Eigen::NoChange, std::max(coefficients, 2 * _power_coefficients.cols()));
+        }
+        long curves = _degrees.size() + 1;
+        if(curves > _lower_bounds.cols()){
+            _lower_bounds.conservativeResize(Eigen::NoChange, std::max(curves, 2 * _lower_bounds.cols()));
+            _upper_bounds.conservativeResize(Eigen::NoChange, std::max(curves, 2 * _upper_bounds.cols()));
+        }
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::append(const vector<Vector> & control_points, double knot_span) {
+        if(control_points.empty()){
+            throw std::invalid_argument("Must at least provide one control point.");
+        }
+        for(const auto & control_point : control_points){
+            if(control_point.rows() != _dimension){
                 throw std::invalid_argument("All Bezier curves in a composite Bezier"
                                                     " curve must have the same dimensionality");
             }
         }
+        if(control_points.front() != _control_points.col(end_column() - 1)){
+            throw std::invalid_argument("A composite Bezier curve must be continuous.");
+        }
+
+        unsigned int degree = static_cast<unsigned int>(control_points.size() - 1);
+        track_bounds();
+        reserve_curve(degree);
+        // the first control point is the joint with the previous curve
+        long offset = end_column() - 1;
+        for(unsigned int j = 1; j < degree + 1; j++){
+            _control_points.col(offset + j) = control_points[j];
+        }
+        _offsets.push_back(offset);
+        _degrees.push_back(degree);
+        MatrixXd control_matrix;
+        MatrixXd power_coefficients;
+        initialize_curve(static_cast<unsigned int>(_degrees.size() - 1), control_matrix, power_coefficients);
+        push_bounds(static_cast<unsigned int>(_degrees.size() - 1));
+        if(!_uniform_knots){
+            _knots.push_back(_knots.back() + knot_span);
+        }
+        if(ArcLengthTable * table = mutable_arc_length_table()){
+            append_arc_length(this->power_coefficients(number_of_curves() - 1), *table);
+        }
+        _box_tree.reset();
 
-        for(auto it = bezier_curves.begin(); it != bezier_curves.end(); ++it) {
-            _bezier_curves.push_back(*it);
+        if(_max_number_of_curves != 0 and number_of_curves() > _max_number_of_curves){
+            pop_front_segment();
+        }
+        else{
+            update_buckets();
         }
     }
 
-    CompositeBezierCurve::CompositeBezierCurve(const std::initializer_list<BezierCurve> &bezier_curves) :
-            CompositeBezierCurve(vector<BezierCurve>(bezier_curves)){}
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::append_segment(const vector<Vector> & control_points) {
+        if(!_uniform_knots){
+            throw std::invalid_argument("A curve with non-uniform knots requires the knot span of the appended curve.");
+        }
+        append(control_points, 0);
+    }
 
-    unsigned int CompositeBezierCurve::dimension() const {
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::append_segment(const vector<Vector> & control_points, double knot_span) {
+        if(_uniform_knots){
+            throw std::invalid_argument("A curve with uniform knots does not take a knot span.");
+        }
+        if(!(knot_span > 0)){
+            throw std::invalid_argument("Knots must be strictly increasing.");
+        }
+        append(control_points, knot_span);
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::pop_front_segment() {
+        if(number_of_curves() == 1){
+            throw std::invalid_argument("A composite Bezier curve must have at least one Bezier curve.");
+        }
+        track_bounds();
+        _first_curve++;
+        _box_tree.reset();
+        unsigned long first_id = _first_curve + _dropped_curves;
+        for(unsigned int r = 0; r < _dimension; r++){
+            while(_lower_window[r].front() < first_id){
+                _lower_window[r].pop_front();
+            }
+            while(_upper_window[r].front() < first_id){
+                _upper_window[r].pop_front();
+            }
+        }
+
+        // drop the removed curves once they take up as much space as the remaining ones
+        if(_first_curve >= number_of_curves()){
+            compact();
+        }
+        update_buckets();
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::set_max_number_of_curves(unsigned int max_number_of_curves) {
+        _max_number_of_curves = max_number_of_curves;
+        while(_max_number_of_curves != 0 and number_of_curves() > _max_number_of_curves){
+            pop_front_segment();
+        }
+    }
+
+    template <typename Scalar>
+    unsigned int BasicCompositeBezierCurve<Scalar>::max_number_of_curves() const {
+        return _max_number_of_curves;
+    }
+
+    template <typename Scalar>
+    unsigned int BasicCompositeBezierCurve<Scalar>::dimension() const {
         return _dimension;
     }
 
-    vector<BezierCurve> CompositeBezierCurve::bezier_curves() const {
-        return _bezier_curves;
+    template <typename Scalar>
+    vector<BasicBezierCurve<Scalar>> BasicCompositeBezierCurve<Scalar>::bezier_curves() const {
+        vector<BasicBezierCurve<Scalar>> bezier_curves;
+        bezier_curves.reserve(number_of_curves());
+        for(const Segment & segment : segments()){
+            bezier_curves.push_back(segment.to_bezier_curve());
+        }
+        return bezier_curves;
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Segment BasicCompositeBezierCurve<Scalar>::segment(unsigned int i) const {
+        if(i >= number_of_curves()){
+            throw std::out_of_range("Curve index out of range.");
+        }
+        return Segment(*this, i);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::SegmentRange BasicCompositeBezierCurve<Scalar>::segments() const {
+        return SegmentRange(*this);
+    }
+
+    template <typename Scalar>
+    unsigned int BasicCompositeBezierCurve<Scalar>::number_of_curves() const {
+        return static_cast<unsigned int>(_degrees.size() - _first_curve);
+    }
+
+    template <typename Scalar>
+    vector<double> BasicCompositeBezierCurve<Scalar>::knots() const {
+        unsigned int number_of_curves = this->number_of_curves();
+        vector<double> knots(number_of_curves + 1);
+        for(unsigned int i = 0; i < number_of_curves + 1; i++){
+            knots[i] = knot(i);
+        }
+        return knots;
+    }
+
+    template <typename Scalar>
+    double BasicCompositeBezierCurve<Scalar>::knot(unsigned int i) const {
+        unsigned int number_of_curves = this->number_of_curves();
+        if(i == number_of_curves){
+            return 1;
+        }
+        if(_uniform_knots){
+            return i / (double) number_of_curves;
+        }
+        const double * k = _knots.data() + _first_curve;
+        return (k[i] - k[0]) / (k[number_of_curves] - k[0]);
+    }
+
+    template <typename Scalar>
+    bool BasicCompositeBezierCurve<Scalar>::has_uniform_knots() const {
+        return _uniform_knots;
+    }
+
+    template <typename Scalar>
+    std::pair<int, double> BasicCompositeBezierCurve<Scalar>::local_param(double t) const {
+        int number_of_curves = static_cast<int>(this->number_of_curves());
+        if(_uniform_knots){
+            return global_to_local_param(t, number_of_curves);
+        }
+        if(t == 1){
+            return std::make_pair(number_of_curves - 1, 1.0);
+        }
+
+        // the curve i with k_i <= u < k_(i+1) where u is t in the knots before rescaling
+        const double * knots = _knots.data() + _first_curve;
+        double u = knots[0] + t * (knots[number_of_curves] - knots[0]);
+        const double * first = knots + 1;
+        const double * last = knots + number_of_curves;
+        if(!_buckets.empty()){
+            // also search the neighbouring curves since t * n may round into the next bucket
+            int bucket = std::min(static_cast<int>(t * number_of_curves), number_of_curves - 1);
+            first = knots + std::max(_buckets[bucket], 1);
+            last = knots + std::min(_buckets[bucket + 1] + 2, number_of_curves);
+        }
+        int curve_index = static_cast<int>(std::upper_bound(first, last, u) - knots) - 1;
+        double local = (u - knots[curve_index]) / (knots[curve_index + 1] - knots[curve_index]);
+        return std::make_pair(curve_index, std::min(local, 1.0));
+    }
+
+    template <typename Scalar>
+    double BasicCompositeBezierCurve<Scalar>::local_param_scale(unsigned int i) const {
+        if(_uniform_knots){
+            return static_cast<double>(number_of_curves());
+        }
+        const double * knots = _knots.data() + _first_curve;
+        return (knots[number_of_curves()] - knots[0]) / (knots[i + 1] - knots[i]);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Matrix::ConstColsBlockXpr
+    BasicCompositeBezierCurve<Scalar>::control_points() const {
+        long first_column = _offsets[_first_curve];
+        return _control_points.middleCols(first_column, end_column() - first_column);
+    }
+
+    template <typename Scalar>
+    vector<long> BasicCompositeBezierCurve<Scalar>::offsets() const {
+        vector<long> offsets(_offsets.begin() + _first_curve, _offsets.end());
+        for(long & offset : offsets){
+            offset -= _offsets[_first_curve];
+        }
+        return offsets;
+    }
+
+    template <typename Scalar>
+    long BasicCompositeBezierCurve<Scalar>::offset(unsigned int i) const {
+        return _offsets[_first_curve + i] - _offsets[_first_curve];
+    }
+
+    template <typename Scalar>
+    vector<unsigned int> BasicCompositeBezierCurve<Scalar>::degrees() const {
+        return vector<unsigned int>(_degrees.begin() + _first_curve, _degrees.end());
     }
 
+    template <typename Scalar>
+    unsigned int BasicCompositeBezierCurve<Scalar>::degree(unsigned int i) const {
+        return _degrees[_first_curve + i];
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Matrix::ConstColsBlockXpr
+    BasicCompositeBezierCurve<Scalar>::power_coefficients(unsigned int i) const {
+        unsigned int c = _first_curve + i;
+        return _power_coefficients.middleCols(_offsets[c] + c, _degrees[c] + 1);
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::evaluate_segment(unsigned int i, Scalar t, Eigen::Ref<Vector> out,
+                                                             unsigned int order) const {
+        // the curves interpolate their end points, see BasicBezierCurve
+        if(order == 0 and t == 1){
+            unsigned int c = _first_curve + i;
+            out = _control_points.col(_offsets[c] + _degrees[c]);
+            return;
+        }
+        horner(power_coefficients(i), t, out, order);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Vector BasicCompositeBezierCurve<Scalar>::operator()(Scalar t) const {
+        Vector point(_dimension);
+        evaluate_into(t, point);
+        return point;
+    }
 
-    VectorXd CompositeBezierCurve::operator()(double t) const {
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::evaluate_into(Scalar t, Eigen::Ref<Vector> out) const {
         if(t < 0 or t > 1){
             throw std::domain_error("Composite Bezier curve only defined on [0,1].");
         }
-        std::pair<int, double> local_param = global_to_local_param(t, _bezier_curves.size());
-        return _bezier_curves[local_param.first](local_param.second);
+        if(out.rows() != _dimension){
+            throw std::invalid_argument("Output must have the same dimension as the curve.");
+        }
+        std::pair<int, double> local = local_param(t);
+        evaluate_segment(local.first, local.second, out);
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::evaluate_sorted(const Eigen::Ref<const Vector> &ts, Eigen::Ref<Matrix> points) const {
+        if(points.rows() != ts.rows() or points.cols() != _dimension){
+            throw std::invalid_argument("Output must have one row per parameter and one column per dimension.");
+        }
+        long m = ts.rows();
+        if(m == 0){
+            return;
+        }
+        if(ts(0) < 0 or ts(m - 1) > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        for(long j = 1; j < m; j++){
+            if(ts(j) < ts(j - 1)){
+                throw std::invalid_argument("Parameters must be sorted in non-decreasing order.");
+            }
+        }
+
+        // the local parameters of one block are kept on the stack
+        static const long block_size = 256;
+        Scalar local_ts[block_size];
+
+        int number_of_curves = static_cast<int>(this->number_of_curves());
+        const double * knots = _knots.data() + _first_curve;
+        int curve = 0;
+        // the curve containing t and the local parameter given that t is not before the current curve,
+        // same as local_param(t)
+        auto local_param_of = [&](Scalar t) -> std::pair<int, double> {
+            if(_uniform_knots){
+                return global_to_local_param(t, number_of_curves);
+            }
+            if(t == 1){
+                return std::make_pair(number_of_curves - 1, 1.0);
+            }
+            double u = knots[0] + t * (knots[number_of_curves] - knots[0]);
+            int i = curve;
+            while(i < number_of_curves - 1 and knots[i + 1] <= u){
+                i++;
+            }
+            return std::make_pair(i, std::min((u - knots[i]) / (knots[i + 1] - knots[i]), 1.0));
+        };
+
+        long first = 0;
+        while(first < m){
+            std::pair<int, double> local = local_param_of(ts(first));
+            curve = local.first;
+            local_ts[0] = static_cast<Scalar>(local.second);
+
+            long last = first + 1;
+            while(last < m and last - first < block_size){
+                local = local_param_of(ts(last));
+                if(local.first != curve){
+                    break;
+                }
+                local_ts[last - first] = static_cast<Scalar>(local.second);
+                last++;
+            }
+            unsigned int c = _first_curve + curve;
+            horner_batch(_power_coefficients.data() + (_offsets[c] + c) * _dimension, _dimension,
+                         _degrees[c], local_ts, last - first,
+                         points.data() + first, points.outerStride());
+            first = last;
+        }
+
+        // keep the end point exact as in operator()
+        for(long j = m - 1; j >= 0 and ts(j) == 1; j--){
+            points.row(j) = _control_points.col(end_column() - 1).transpose();
+        }
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Vector BasicCompositeBezierCurve<Scalar>::derivative(Scalar t, unsigned int order) const {
+        if(t < 0 or t > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        std::pair<int, double> local = local_param(t);
+        Vector point(_dimension);
+        evaluate_segment(local.first, local.second, point, order);
+        // chain rule, the local parameter is (t - k_i) / (k_(i+1) - k_i)
+        Scalar scale = static_cast<Scalar>(std::pow(local_param_scale(local.first), order));
+        return scale * point;
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Matrix BasicCompositeBezierCurve<Scalar>::derivative(const Vector &ts, unsigned int order) const {
+        Matrix derivatives(_dimension, ts.rows());
+        for(long j = 0; j < ts.rows(); j++){
+            derivatives.col(j) = derivative(ts(j), order);
+        }
+        return derivatives;
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Vector BasicCompositeBezierCurve<Scalar>::tangent(Scalar t) const {
+        if(t < 0 or t > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        std::pair<int, double> local = local_param(t);
+        // the first non-vanishing derivative, see BasicBezierCurve::tangent
+        Vector direction(_dimension);
+        for(unsigned int order = 1; order < _degrees[_first_curve + local.first] + 1; order++){
+            evaluate_segment(local.first, local.second, direction, order);
+            Scalar norm = direction.norm();
+            if(norm > 0){
+                return direction / norm;
+            }
+        }
+        return Vector::Zero(_dimension);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Matrix BasicCompositeBezierCurve<Scalar>::tangent(const Vector &ts) const {
+        Matrix tangents(_dimension, ts.rows());
+        for(long j = 0; j < ts.rows(); j++){
+            tangents.col(j) = tangent(ts(j));
+        }
+        return tangents;
+    }
+
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::curvature(Scalar t) const {
+        if(t < 0 or t > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        // curvature does not depend on the parameterization
+        std::pair<int, double> local = local_param(t);
+        Vector first(_dimension), second(_dimension);
+        evaluate_segment(local.first, local.second, first, 1);
+        evaluate_segment(local.first, local.second, second, 2);
+        return bezier::curvature(first, second);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Vector BasicCompositeBezierCurve<Scalar>::curvature(const Vector &ts) const {
+        Vector curvatures(ts.rows());
+        for(long j = 0; j < ts.rows(); j++){
+            curvatures(j) = curvature(ts(j));
+        }
+        return curvatures;
+    }
+
+    template <typename Scalar>
+    std::array<typename BasicCompositeBezierCurve<Scalar>::Vector, 2> BasicCompositeBezierCurve<Scalar>::bounds() const {
+        if(_lower_window.empty()){
+            return {_lower_bounds.middleCols(_first_curve, number_of_curves()).rowwise().minCoeff(),
+                    _upper_bounds.middleCols(_first_curve, number_of_curves()).rowwise().maxCoeff()};
+        }
+        // sliding window minimum and maximum of the bounds of each curve
+        Vector lower(_dimension), upper(_dimension);
+        for(unsigned int r = 0; r < _dimension; r++){
+            lower(r) = _lower_bounds(r, _lower_window[r].front() - _dropped_curves);
+            upper(r) = _upper_bounds(r, _upper_window[r].front() - _dropped_curves);
+        }
+        return {lower, upper};
+    }
+
+    template <typename Scalar>
+    std::array<typename BasicCompositeBezierCurve<Scalar>::Vector, 2>
+    BasicCompositeBezierCurve<Scalar>::bounds(Scalar t0, Scalar t1) const {
+        if(t0 < 0 or t1 > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        if(t0 > t1){
+            throw std::invalid_argument("Start of the interval must not be after its end.");
+        }
+        std::pair<int, double> first = local_param(t0);
+        std::pair<int, double> last = local_param(t1);
+        Vector lower(_dimension), upper(_dimension);
+        if(first.first == last.first){
+            segment_bounds(first.first, first.second, last.second, lower, upper);
+            return {lower, upper};
+        }
+
+        segment_bounds(first.first, first.second, 1, lower, upper);
+        Vector last_lower(_dimension), last_upper(_dimension);
+        segment_bounds(last.first, 0, last.second, last_lower, last_upper);
+        lower = lower.cwiseMin(last_lower);
+        upper = upper.cwiseMax(last_upper);
+        long inner = last.first - first.first - 1;
+        if(inner > 0){
+            long c = _first_curve + first.first + 1;
+            lower = lower.cwiseMin(_lower_bounds.middleCols(c, inner).rowwise().minCoeff());
+            upper = upper.cwiseMax(_upper_bounds.middleCols(c, inner).rowwise().maxCoeff());
+        }
+        return {lower, upper};
+    }
+
+    template <typename Scalar>
+    void BasicCompositeBezierCurve<Scalar>::segment_bounds(unsigned int i, Scalar t0, Scalar t1,
+                                                           Eigen::Ref<Vector> min_bound,
+                                                           Eigen::Ref<Vector> max_bound) const {
+        polynomial_bounds(power_coefficients(i), t0, t1, min_bound, max_bound);
+        // the curves interpolate their end points, see evaluate_segment
+        unsigned int c = _first_curve + i;
+        if(t0 == 0){
+            min_bound = min_bound.cwiseMin(_control_points.col(_offsets[c]));
+            max_bound = max_bound.cwiseMax(_control_points.col(_offsets[c]));
+        }
+        if(t1 == 1){
+            min_bound = min_bound.cwiseMin(_control_points.col(_offsets[c] + _degrees[c]));
+            max_bound = max_bound.cwiseMax(_control_points.col(_offsets[c] + _degrees[c]));
+        }
+    }
+
+    template <typename Scalar>
+    std::shared_ptr<const ArcLengthTable> BasicCompositeBezierCurve<Scalar>::arc_length_table() const {
+        // concurrent callers may both build the table, either one is published
+        std::shared_ptr<const ArcLengthTable> table = std::atomic_load(&_arc_length_table);
+        if(!table){
+            std::shared_ptr<ArcLengthTable> built = std::make_shared<ArcLengthTable>();
+            built->first_curve = _first_curve + _dropped_curves;
+            built->offsets.reserve(number_of_curves());
+            for(unsigned int i = 0; i < number_of_curves(); i++){
+                append_arc_length(power_coefficients(i), *built);
+            }
+            std::atomic_store(&_arc_length_table, built);
+            table = built;
+        }
+        return table;
+    }
+
+    template <typename Scalar>
+    ArcLengthTable * BasicCompositeBezierCurve<Scalar>::mutable_arc_length_table() {
+        if(!_arc_length_table){
+            return nullptr;
+        }
+        // copies of the curve share the table
+        if(_arc_length_table.use_count() > 1){
+            _arc_length_table = std::make_shared<ArcLengthTable>(*_arc_length_table);
+        }
+        return _arc_length_table.get();
     }
 
-    std::array<VectorXd, 2> CompositeBezierCurve::bounds() const {
-        std::array<VectorXd, 2> min_max = _bezier_curves[0].bounds();
-        for (int i = 1; i < _bezier_curves.size(); ++i) {
-            std::array<VectorXd, 2> tmp_bounds = _bezier_curves[i].bounds();
-            min_max[0] = min_max[0].cwiseMin(tmp_bounds[0]);
-            min_max[1] = min_max[1].cwiseMax(tmp_bounds[1]);
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::global_param(unsigned int i, double t) const {
+        unsigned int number_of_curves = this->number_of_curves();
+        if(i == number_of_curves - 1 and t == 1){
+            return 1;
         }
-        return min_max;
+        if(_uniform_knots){
+            return static_cast<Scalar>((i + t) / number_of_curves);
+        }
+        const double * knots = _knots.data() + _first_curve;
+        double u = knots[i] + t * (knots[i + 1] - knots[i]);
+        return static_cast<Scalar>(std::min((u - knots[0]) / (knots[number_of_curves] - knots[0]), 1.0));
     }
 
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::length() const {
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        unsigned long first = _first_curve + _dropped_curves - table->first_curve;
+        return static_cast<Scalar>(table->length - table->lengths[table->offsets[first]]);
+    }
+
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::length_error() const {
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        unsigned long first = _first_curve + _dropped_curves - table->first_curve;
+        double error = 0;
+        for(unsigned long i = first; i < first + number_of_curves(); i++){
+            error += table->errors[i];
+        }
+        return static_cast<Scalar>(error);
+    }
+
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::length(Scalar t0, Scalar t1) const {
+        if(t0 < 0 or t1 > 1){
+            throw std::domain_error("Composite Bezier curve only defined on [0,1].");
+        }
+        if(t0 > t1){
+            throw std::invalid_argument("Start of the interval must not be after its end.");
+        }
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        unsigned long first = _first_curve + _dropped_curves - table->first_curve;
+        std::pair<int, double> start = local_param(t0);
+        std::pair<int, double> end = local_param(t1);
+        return static_cast<Scalar>(
+                arc_length_at(power_coefficients(end.first), *table, first + end.first, end.second) -
+                arc_length_at(power_coefficients(start.first), *table, first + start.first, start.second));
+    }
+
+    template <typename Scalar>
+    Scalar BasicCompositeBezierCurve<Scalar>::param_at_length(Scalar s) const {
+        Vector lengths(1);
+        lengths(0) = s;
+        return param_at_length(lengths)(0);
+    }
+
+    template <typename Scalar>
+    typename BasicCompositeBezierCurve<Scalar>::Vector
+    BasicCompositeBezierCurve<Scalar>::param_at_length(const Vector &lengths) const {
+        std::shared_ptr<const ArcLengthTable> table = arc_length_table();
+        unsigned long first = _first_curve + _dropped_curves - table->first_curve;
+        double start = table->lengths[table->offsets[first]];
+        Scalar length = static_cast<Scalar>(table->length - start);
+        Vector params(lengths.rows());
+        for(long j = 0; j < lengths.rows(); j++){
+            if(lengths(j) < 0 or lengths(j) > length){
+                throw std::domain_error("Arc length must be in [0, length()].");
+            }
+            unsigned long curve = curve_at_arc_length(*table, start + lengths(j), first);
+            unsigned int i = static_cast<unsigned int>(curve - first);
+            params(j) = global_param(i, param_at_arc_length(power_coefficients(i), *table, curve, start + lengths(j)));
+        }
+        return params;
+    }
+
+    template <typename Scalar>
+    std::shared_ptr<const BoxTree> BasicCompositeBezierCurve<Scalar>::box_tree() const {
+        // concurrent callers may both build the tree, either one is published
+        std::shared_ptr<const BoxTree> tree = std::atomic_load(&_box_tree);
+        if(!tree){
+            tree = std::make_shared<const BoxTree>(build_box_tree(
+                    _lower_bounds.middleCols(_first_curve, number_of_curves()).template cast<double>(),
+                    _upper_bounds.middleCols(_first_curve, number_of_curves()).template cast<double>()));
+            std::atomic_store(&_box_tree, tree);
+        }
+        return tree;
+    }
+
+    template <typename Scalar>
+    vector<typename BasicCompositeBezierCurve<Scalar>::Projection>
+    BasicCompositeBezierCurve<Scalar>::project(const Matrix &points, unsigned int number_of_threads) const {
+        if(points.rows() != _dimension){
+            throw std::invalid_argument("Points must have the same dimension as the curve.");
+        }
+        std::shared_ptr<const BoxTree> tree = box_tree();
+        vector<Projection> projections(points.cols());
+        parallel_for(points.cols(), number_of_threads, [&](long begin, long end){
+            VectorXd point(_dimension);
+            for(long j = begin; j < end; j++){
+                point = points.col(j).template cast<double>();
+                Projection & projection = projections[j];
+                double best = std::numeric_limits<double>::infinity();
+                nearest_boxes(*tree, point, [&](long i){
+                    std::pair<double, double> closest = closest_point(power_coefficients(i), points.col(j));
+                    if(closest.second < best){
+                        best = closest.second;
+                        projection.segment = static_cast<unsigned int>(i);
+                        projection.t = static_cast<Scalar>(closest.first);
+                    }
+                    return closest.second;
+                });
+                projection.distance = static_cast<Scalar>(std::sqrt(best));
+            }
+        }, 64);
+        return projections;
+    }
+
+    template <typename Scalar>
+    vector<double> BasicCompositeBezierCurve<Scalar>::unscaled_knots() const {
+        return _uniform_knots ? vector<double>() : vector<double>(_knots.begin() + _first_curve, _knots.end());
+    }
+
+    template <typename Scalar>
+    std::array<BasicCompositeBezierCurve<Scalar>, 2> BasicCompositeBezierCurve<Scalar>::split(Scalar t) const {
+        if(t <= 0 or t >= 1){
+            throw std::domain_error("Composite Bezier curve can only be split in (0,1).");
+        }
+        std::pair<int, double> local = local_param(t);
+        unsigned int i = static_cast<unsigned int>(local.first);
+        unsigned int c = _first_curve + i;
+        auto control_points = this->control_points();
+        long start = _offsets[c] - _offsets[_first_curve];
+        vector<unsigned int> degrees = this->degrees();
+        vector<double> knots = unscaled_knots();
+        vector<unsigned int> left_degrees(degrees.begin(), degrees.begin() + i);
+        vector<unsigned int> right_degrees(degrees.begin() + i, degrees.end());
+
+        if(local.second == 0){
+            // t is the joint at the start of curve i
+            vector<double> left_knots, right_knots;
+            if(!knots.empty()){
+                left_knots.assign(knots.begin(), knots.begin() + i + 1);
+                right_knots.assign(knots.begin() + i, knots.end());
+            }
+            return {BasicCompositeBezierCurve(Matrix(control_points.leftCols(start + 1)), left_degrees, left_knots),
+                    BasicCompositeBezierCurve(Matrix(control_points.rightCols(control_points.cols() - start)),
+                                              right_degrees, right_knots)};
+        }
+
+        unsigned int degree = _degrees[c];
+        Matrix left(_dimension, start + degree + 1);
+        Matrix right(_dimension, control_points.cols() - start);
+        left.leftCols(start + 1) = control_points.leftCols(start + 1);
+        right.rightCols(right.cols() - degree) = control_points.rightCols(right.cols() - degree);
+        split_control_points(control_points.middleCols(start, degree + 1), static_cast<Scalar>(local.second),
+                             left.rightCols(degree + 1), right.leftCols(degree + 1));
+        left_degrees.push_back(degree);
+
+        if(knots.empty()){
+            for(unsigned int j = 0; j < number_of_curves() + 1; j++){
+                knots.push_back(j);
+            }
+        }
+        double u = knots[i] + local.second * (knots[i + 1] - knots[i]);
+        vector<double> left_knots(knots.begin(), knots.begin() + i + 1);
+        left_knots.push_back(u);
+        vector<double> right_knots(1, u);
+        right_knots.insert(right_knots.end(), knots.begin() + i + 1, knots.end());
+        return {BasicCompositeBezierCurve(std::move(left), left_degrees, left_knots),
+                BasicCompositeBezierCurve(std::move(right), right_degrees, right_knots)};
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> BasicCompositeBezierCurve<Scalar>::elevate_degree(unsigned int degree) const {
+        unsigned int number_of_curves = this->number_of_curves();
+        for(unsigned int i = 0; i < number_of_curves; i++){
+            if(degree < this->degree(i)){
+                throw std::invalid_argument("Degree can not be lowered by elevation.");
+            }
+        }
+        // each curve writes its first control point, the joint, over the last one of the previous curve
+        Matrix points(_dimension, 1 + number_of_curves * static_cast<long>(degree));
+        for(unsigned int i = 0; i < number_of_curves; i++){
+            elevate_control_points(segment(i).control_points(), points.middleCols(i * static_cast<long>(degree), degree + 1));
+        }
+        return BasicCompositeBezierCurve(std::move(points), vector<unsigned int>(number_of_curves, degree),
+                                         unscaled_knots());
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> BasicCompositeBezierCurve<Scalar>::reduce_degree(Scalar tolerance) const {
+        if(tolerance < 0){
+            throw std::invalid_argument("Tolerance must be non-negative.");
+        }
+        // the reduced curves are at most as large as the original ones, attempts are written in place
+        auto control_points = this->control_points();
+        Matrix points(_dimension, control_points.cols());
+        vector<unsigned int> degrees = this->degrees();
+        long offset = 0;
+        for(unsigned int i = 0; i < degrees.size(); i++){
+            auto original = segment(i).control_points();
+            unsigned int degree = 1;
+            while(degree < degrees[i] and
+                  reduce_control_points(original, points.middleCols(offset, degree + 1)) > tolerance){
+                degree++;
+            }
+            if(degree >= degrees[i]){
+                points.middleCols(offset, degrees[i] + 1) = original;
+                degree = degrees[i];
+            }
+            degrees[i] = degree;
+            offset += degree;
+        }
+        points.conservativeResize(Eigen::NoChange, offset + 1);
+        return BasicCompositeBezierCurve(std::move(points), degrees, unscaled_knots());
+    }
 
     std::pair<int, double> global_to_local_param(double t, int number_of_curves){
         int curve_index;
@@ -89,4 +1039,7 @@ namespace bezier {
         double curve_fraction = curve_index / (double) number_of_curves;
         return std::make_pair(curve_index, (t - curve_fraction) * number_of_curves);
     }
-}
\ No newline at end of file
+
+    template class BasicCompositeBezierCurve<double>;
+    template class BasicCompositeBezierCurve<float>;
+}
@@ -1,17 +1,119 @@
 #include <bezier/curve.h>
 
+#include <bezier/bezier_curve.h>
+#include <bezier/composite_bezier_curve.h>
+#include <bezier/math/forward_difference.h>
+
 namespace bezier {
 
-    std::vector<Eigen::VectorXd> sample(const Curve * curve, int n){
+    template <typename Scalar>
+    void BasicCurve<Scalar>::evaluate_into(Scalar t, Eigen::Ref<Vector> out) const {
+        if(out.rows() != dimension()){
+            throw std::invalid_argument("Output must have the same dimension as the curve.");
+        }
+        out = operator()(t);
+    }
+
+    template <typename Scalar>
+    void BasicCurve<Scalar>::evaluate_into(const Eigen::Ref<const Vector> &ts, Eigen::Ref<Matrix> out) const {
+        if(out.rows() != dimension() or out.cols() != ts.rows()){
+            throw std::invalid_argument("Output must have one row per dimension and one column per parameter.");
+        }
+        for(long j = 0; j < ts.rows(); j++){
+            evaluate_into(ts(j), out.col(j));
+        }
+    }
 
-        Eigen::VectorXd params = Eigen::VectorXd::LinSpaced(n, 0, 1);
-        std::vector<Eigen::VectorXd> samples;
+    template <typename Scalar>
+    std::vector<typename BasicCurve<Scalar>::Vector> sample(const BasicCurve<Scalar> * curve, int n){
 
-        for(int i = 0; i < params.rows(); i++){
-            samples.push_back(curve->operator()(params(i)));
+        typename BasicCurve<Scalar>::Matrix sample_matrix(curve->dimension(), n);
+        sample<Scalar>(curve, sample_matrix);
+
+        std::vector<typename BasicCurve<Scalar>::Vector> samples;
+        for(int i = 0; i < n; i++){
+            samples.push_back(sample_matrix.col(i));
         }
 
         return samples;
     }
 
+    /**
+     * Sample a Bezier curve at t0 + j * h for the columns j of the output. Curves which are not
+     * evaluated in the power basis are sampled point by point to keep their accuracy.
+     */
+    template <typename Scalar>
+    void _sample_bezier(const BasicBezierCurve<Scalar> & bezier, double t0, double h,
+                        Eigen::Ref<typename BasicCurve<Scalar>::Matrix> samples){
+        if(bezier.evaluation_method() == EvaluationMethod::Horner){
+            forward_difference(bezier.power_coefficients(), static_cast<Scalar>(t0), static_cast<Scalar>(h), samples);
+        }
+        else{
+            for(long j = 0; j < samples.cols(); j++){
+                samples.col(j) = bezier(static_cast<Scalar>(std::min(t0 + j * h, 1.0)));
+            }
+        }
+    }
+
+    template <typename Scalar>
+    void _sample_composite_bezier(const BasicCompositeBezierCurve<Scalar> & composite,
+                                  Eigen::Ref<typename BasicCurve<Scalar>::Matrix> samples){
+        long n = samples.cols();
+        double h = 1.0 / (n - 1);
+
+        // the samples that fall in the same curve are uniform in the local parameter as well
+        long first = 0;
+        while(first < n){
+            std::pair<int, double> local_param = composite.local_param(first * h);
+            long last = first + 1;
+            while(last < n and composite.local_param(last * h).first == local_param.first){
+                last++;
+            }
+            forward_difference(composite.power_coefficients(local_param.first),
+                               static_cast<Scalar>(local_param.second),
+                               static_cast<Scalar>(composite.local_param_scale(local_param.first) * h),
+                               samples.middleCols(first, last - first));
+            first = last;
+        }
+        samples.col(n - 1) = composite(1);
+    }
+
+    template <typename Scalar>
+    void sample(const BasicCurve<Scalar> * curve, Eigen::Ref<typename BasicCurve<Scalar>::Matrix> samples){
+        if(samples.rows() != curve->dimension()){
+            throw std::invalid_argument("Samples must have the same dimension as the curve.");
+        }
+        if(samples.cols() < 2){
+            if(samples.cols() == 1){
+                samples.col(0) = curve->operator()(1);
+            }
+            return;
+        }
+
+        auto bezier = dynamic_cast<const BasicBezierCurve<Scalar>*>(curve);
+        if(bezier != nullptr){
+            _sample_bezier<Scalar>(*bezier, 0, 1.0 / (samples.cols() - 1), samples);
+            samples.col(samples.cols() - 1) = bezier->operator()(1);
+            return;
+        }
+
+        auto composite_bezier = dynamic_cast<const BasicCompositeBezierCurve<Scalar>*>(curve);
+        if(composite_bezier != nullptr){
+            _sample_composite_bezier<Scalar>(*composite_bezier, samples);
+            return;
+        }
+
+        typename BasicCurve<Scalar>::Vector params = BasicCurve<Scalar>::Vector::LinSpaced(samples.cols(), 0, 1);
+        for(int i = 0; i < params.rows(); i++){
+            samples.col(i) = curve->operator()(params(i));
+        }
+    }
+
+    template class BasicCurve<double>;
+    template class BasicCurve<float>;
+
+    template std::vector<Eigen::VectorXd> sample<double>(const Curve * curve, int n);
+    template std::vector<Eigen::VectorXf> sample<float>(const Curvef * curve, int n);
+    template void sample<double>(const Curve * curve, Eigen::Ref<Eigen::MatrixXd> samples);
+    template void sample<float>(const Curvef * curve, Eigen::Ref<Eigen::MatrixXf> samples);
 }
@@ -1,9 +1,17 @@
 #include "bezier/fit_composite_bezier_curve.h"
 
+#include <bezier/math/horner.h>
+#include <bezier/math/power_sums.h>
+#include <bezier/math/roots.h>
 #include <bezier/math/tridiagonal.h>
+#include <bezier/parallel.h>
 #include <bezier/utilities.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <memory>
 
 namespace bezier {
 
@@ -12,35 +20,38 @@ namespace bezier {
     using Eigen::VectorXd;
 
 
-    vector<double> chordlength_parameterization(const vector<VectorXd> &data_points,
-                                                const VectorXd &start_point){
+    template <typename Scalar>
+    vector<double> chordlength_parameterization(const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> &data_points,
+                                                const typename BasicCurve<Scalar>::Vector &start_point){
         // get total length
         double total_length = 0;
         if(start_point.rows() != 0){
-            total_length += (data_points[0]-start_point).norm();
+            total_length += (data_points[0]-start_point).template cast<double>().norm();
         }
 
         for(int i = 1; i < data_points.size(); i++){
-            total_length += (data_points[i] - data_points[i-1]).norm();
+            total_length += (data_points[i] - data_points[i-1]).template cast<double>().norm();
         }
 
         // find parameterization
         vector<double> parameterization;
         double length = 0;
         if(start_point.rows() != 0) {
-            length += (data_points[0] - start_point).norm();
+            length += (data_points[0] - start_point).template cast<double>().norm();
         }
 
         parameterization.push_back(length / total_length);
         for(int i = 1; i < data_points.size(); i++){
-            length += (data_points[i] - data_points[i-1]).norm();
+            length += (data_points[i] - data_points[i-1]).template cast<double>().norm();
             parameterization.push_back(length / total_length);
         }
 
         return parameterization;
     }
 
-    vector<vector<double>> initialize_parameterization(const vector<vector<VectorXd>> & data_points, bool closed_curve){
+    template <typename Scalar>
+    vector<vector<double>> initialize_parameterization(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                                       bool closed_curve){
 
         for(const auto & data : data_points){
             if(data.empty()){
@@ -51,49 +62,77 @@ namespace bezier {
         vector<vector<double>> parameterization;
         for(int i = 0; i < data_points.size(); i++){
             if(i != 0){
-                parameterization.push_back(chordlength_parameterization(data_points[i],
+                parameterization.push_back(chordlength_parameterization<Scalar>(data_points[i],
                                                                         *(data_points[i - 1].end() - 1)));
             }
             else{
                 if(closed_curve){
                     parameterization.push_back(
-                            chordlength_parameterization(data_points[i],
+                            chordlength_parameterization<Scalar>(data_points[i],
                                                          *(data_points[data_points.size() - 1].end() - 1)));
                 }
                 else{
-                    parameterization.push_back(chordlength_parameterization(data_points[i]));
+                    parameterization.push_back(chordlength_parameterization<Scalar>(data_points[i]));
                 }
             }
         }
         return parameterization;
     }
 
+    template <typename Scalar>
+    vector<double> chordlength_knots(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                     bool closed_curve){
+        vector<double> knots(1, 0);
+        for(int i = 0; i < data_points.size(); i++){
+            double length = 0;
+            if(i != 0 or closed_curve){
+                const auto & previous = i != 0 ? data_points[i - 1] : data_points[data_points.size() - 1];
+                length += (data_points[i][0] - previous.back()).template cast<double>().norm();
+            }
+            for(int j = 1; j < data_points[i].size(); j++){
+                length += (data_points[i][j] - data_points[i][j-1]).template cast<double>().norm();
+            }
+            knots.push_back(knots.back() + length);
+        }
+        return knots;
+    }
+
 
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<VectorXd> & data_points,
-                                                    const vector<int> & joints,
-                                                    int curve_degrees,
-                                                    bool closed_curve){
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            const vector<int> & joints,
+            int curve_degrees,
+            bool closed_curve,
+            Knots knots){
         vector<int> curve_degrees_vec(joints.size()+1, curve_degrees);
-        return fit_composite_bezier_curve(data_points, joints, curve_degrees_vec, closed_curve);
+        return fit_composite_bezier_curve(data_points, joints, curve_degrees_vec, closed_curve, knots);
     }
 
 
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<VectorXd> & data_points,
-                                                    const vector<int> & joints,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve){
-        return fit_composite_bezier_curve(partition_data<VectorXd>(data_points, joints),
-                                          curve_degrees, closed_curve);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            const vector<int> & joints,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots){
+        return fit_composite_bezier_curve(partition_data<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>(data_points, joints),
+                                          curve_degrees, closed_curve, knots);
     }
 
 
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<vector<VectorXd>> & data_points,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve){
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots){
         return fit_composite_bezier_curve(data_points,
                                           initialize_parameterization(data_points, closed_curve),
                                           curve_degrees,
-                                          closed_curve);
+                                          closed_curve,
+                                          knots);
     }
 
 
@@ -109,16 +148,9 @@ namespace bezier {
         return T;
     }
 
-    MatrixXd data_matrix(const vector<VectorXd> & data_points){
-        MatrixXd data(data_points.size(), data_points[0].rows());
-        for(int i = 0; i < data_points.size(); i++){
-            data.block(i, 0, 1, data_points[i].rows()) = data_points[i].transpose();
-        }
-        return data;
-    }
-
 
-    void _argument_check_fit_composite_bezier_curve(const vector<vector<VectorXd>> & data_points,
+    template <typename Scalar>
+    void _argument_check_fit_composite_bezier_curve(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
                                                    const vector<vector<double>> & parameterization,
                                                    const vector<int> & curve_degrees,
                                                    bool closed_curve) {
@@ -175,184 +207,753 @@ namespace bezier {
         }
     }
 
-    CompositeBezierCurve fit_composite_bezier_curve(const vector<vector<VectorXd>> & data_points,
-                                                    const vector<vector<double>> & parameterization,
-                                                    const vector<int> & curve_degrees,
-                                                    bool closed_curve){
+    /**
+     * Least squares system of a composite Bezier curve fit.
+     * The data matrices and the matrices which enforce continuity at the joints only depend on the
+     * data points and the degrees, they are set up once and reused when the system is solved for
+     * several parameterizations. The matrices keep their storage when the fit is set up again for
+     * data of the same shape.
+     */
+    template <typename Scalar>
+    class _CompositeFit {
+    public:
+        typedef typename BasicCurve<Scalar>::Matrix Matrix;
+
+        _CompositeFit() : _closed_curve(false), _dimension(0) {}
+
+        _CompositeFit(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                      const vector<int> & curve_degrees, bool closed_curve) {
+            setup(data_points, curve_degrees, closed_curve);
+        }
 
-        // check valid arguments
-        _argument_check_fit_composite_bezier_curve(data_points, parameterization, curve_degrees, closed_curve);
+        void setup(const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                   const vector<int> & curve_degrees, bool closed_curve) {
+            _curve_degrees = curve_degrees;
+            _closed_curve = closed_curve;
+            _dimension = data_points[0][0].rows();
+            unsigned long number_of_curves = curve_degrees.size();
+
+            // set up data matrices, one column per data point
+
+            _data_matrices.resize(number_of_curves);
+            for (int i = 0; i < number_of_curves; i++){
+                const auto & d = data_points[i];
+                _data_matrices[i].resize(_dimension, d.size());
+                for(int j = 0; j < d.size(); j++){
+                    _data_matrices[i].col(j) = d[j].template cast<double>();
+                }
+            }
 
+            // set up Q and R matrices
 
-        unsigned long number_of_curves = curve_degrees.size();
+            Eigen::Matrix2d q;
+            q << 0, 1, -1, 2;
 
-        // set up data matrices
+            _q_matrices.resize(number_of_curves);
+            _r_matrices.resize(number_of_curves);
+            _continuity_matrices.resize(closed_curve ? number_of_curves : number_of_curves - 1);
+            for(int i = 0; i < number_of_curves; i++){
+                const MatrixXd & coefficient_matrix = cached_bezier_coefficients(curve_degrees[i]);
 
-        vector<MatrixXd> data_matrices;
-        for (const auto & d : data_points){
-            data_matrices.push_back(data_matrix(d));
+                if(i == 0 and !closed_curve){
+                    _q_matrices[i] = coefficient_matrix;
+                    _r_matrices[i] = coefficient_matrix;
+                }
+                else{
+                    MatrixXd & continuity_matrix = _continuity_matrices[closed_curve ? i : i - 1];
+                    if(i == 0){ // if first curve in closed composite curve
+                        continuity_matrix = MatrixXd::Zero(2, curve_degrees[number_of_curves-1] - 1);
+                    }
+                    else if(i == 1 and !closed_curve){
+                        continuity_matrix = MatrixXd::Zero(2, curve_degrees[i-1] + 1); // want to fit all points in first curve
+                    }
+                    else{
+                        continuity_matrix = MatrixXd::Zero(2, curve_degrees[i-1] - 1);  // want # of cols to be the same as
+                                                                                        // # parameters in previous curve
+                    }
+                    continuity_matrix.block(0, continuity_matrix.cols()-2, 2, 2) = q;
+
+                    _q_matrices[i] = coefficient_matrix.block(0, 0, coefficient_matrix.rows(), 2) * continuity_matrix;
+                    _r_matrices[i] = coefficient_matrix.block(0, 2, coefficient_matrix.rows(), coefficient_matrix.cols() - 2);
+                }
+            }
         }
 
-        // set up parameterization matrices containing (1 t t^2 t^3 ... t^n)
+        /**
+         * Solve the least squares system for a parameterization
+         * @param parameterization : parameterization of the data points of each curve
+         * @return control points in the contiguous storage of a composite Bezier curve
+         */
+        Matrix solve(const vector<vector<double>> & parameterization) {
+            const vector<int> & curve_degrees = _curve_degrees;
+            const vector<MatrixXd> & data_matrices = _data_matrices;
+            const vector<MatrixXd> & q_matrices = _q_matrices;
+            const vector<MatrixXd> & r_matrices = _r_matrices;
+            const vector<MatrixXd> & continuity_matrices = _continuity_matrices;
+            const vector<MatrixXd> & normal_matrices = _normal_matrices;
+            const vector<MatrixXd> & weighted_sums = _weighted_sums;
+            bool closed_curve = _closed_curve;
+            unsigned long number_of_curves = curve_degrees.size();
+
+            // accumulate T^T T and T^T D of the parameterization matrices T with rows (1 t t^2 t^3 ... t^n)
+            // from the power sums of t and of the data points weighted by them, without forming T
+
+            _power_sums.resize(2 * *std::max_element(curve_degrees.begin(), curve_degrees.end()) + 1);
+            _normal_matrices.resize(number_of_curves);
+            _weighted_sums.resize(number_of_curves);
+            for (int j = 0; j < number_of_curves; ++j) {
+                int degree = curve_degrees[j];
+                Eigen::Ref<VectorXd> power_sums = _power_sums.head(2 * degree + 1);
+                power_sums.setZero();
+                _weighted_sums[j].setZero(_dimension, degree + 1);
+                accumulate_power_sums(Eigen::Map<const VectorXd>(parameterization[j].data(), parameterization[j].size()),
+                                      data_matrices[j], power_sums, _weighted_sums[j]);
+                _normal_matrices[j].resize(degree + 1, degree + 1);
+                hankel_normal_matrix(power_sums, 1, _normal_matrices[j]);
+            }
 
-        vector<MatrixXd> t_matrices;
-        vector<MatrixXd> t_product_matrices;
-        for (int j = 0; j < number_of_curves; ++j) {
-            MatrixXd t = parameterization_matrix(parameterization[j], curve_degrees[j]);
-            t_matrices.push_back(t);
-            t_product_matrices.push_back(t.transpose() * t);
+            vector<MatrixXd> lower_diagonal, diagonal, upper_diagonal, rhs;
 
-        }
-
-        // set up Q and R matrices
+            // diagonal elements
+            MatrixXd diag;
+            for(int i = 0; i < number_of_curves - 1; i++){
+                diag = r_matrices[i].transpose() * normal_matrices[i] * r_matrices[i] +
+                        q_matrices[i+1].transpose() * normal_matrices[i+1] * q_matrices[i+1];
+                diagonal.push_back(diag);
+            }
+            diag = r_matrices[number_of_curves-1].transpose()
+                   * normal_matrices[number_of_curves-1] * r_matrices[number_of_curves-1];
+            if(closed_curve) {
+                diag += q_matrices[0].transpose() * normal_matrices[0] * q_matrices[0];
+            }
+            diagonal.push_back(diag);
 
-        vector<MatrixXd> q_matrices;
-        vector<MatrixXd> continuity_matrices;
-        vector<MatrixXd> r_matrices;
 
-        Eigen::Matrix2d q;
-        q << 0, 1, -1, 2;
 
-        for(int i = 0; i < number_of_curves; i++){
-            MatrixXd coefficient_matrix = bezier_coefficients(curve_degrees[i]);
-            MatrixXd continuity_matrix;
+            // lower diagonal elements
+            if(closed_curve){
+                if(number_of_curves == 1){
+                    diagonal[0] += r_matrices[0].transpose() * normal_matrices[0] * q_matrices[0];
+                }
+                else {
+                    lower_diagonal.push_back(r_matrices[0].transpose() * normal_matrices[0] * q_matrices[0]);
+                }
+            }
+            for(int i = 0; i < number_of_curves - 1; i++){
+                lower_diagonal.push_back(r_matrices[i+1].transpose() * normal_matrices[i+1] * q_matrices[i+1]);
+            }
 
-            if(i == 0 and !closed_curve){
-                q_matrices.push_back(coefficient_matrix);
-                r_matrices.push_back(coefficient_matrix);
+            // upper diagonal elements
+            for(int i = 0; i < number_of_curves - 1; i++){
+                upper_diagonal.push_back(q_matrices[i+1].transpose() * normal_matrices[i+1] * r_matrices[i+1]);
             }
-            else{
-                if(i == 0){ // if first curve in closed composite curve
-                    continuity_matrix = MatrixXd::Zero(2, curve_degrees[number_of_curves-1] - 1);
-                }
-                else if(i == 1 and !closed_curve){
-                    continuity_matrix = MatrixXd::Zero(2, curve_degrees[i-1] + 1); // want to fit all points in first curve
+            if(closed_curve){
+                if(number_of_curves == 1){
+                    diagonal[0] += q_matrices[0].transpose() * normal_matrices[0] * r_matrices[0];
                 }
                 else{
-                    continuity_matrix = MatrixXd::Zero(2, curve_degrees[i-1] - 1);  // want # of cols to be the same as
-                                                                                    // # parameters in previous curve
+                    upper_diagonal.push_back(q_matrices[0].transpose() * normal_matrices[0] * r_matrices[0]);
                 }
-                continuity_matrix.block(0, continuity_matrix.cols()-2, 2, 2) = q;
+            }
+
 
-                q_matrices.push_back(coefficient_matrix.block(0, 0, coefficient_matrix.rows(), 2) * continuity_matrix);
-                r_matrices.push_back(coefficient_matrix.block(0, 2, coefficient_matrix.rows(), coefficient_matrix.cols() - 2));
+            // if closed and # of curves == 2 make modifications to matrix system
+            if(closed_curve and number_of_curves == 2){
+                lower_diagonal[1] += upper_diagonal[1];
+                upper_diagonal[0] += lower_diagonal[0];
 
-                continuity_matrices.push_back(continuity_matrix);
+                lower_diagonal.erase(lower_diagonal.begin());
+                upper_diagonal.erase(upper_diagonal.end()-1);
             }
-        }
 
-        vector<MatrixXd> lower_diagonal, diagonal, upper_diagonal, rhs;
 
-        // diagonal elements
-        MatrixXd diag;
-        for(int i = 0; i < number_of_curves - 1; i++){
-            diag = r_matrices[i].transpose() * t_product_matrices[i] * r_matrices[i] +
-                    q_matrices[i+1].transpose() * t_product_matrices[i+1] * q_matrices[i+1];
-            diagonal.push_back(diag);
-        }
-        diag = r_matrices[number_of_curves-1].transpose()
-               * t_product_matrices[number_of_curves-1] * r_matrices[number_of_curves-1];
-        if(closed_curve) {
-            diag += q_matrices[0].transpose() * t_product_matrices[0] * q_matrices[0];
-        }
-        diagonal.push_back(diag);
+            // rhs elements
+            MatrixXd r;
+            for (int i = 0; i < number_of_curves - 1; ++i) {
+                r = r_matrices[i].transpose() * weighted_sums[i].transpose() +
+                    q_matrices[i+1].transpose() * weighted_sums[i+1].transpose();
+                rhs.push_back(r);
+            }
+            r = r_matrices[number_of_curves-1].transpose() * weighted_sums[number_of_curves-1].transpose();
+            if(closed_curve){
+                r += q_matrices[0].transpose() * weighted_sums[0].transpose();
+            }
+            rhs.push_back(r);
 
 
+            // solve the tridiagonal system
+            vector<MatrixXd> solution;
+            if(!closed_curve){
+                solution = solve_tridiagonal(lower_diagonal, diagonal, upper_diagonal, rhs);
+            }
+            else{
+                solution = solve_off_tridiagonal(lower_diagonal, diagonal, upper_diagonal, rhs);
+            }
 
-        // lower diagonal elements
-        if(closed_curve){
-            if(number_of_curves == 1){
-                diagonal[0] += r_matrices[0].transpose() * t_product_matrices[0] * q_matrices[0];
+
+            // extract the control points from the solution directly into the contiguous storage of the
+            // composite curve, the first control point of each curve is the joint with the previous one
+            long number_of_control_points = 1;
+            for(int degree : curve_degrees){
+                number_of_control_points += degree;
             }
-            else {
-                lower_diagonal.push_back(r_matrices[0].transpose() * t_product_matrices[0] * q_matrices[0]);
+            Matrix control_points(_dimension, number_of_control_points);
+            long offset = 0;
+            for(int i = 0; i < solution.size(); i++){
+                long column = offset;
+
+                // if closed curve we need to link last and first solution
+                if(i == 0 and closed_curve){
+                    MatrixXd first_control_points = continuity_matrices[0] * solution[solution.size()-1];
+                    control_points.middleCols(column, first_control_points.rows()) =
+                            first_control_points.transpose().template cast<Scalar>();
+                    column += first_control_points.rows();
+                }
+                else if(i != 0){
+                    // if closed curve we have an additional continuity matrix
+                    const MatrixXd & continuity_matrix = !closed_curve ? continuity_matrices[i-1] : continuity_matrices[i];
+                    MatrixXd first_control_points = continuity_matrix * solution[i-1];
+                    control_points.middleCols(column, first_control_points.rows()) =
+                            first_control_points.transpose().template cast<Scalar>();
+                    column += first_control_points.rows();
+                }
+                control_points.middleCols(column, solution[i].rows()) = solution[i].transpose().template cast<Scalar>();
+                offset += curve_degrees[i];
             }
+            return control_points;
         }
-        for(int i = 0; i < number_of_curves - 1; i++){
-            lower_diagonal.push_back(r_matrices[i+1].transpose() * t_product_matrices[i+1] * q_matrices[i+1]);
+
+    private:
+        vector<int> _curve_degrees;
+        bool _closed_curve;
+        long _dimension;
+        vector<MatrixXd> _data_matrices;
+        vector<MatrixXd> _q_matrices;
+        vector<MatrixXd> _r_matrices;
+        vector<MatrixXd> _continuity_matrices;
+        VectorXd _power_sums; // sum t^k for k = 0, ..., 2n of the current curve
+        vector<MatrixXd> _normal_matrices; // T^T T
+        vector<MatrixXd> _weighted_sums; // (T^T D)^T
+    };
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> _fitted_curve(typename BasicCurve<Scalar>::Matrix && control_points,
+                                                    const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                                    const vector<int> & curve_degrees,
+                                                    bool closed_curve,
+                                                    Knots knots){
+        vector<unsigned int> degrees(curve_degrees.begin(), curve_degrees.end());
+        if(knots == Knots::ChordLength){
+            return BasicCompositeBezierCurve<Scalar>(std::move(control_points), degrees,
+                                                     chordlength_knots(data_points, closed_curve));
         }
+        return BasicCompositeBezierCurve<Scalar>(std::move(control_points), degrees);
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<vector<double>> & parameterization,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots){
 
-        // upper diagonal elements
-        for(int i = 0; i < number_of_curves - 1; i++){
-            upper_diagonal.push_back(q_matrices[i+1].transpose() * t_product_matrices[i+1] * r_matrices[i+1]);
+        // check valid arguments
+        _argument_check_fit_composite_bezier_curve(data_points, parameterization, curve_degrees, closed_curve);
+
+        _CompositeFit<Scalar> fit(data_points, curve_degrees, closed_curve);
+        return _fitted_curve<Scalar>(fit.solve(parameterization), data_points, curve_degrees, closed_curve, knots);
+    }
+
+    /**
+     * Move each parameter to the closest point of its Bezier curve with one Newton step on
+     * f(t) = (B(t) - p) . B'(t), f'(t) = |B'(t)|^2 + (B(t) - p) . B''(t)
+     * The step is halved until the distance does not increase. Parameters of curves with a
+     * preceding curve are kept positive and parameters of curves followed by a curve with a zero
+     * parameter are kept below one, such that the parameterization stays unambiguous.
+     * @return largest change of a parameter
+     */
+    template <typename Scalar>
+    double _correct_parameterization(const BasicCompositeBezierCurve<Scalar> & curve,
+                                     const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                     vector<vector<double>> & parameterization, bool closed_curve,
+                                     unsigned int number_of_threads){
+        long number_of_curves = static_cast<long>(parameterization.size());
+        vector<MatrixXd> power_coefficients;
+        vector<long> first_point(1, 0);
+        vector<bool> positive, below_one;
+        for(long i = 0; i < number_of_curves; i++){
+            power_coefficients.push_back(curve.power_coefficients(i).template cast<double>());
+            first_point.push_back(first_point.back() + static_cast<long>(parameterization[i].size()));
+            positive.push_back(i > 0 or closed_curve);
+            long next = i + 1 < number_of_curves ? i + 1 : (closed_curve ? 0 : -1);
+            below_one.push_back(next >= 0 and std::find(parameterization[next].begin(),
+                                                        parameterization[next].end(), 0.0) != parameterization[next].end());
         }
-        if(closed_curve){
-            if(number_of_curves == 1){
-                diagonal[0] += q_matrices[0].transpose() * t_product_matrices[0] * r_matrices[0];
+
+        vector<double> changes(first_point.back(), 0);
+        parallel_for(first_point.back(), number_of_threads, [&](long begin, long end){
+            long dimension = power_coefficients[0].rows();
+            VectorXd point(dimension), value(dimension), first(dimension), second(dimension);
+            for(long k = begin; k < end; k++){
+                long i = std::upper_bound(first_point.begin(), first_point.end(), k) - first_point.begin() - 1;
+                long j = k - first_point[i];
+                double & t = parameterization[i][j];
+                if(t == 0 and positive[i]){
+                    continue;
+                }
+                const MatrixXd & a = power_coefficients[i];
+                point = data_points[i][j].template cast<double>();
+                horner(a, t, value);
+                horner(a, t, first, 1);
+                horner(a, t, second, 2);
+                value -= point;
+                double derivative = first.squaredNorm() + value.dot(second);
+                if(!(derivative > 0)){
+                    continue;
+                }
+                double distance = value.squaredNorm();
+                double step = value.dot(first) / derivative;
+                for(int halvings = 0; halvings < 8; halvings++, step /= 2){
+                    double next = std::min(std::max(t - step, 0.0), 1.0);
+                    if(next == 0 and positive[i]){
+                        next = t / 2;
+                    }
+                    if(next == 1 and below_one[i]){
+                        next = (t + 1) / 2;
+                    }
+                    horner(a, next, value);
+                    if((value - point).squaredNorm() <= distance){
+                        changes[k] = std::abs(next - t);
+                        t = next;
+                        break;
+                    }
+                }
             }
-            else{
-                upper_diagonal.push_back(q_matrices[0].transpose() * t_product_matrices[0] * r_matrices[0]);
+        }, 256);
+        return changes.empty() ? 0 : *std::max_element(changes.begin(), changes.end());
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> _corrected_fit(_CompositeFit<Scalar> & fit,
+                                                     const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+                                                     vector<vector<double>> & parameterization,
+                                                     const vector<int> & curve_degrees,
+                                                     bool closed_curve,
+                                                     Knots knots,
+                                                     const ParameterCorrection & correction){
+        fit.setup(data_points, curve_degrees, closed_curve);
+        BasicCompositeBezierCurve<Scalar> curve = _fitted_curve<Scalar>(fit.solve(parameterization), data_points,
+                                                                        curve_degrees, closed_curve, knots);
+        for(unsigned int iteration = 0; iteration < correction.max_iterations; iteration++){
+            double change = _correct_parameterization(curve, data_points, parameterization, closed_curve,
+                                                      correction.number_of_threads);
+            if(change == 0){
+                break;
+            }
+            curve = _fitted_curve<Scalar>(fit.solve(parameterization), data_points, curve_degrees, closed_curve, knots);
+            if(change <= correction.tolerance){
+                break;
             }
         }
+        return curve;
+    }
 
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            vector<vector<double>> & parameterization,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots,
+            const ParameterCorrection & correction){
 
-        // if closed and # of curves == 2 make modifications to matrix system
-        if(closed_curve and number_of_curves == 2){
-            lower_diagonal[1] += upper_diagonal[1];
-            upper_diagonal[0] += lower_diagonal[0];
+        _argument_check_fit_composite_bezier_curve(data_points, parameterization, curve_degrees, closed_curve);
 
-            lower_diagonal.erase(lower_diagonal.begin());
-            upper_diagonal.erase(upper_diagonal.end()-1);
-        }
+        _CompositeFit<Scalar> fit;
+        return _corrected_fit(fit, data_points, parameterization, curve_degrees, closed_curve, knots, correction);
+    }
 
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> fit_composite_bezier_curve(
+            const vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> & data_points,
+            const vector<int> & curve_degrees,
+            bool closed_curve,
+            Knots knots,
+            const ParameterCorrection & correction){
+        vector<vector<double>> parameterization = initialize_parameterization(data_points, closed_curve);
+        return fit_composite_bezier_curve(data_points, parameterization, curve_degrees, closed_curve, knots, correction);
+    }
 
-        // rhs elements
-        MatrixXd r;
-        for (int i = 0; i < number_of_curves - 1; ++i) {
-            r = r_matrices[i].transpose() * t_matrices[i].transpose() * data_matrices[i] +
-                q_matrices[i+1].transpose() * t_matrices[i+1].transpose() * data_matrices[i+1];
-            rhs.push_back(r);
+    /**
+     * Buffers of one worker in a batch fit, kept between the datasets of the worker.
+     */
+    template <typename Scalar>
+    struct _FitScratch {
+        vector<vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>>> data_points;
+        vector<vector<double>> parameterization;
+        vector<int> curve_degrees;
+        _CompositeFit<Scalar> fit;
+    };
+
+    /**
+     * Fit a composite Bezier curve to data points split at joints, with the degrees in scratch.curve_degrees.
+     * The partitioned data points and their final parameterization are left in the scratch buffers.
+     */
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> _fit_joints(const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & points,
+                                                  const vector<int> & joints, bool closed_curve, Knots knots,
+                                                  const ParameterCorrection & correction, _FitScratch<Scalar> & scratch){
+        if(points.empty()){
+            throw std::invalid_argument("Cannot fit a composite Bezier curve to no data points.");
         }
-        r = r_matrices[number_of_curves-1].transpose() * t_matrices[number_of_curves-1].transpose()
-            * data_matrices[number_of_curves-1];
-        if(closed_curve){
-            r += q_matrices[0].transpose() * t_matrices[0].transpose() * data_matrices[0];
+        for(int i = 0; i < joints.size(); i++){
+            if(joints[i] < 0 or joints[i] + 1 >= points.size() or (i > 0 and joints[i] <= joints[i - 1])){
+                throw std::invalid_argument("Joints must be increasing indices of inner data points.");
+            }
         }
-        rhs.push_back(r);
 
+        // partition as partition_data does, into the buffers of the previous fit
+        scratch.data_points.resize(joints.size() + 1);
+        for(int i = 0; i < joints.size() + 1; i++){
+            long first = i == 0 ? 0 : joints[i - 1] + 1;
+            long last = i < joints.size() ? joints[i] + 1 : static_cast<long>(points.size());
+            scratch.data_points[i].resize(last - first);
+            for(long j = first; j < last; j++){
+                scratch.data_points[i][j - first] = points[j];
+            }
+        }
+
+        scratch.parameterization = initialize_parameterization(scratch.data_points, closed_curve);
+        _argument_check_fit_composite_bezier_curve(scratch.data_points, scratch.parameterization, scratch.curve_degrees,
+                                                   closed_curve);
+        return _corrected_fit(scratch.fit, scratch.data_points, scratch.parameterization, scratch.curve_degrees,
+                              closed_curve, knots, correction);
+    }
 
-        // solve the tridiagonal system
-        vector<MatrixXd> solution;
-        if(!closed_curve){
-            solution = solve_tridiagonal(lower_diagonal, diagonal, upper_diagonal, rhs);
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> _fit_dataset(const BasicFitDataset<Scalar> & dataset, const FitOptions & options,
+                                                   _FitScratch<Scalar> & scratch){
+        const vector<int> & joints = dataset.joints;
+        if(dataset.curve_degrees.size() == 1){
+            scratch.curve_degrees.assign(joints.size() + 1, dataset.curve_degrees[0]);
+        }
+        else if(dataset.curve_degrees.size() == joints.size() + 1){
+            scratch.curve_degrees = dataset.curve_degrees;
         }
         else{
-            solution = solve_off_tridiagonal(lower_diagonal, diagonal, upper_diagonal, rhs);
+            throw std::invalid_argument("Either one degree or one degree per curve must be given.");
         }
 
+        ParameterCorrection correction = options.correction;
+        correction.number_of_threads = 1;
+        return _fit_joints(dataset.data_points, joints, dataset.closed_curve, options.knots, correction, scratch);
+    }
 
-        // extract the control points from the solution
-        vector<BezierCurve> bezier_curves;
-        vector<VectorXd> control_points;
-        VectorXd control_point;
-        for(int i = 0; i < solution.size(); i++){
-            control_points.clear();
+    template <typename Scalar>
+    vector<BasicCompositeBezierCurve<Scalar>> fit_composite_bezier_curves(const vector<BasicFitDataset<Scalar>> & batch,
+                                                                          const FitOptions & options){
+        // the largest datasets are fitted first such that the threads run out of work at about the same time
+        vector<long> order(batch.size());
+        for(long k = 0; k < order.size(); k++){
+            order[k] = k;
+        }
+        std::stable_sort(order.begin(), order.end(), [&batch](long a, long b){
+            return batch[a].data_points.size() > batch[b].data_points.size();
+        });
+
+        unsigned int number_of_threads = options.number_of_threads == 0 ? default_number_of_threads()
+                                                                        : options.number_of_threads;
+        vector<_FitScratch<Scalar>> scratch(number_of_threads);
+        vector<std::unique_ptr<BasicCompositeBezierCurve<Scalar>>> results(batch.size());
+        parallel_for_workers(static_cast<long>(batch.size()), number_of_threads,
+                             [&](unsigned int worker, long begin, long end){
+            for(long k = begin; k < end; k++){
+                results[order[k]].reset(new BasicCompositeBezierCurve<Scalar>(
+                        _fit_dataset(batch[order[k]], options, scratch[worker])));
+            }
+        }, 1);
 
-            // if closed curve we need to link last and first solution
-            if(i == 0 and closed_curve){
-                MatrixXd first_control_points = continuity_matrices[0] * solution[solution.size()-1];
-                for(int j = 0; j < first_control_points.rows(); j++){
-                    control_point = first_control_points.block(j, 0, 1, first_control_points.cols()).transpose();
-                    control_points.push_back(control_point);
+        vector<BasicCompositeBezierCurve<Scalar>> curves;
+        curves.reserve(batch.size());
+        for(auto & result : results){
+            curves.push_back(std::move(*result));
+        }
+        return curves;
+    }
+
+    /**
+     * Joints of an adaptive fit together with the fitted curve and its errors.
+     */
+    template <typename Scalar>
+    struct _AdaptiveCandidate {
+        vector<int> joints;
+        vector<SegmentError> errors;
+        double max_error = 0;
+        std::unique_ptr<BasicCompositeBezierCurve<Scalar>> curve;
+    };
+
+    template <typename Scalar>
+    void _evaluate_joints(const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & points, int curve_degree,
+                          bool closed_curve, const FitOptions & options, unsigned int number_of_threads,
+                          _FitScratch<Scalar> & scratch, _AdaptiveCandidate<Scalar> & candidate){
+        const vector<int> & joints = candidate.joints;
+        scratch.curve_degrees.assign(joints.size() + 1, curve_degree);
+        ParameterCorrection correction = options.correction;
+        correction.number_of_threads = number_of_threads;
+        candidate.curve.reset(new BasicCompositeBezierCurve<Scalar>(
+                _fit_joints(points, joints, closed_curve, options.knots, correction, scratch)));
+
+        // distance from each data point to its Bezier curve
+        candidate.errors.resize(joints.size() + 1);
+        candidate.max_error = 0;
+        for(int i = 0; i < static_cast<int>(joints.size()) + 1; i++){
+            SegmentError & error = candidate.errors[i];
+            MatrixXd power_coefficients = candidate.curve->power_coefficients(i).template cast<double>();
+            error.first_point = i == 0 ? 0 : joints[i - 1] + 1;
+            error.number_of_points = static_cast<long>(scratch.data_points[i].size());
+            error.worst_point = error.first_point;
+            error.max_error = 0;
+            double squared_sum = 0;
+            for(long j = 0; j < error.number_of_points; j++){
+                double distance = std::sqrt(closest_point(power_coefficients,
+                                                          scratch.data_points[i][j].template cast<double>()).second);
+                squared_sum += distance * distance;
+                if(distance > error.max_error){
+                    error.max_error = distance;
+                    error.worst_point = error.first_point + j;
                 }
             }
-            else if(i != 0){
-                // if closed curve we have an additional continuity matrix
-                MatrixXd continuity_matrix = !closed_curve ? continuity_matrices[i-1] : continuity_matrices[i];
-                MatrixXd first_control_points = continuity_matrix * solution[i-1];
-                for(int j = 0; j < first_control_points.rows(); j++){
-                    control_point = first_control_points.block(j, 0, 1, first_control_points.cols()).transpose();
-                    control_points.push_back(control_point);
+            error.rms_error = std::sqrt(squared_sum / error.number_of_points);
+            candidate.max_error = std::max(candidate.max_error, error.max_error);
+        }
+    }
+
+    template <typename Scalar>
+    BasicAdaptiveFit<Scalar> fit_composite_bezier_curve_adaptive(
+            const vector<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & data_points,
+            double tolerance,
+            int curve_degree,
+            bool closed_curve,
+            const FitOptions & options){
+        if(!(tolerance >= 0)){
+            throw std::invalid_argument("The tolerance must be non-negative.");
+        }
+        if(curve_degree < 3){
+            throw std::invalid_argument("The Bezier curves must be of degree at least 3.");
+        }
+
+        unsigned int number_of_threads = options.number_of_threads == 0 ? default_number_of_threads()
+                                                                        : options.number_of_threads;
+        vector<_FitScratch<Scalar>> scratch(number_of_threads);
+        _AdaptiveCandidate<Scalar> current;
+        _evaluate_joints(data_points, curve_degree, closed_curve, options, number_of_threads, scratch[0], current);
+
+        // add one joint at a time until all errors are within the tolerance, the candidates are fitted in parallel
+        // and the one with the smallest largest error is kept
+        const int number_of_curves_to_split = 3;
+        vector<_AdaptiveCandidate<Scalar>> candidates;
+        _AdaptiveCandidate<Scalar> best;
+        best.max_error = std::numeric_limits<double>::infinity();
+        long number_of_points = static_cast<long>(data_points.size());
+        unsigned int searched_curves = 1;
+        long number_of_candidates = 0;
+
+        // joints of the next candidate, kept by keep_candidate unless another candidate has the same joints
+        auto next_joints = [&]() -> vector<int> & {
+            if(number_of_candidates == static_cast<long>(candidates.size())){
+                candidates.emplace_back();
+            }
+            candidates[number_of_candidates].joints.clear();
+            return candidates[number_of_candidates].joints;
+        };
+        auto keep_candidate = [&](){
+            for(long k = 0; k < number_of_candidates; k++){
+                if(candidates[k].joints == candidates[number_of_candidates].joints){
+                    return;
+                }
+            }
+            number_of_candidates++;
+        };
+
+        // every curve keeps at least degree + 1 data points, curves with fewer data points are only
+        // determined through the continuity with their neighbours and amplify the errors
+        auto add_candidate = [&](long first, long last, long removed_joints, long added_joints){
+            // joints of the curves before first and after last, and evenly spaced joints in between
+            long curves = removed_joints + added_joints + 1;
+            if(last - first + 1 < curves * (curve_degree + 1)){
+                return;
+            }
+            vector<int> & joints = next_joints();
+            for(int joint : current.joints){
+                if(joint < first){
+                    joints.push_back(joint);
+                }
+            }
+            for(long k = 1; k < curves; k++){
+                joints.push_back(static_cast<int>(first + k * (last - first + 1) / curves - 1));
+            }
+            for(int joint : current.joints){
+                if(joint >= last){
+                    joints.push_back(joint);
+                }
+            }
+            keep_candidate();
+        };
+
+        // split a curve at its worst data point, moved inwards such that both sides keep degree + 1 data points
+        auto add_worst_point_split = [&](const SegmentError & error){
+            long first = error.first_point;
+            long last = error.first_point + error.number_of_points - 1;
+            if(error.number_of_points < 2 * (curve_degree + 1)){
+                return;
+            }
+            long split = std::min(std::max(error.worst_point, first + curve_degree), last - curve_degree - 1);
+            vector<int> & joints = next_joints();
+            for(int joint : current.joints){
+                if(joint < first){
+                    joints.push_back(joint);
+                }
+            }
+            joints.push_back(static_cast<int>(split));
+            for(int joint : current.joints){
+                if(joint >= last){
+                    joints.push_back(joint);
+                }
+            }
+            keep_candidate();
+        };
+
+        // fit the candidates in parallel and return the one with the smallest largest error
+        auto choose_candidate = [&](){
+            parallel_for_workers(number_of_candidates, number_of_threads, [&](unsigned int worker, long begin, long end){
+                for(long k = begin; k < end; k++){
+                    _evaluate_joints(data_points, curve_degree, closed_curve, options, 1, scratch[worker], candidates[k]);
+                }
+            }, 1);
+            long chosen = 0;
+            for(long k = 1; k < number_of_candidates; k++){
+                if(candidates[k].max_error < candidates[chosen].max_error){
+                    chosen = k;
                 }
             }
-            for(int j = 0; j < solution[i].rows(); j++){
-                control_point = solution[i].block(j, 0, 1, solution[i].cols()).transpose();
-                control_points.push_back(control_point);
+            return chosen;
+        };
+
+        while(true){
+            if(current.max_error < best.max_error){
+                best.joints = current.joints;
+                best.errors = current.errors;
+                best.max_error = current.max_error;
+                best.curve.reset(new BasicCompositeBezierCurve<Scalar>(*current.curve));
+            }
+            // more curves do not always give smaller errors since neighbouring curves of very different
+            // lengths fit poorly, give up once there are more than twice as many curves as in the best fit plus eight
+            if(current.max_error <= tolerance or current.joints.size() > best.joints.size() + options.max_extra_curves){
+                break;
+            }
+            number_of_candidates = 0;
+
+            // evenly spaced joints with one more curve
+            add_candidate(0, number_of_points - 1, static_cast<long>(current.joints.size()), 1);
+
+            // split one of the curves with the largest errors at its worst data point or in the middle,
+            // or space it and its neighbours evenly
+            vector<int> order(current.errors.size());
+            for(int i = 0; i < static_cast<int>(order.size()); i++){
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&current](int a, int b){
+                return current.errors[a].max_error > current.errors[b].max_error;
+            });
+            for(int k = 0; k < std::min<int>(number_of_curves_to_split, order.size()); k++){
+                int i = order[k];
+                if(current.errors[i].max_error <= tolerance){
+                    break;
+                }
+                const SegmentError & error = current.errors[i];
+                add_worst_point_split(error);
+                add_candidate(error.first_point, error.first_point + error.number_of_points - 1, 0, 1);
+                int previous = std::max(i - 1, 0);
+                int next = std::min(i + 1, static_cast<int>(current.errors.size()) - 1);
+                const SegmentError & last = current.errors[next];
+                add_candidate(current.errors[previous].first_point, last.first_point + last.number_of_points - 1,
+                              next - previous, 1);
             }
-            bezier_curves.push_back(BezierCurve(control_points));
+            if(number_of_candidates == 0){
+                break; // too few data points to add a curve
+            }
+            std::swap(current, candidates[choose_candidate()]);
+            searched_curves = std::max(searched_curves, static_cast<unsigned int>(current.joints.size() + 1));
         }
 
-        return CompositeBezierCurve(bezier_curves);
+        // remove joints as long as the tolerance is met, the curves around a removed joint are spaced evenly
+        while(best.max_error <= tolerance and !best.joints.empty()){
+            std::swap(current, best);
+            number_of_candidates = 0;
+            for(int i = 0; i < static_cast<int>(current.joints.size()); i++){
+                int previous = std::max(i - 1, 0);
+                int next = std::min(i + 2, static_cast<int>(current.errors.size()) - 1);
+                const SegmentError & last = current.errors[next];
+                add_candidate(current.errors[previous].first_point, last.first_point + last.number_of_points - 1,
+                              next - previous, -1);
+            }
+            long chosen = choose_candidate();
+            if(number_of_candidates == 0 or candidates[chosen].max_error > tolerance){
+                std::swap(current, best);
+                break;
+            }
+            std::swap(best, candidates[chosen]);
+        }
+
+        return BasicAdaptiveFit<Scalar>{std::move(*best.curve), best.joints, best.errors, searched_curves};
     }
-}
 
+    template vector<double> chordlength_parameterization<double>(const vector<VectorXd> &, const VectorXd &);
+    template vector<double> chordlength_parameterization<float>(const vector<Eigen::VectorXf> &, const Eigen::VectorXf &);
+    template vector<double> chordlength_knots<double>(const vector<vector<VectorXd>> &, bool);
+    template vector<double> chordlength_knots<float>(const vector<vector<Eigen::VectorXf>> &, bool);
+    template vector<vector<double>> initialize_parameterization<double>(const vector<vector<VectorXd>> &, bool);
+    template vector<vector<double>> initialize_parameterization<float>(const vector<vector<Eigen::VectorXf>> &, bool);
+
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<vector<VectorXd>> &,
+                                                                     const vector<vector<double>> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<vector<Eigen::VectorXf>> &,
+                                                                     const vector<vector<double>> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<vector<VectorXd>> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<vector<VectorXd>> &,
+                                                                     vector<vector<double>> &,
+                                                                     const vector<int> &, bool, Knots,
+                                                                     const ParameterCorrection &);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<vector<Eigen::VectorXf>> &,
+                                                                     vector<vector<double>> &,
+                                                                     const vector<int> &, bool, Knots,
+                                                                     const ParameterCorrection &);
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<vector<VectorXd>> &,
+                                                                     const vector<int> &, bool, Knots,
+                                                                     const ParameterCorrection &);
+    template vector<CompositeBezierCurve> fit_composite_bezier_curves<double>(const vector<FitDataset> &,
+                                                                              const FitOptions &);
+    template vector<CompositeBezierCurvef> fit_composite_bezier_curves<float>(const vector<FitDatasetf> &,
+                                                                              const FitOptions &);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<vector<Eigen::VectorXf>> &,
+                                                                     const vector<int> &, bool, Knots,
+                                                                     const ParameterCorrection &);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<vector<Eigen::VectorXf>> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<VectorXd> &, const vector<int> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<Eigen::VectorXf> &, const vector<int> &,
+                                                                     const vector<int> &, bool, Knots);
+    template CompositeBezierCurve fit_composite_bezier_curve<double>(const vector<VectorXd> &, const vector<int> &,
+                                                                     int, bool, Knots);
+    template CompositeBezierCurvef fit_composite_bezier_curve<float>(const vector<Eigen::VectorXf> &, const vector<int> &,
+                                                                     int, bool, Knots);
+    template AdaptiveFit fit_composite_bezier_curve_adaptive<double>(const vector<VectorXd> &, double, int, bool,
+                                                                     const FitOptions &);
+    template AdaptiveFitf fit_composite_bezier_curve_adaptive<float>(const vector<Eigen::VectorXf> &, double, int, bool,
+                                                                     const FitOptions &);
+}
@@ -0,0 +1,224 @@
+#include <bezier/math/arc_length.h>
+#include <bezier/math/horner.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bezier {
+
+    // 5 point Gauss-Legendre rule on [-1,1], exact for polynomials up to degree 9
+    static const double _gauss_nodes[5] = {-0.9061798459386640, -0.5384693101056831, 0,
+                                           0.5384693101056831, 0.9061798459386640};
+    static const double _gauss_weights[5] = {0.2369268850561891, 0.4786286704993665, 0.5688888888888889,
+                                             0.4786286704993665, 0.2369268850561891};
+
+    // pieces are not split further than 2^-_max_depth
+    static const int _max_depth = 20;
+
+    // relative tolerance of the length at the parameter found by param_at_arc_length
+    static const double _param_tolerance = 1e-12;
+
+    template <typename Scalar>
+    using _PowerCoefficients = Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>;
+
+    template <typename Scalar>
+    double _speed(const _PowerCoefficients<Scalar> & a, double t, Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & derivative){
+        horner(a, static_cast<Scalar>(t), derivative, 1);
+        return static_cast<double>(derivative.norm());
+    }
+
+    template <typename Scalar>
+    double _gauss_legendre(const _PowerCoefficients<Scalar> & a, double t0, double t1,
+                           Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & derivative){
+        double half_width = (t1 - t0) / 2;
+        double middle = (t0 + t1) / 2;
+        double length = 0;
+        for(int i = 0; i < 5; i++){
+            length += _gauss_weights[i] * _speed(a, middle + half_width * _gauss_nodes[i], derivative);
+        }
+        return half_width * length;
+    }
+
+    // control points of the Bezier curve with power basis coefficients a,
+    // P_j = sum_{k <= j} (j choose k) / (n choose k) A_k
+    template <typename Scalar>
+    Eigen::MatrixXd _control_points(const _PowerCoefficients<Scalar> & a){
+        long n = a.cols() - 1;
+        Eigen::MatrixXd control_points = Eigen::MatrixXd::Zero(a.rows(), a.cols());
+        for(long j = 0; j <= n; j++){
+            double ratio = 1; // (j choose k) / (n choose k)
+            for(long k = 0; k <= j; k++){
+                control_points.col(j) += ratio * a.col(k).template cast<double>();
+                ratio *= static_cast<double>(j - k) / (n - k);
+            }
+        }
+        return control_points;
+    }
+
+    // length of the control polygon, an upper bound of the arc length of the Bezier curve
+    inline double _polygon_length(const Eigen::MatrixXd & control_points){
+        double length = 0;
+        for(long j = 1; j < control_points.cols(); j++){
+            length += (control_points.col(j) - control_points.col(j - 1)).norm();
+        }
+        return length;
+    }
+
+    // pieces[depth] holds the control points of the piece on [t0,t1], deeper entries are overwritten
+    template <typename Scalar>
+    void _append_pieces(const _PowerCoefficients<Scalar> & a, double t0, double t1, double tolerance, int depth,
+                        std::vector<Eigen::MatrixXd> & pieces, ArcLengthTable & table,
+                        Eigen::Matrix<Scalar, Eigen::Dynamic, 1> & derivative){
+        Eigen::MatrixXd & control_points = pieces[depth];
+        long n = control_points.cols() - 1;
+        double lower = (control_points.col(n) - control_points.col(0)).norm();
+        double upper = _polygon_length(control_points);
+        bool converged = upper - lower <= tolerance * (t1 - t0);
+        if(converged or depth == _max_depth){
+            // the arc length lies between the chord and the control polygon, quadrature is far more
+            // accurate than the bracket but is clamped to it such that the bracket bounds its error
+            double length = std::min(std::max(_gauss_legendre(a, t0, t1, derivative), lower), upper);
+            table.params.push_back(t0);
+            table.lengths.push_back(table.length);
+            table.length += length;
+            table.errors.back() += upper - lower;
+            if(!converged){
+                table.unconverged.back()++;
+            }
+            return;
+        }
+
+        // de Casteljau's algorithm at the middle, the left half goes to the next depth and the
+        // right half replaces the piece until the left half is done
+        Eigen::MatrixXd & left = pieces[depth + 1];
+        left.resize(control_points.rows(), n + 1);
+        for(long k = 0; k <= n; k++){
+            left.col(k) = control_points.col(0);
+            for(long j = 0; j < n - k; j++){
+                control_points.col(j) = (control_points.col(j) + control_points.col(j + 1)) / 2;
+            }
+        }
+        double middle = (t0 + t1) / 2;
+        _append_pieces(a, t0, middle, tolerance, depth + 1, pieces, table, derivative);
+        pieces[depth + 1] = pieces[depth];
+        _append_pieces(a, middle, t1, tolerance, depth + 1, pieces, table, derivative);
+    }
+
+    template <typename Scalar>
+    void _append_arc_length(const _PowerCoefficients<Scalar> & a, ArcLengthTable & table){
+        Eigen::Matrix<Scalar, Eigen::Dynamic, 1> derivative(a.rows());
+        table.offsets.push_back(static_cast<long>(table.params.size()));
+        table.errors.push_back(0);
+        table.unconverged.push_back(0);
+        std::vector<Eigen::MatrixXd> pieces(_max_depth + 1);
+        pieces[0] = _control_points(a);
+        double tolerance = arc_length_tolerance * _polygon_length(pieces[0]);
+        _append_pieces(a, 0, 1, tolerance, 0, pieces, table, derivative);
+    }
+
+    void append_arc_length(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, ArcLengthTable & table){
+        _append_arc_length<double>(power_coefficients, table);
+    }
+
+    void append_arc_length(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, ArcLengthTable & table){
+        _append_arc_length<float>(power_coefficients, table);
+    }
+
+    // pieces [first, last) of a curve in a table
+    std::pair<long, long> _pieces(const ArcLengthTable & table, unsigned long curve){
+        long first = table.offsets[curve];
+        long last = curve + 1 < table.offsets.size() ? table.offsets[curve + 1] : static_cast<long>(table.params.size());
+        return std::make_pair(first, last);
+    }
+
+    template <typename Scalar>
+    double _arc_length_at(const _PowerCoefficients<Scalar> & a, const ArcLengthTable & table, unsigned long curve,
+                          double t){
+        std::pair<long, long> pieces = _pieces(table, curve);
+        const double * params = table.params.data();
+        long piece = std::upper_bound(params + pieces.first + 1, params + pieces.second, t) - params - 1;
+        if(t == params[piece]){
+            return table.lengths[piece];
+        }
+        Eigen::Matrix<Scalar, Eigen::Dynamic, 1> derivative(a.rows());
+        return table.lengths[piece] + _gauss_legendre(a, params[piece], t, derivative);
+    }
+
+    double arc_length_at(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, const ArcLengthTable & table,
+                         unsigned long curve, double t){
+        return _arc_length_at<double>(power_coefficients, table, curve, t);
+    }
+
+    double arc_length_at(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, const ArcLengthTable & table,
+                         unsigned long curve, double t){
+        return _arc_length_at<float>(power_coefficients, table, curve, t);
+    }
+
+    unsigned long curve_at_arc_length(const ArcLengthTable & table, double length, unsigned long first_curve){
+        // the last curve starting at or before the length
+        auto first = table.offsets.begin() + first_curve + 1;
+        auto curve = std::upper_bound(first, table.offsets.end(), length, [&table](double length, long offset){
+            return length < table.lengths[offset];
+        });
+        return static_cast<unsigned long>(curve - table.offsets.begin()) - 1;
+    }
+
+    template <typename Scalar>
+    double _param_at_arc_length(const _PowerCoefficients<Scalar> & a, const ArcLengthTable & table,
+                                unsigned long curve, double length){
+        std::pair<long, long> pieces = _pieces(table, curve);
+        const double * lengths = table.lengths.data();
+        long piece = std::upper_bound(lengths + pieces.first + 1, lengths + pieces.second, length) - lengths - 1;
+        double t0 = table.params[piece];
+        double t1 = piece + 1 < pieces.second ? table.params[piece + 1] : 1;
+        double piece_end = piece + 1 < table.lengths.size() ? lengths[piece + 1] : table.length;
+        double target = length - lengths[piece];
+        if(target <= 0){
+            return t0;
+        }
+        if(length >= piece_end){
+            return t1;
+        }
+
+        // Newton's method on the length from t0, the length is increasing in t so the
+        // solution stays bracketed and bisection takes over when a step leaves the bracket
+        Eigen::Matrix<Scalar, Eigen::Dynamic, 1> derivative(a.rows());
+        double relative_tolerance = std::max(_param_tolerance, 64.0 * std::numeric_limits<Scalar>::epsilon());
+        double tolerance = relative_tolerance * (piece_end - lengths[piece]);
+        double lower = t0, upper = t1;
+        double t = t0 + (t1 - t0) * target / (piece_end - lengths[piece]);
+        for(int i = 0; i < 100; i++){
+            double error = _gauss_legendre(a, t0, t, derivative) - target;
+            if(std::abs(error) <= tolerance){
+                break;
+            }
+            if(error < 0){
+                lower = t;
+            }
+            else{
+                upper = t;
+            }
+            double speed = _speed(a, t, derivative);
+            double next = speed > 0 ? t - error / speed : lower;
+            if(!(next > lower and next < upper)){
+                next = lower + (upper - lower) / 2;
+            }
+            if(next == t){
+                break;
+            }
+            t = next;
+        }
+        return t;
+    }
+
+    double param_at_arc_length(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                               const ArcLengthTable & table, unsigned long curve, double length){
+        return _param_at_arc_length<double>(power_coefficients, table, curve, length);
+    }
+
+    double param_at_arc_length(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                               const ArcLengthTable & table, unsigned long curve, double length){
+        return _param_at_arc_length<float>(power_coefficients, table, curve, length);
+    }
+}
@@ -0,0 +1,41 @@
+#include <bezier/math/box_tree.h>
+
+#include <stdexcept>
+
+namespace bezier {
+
+    long _build_box_tree(const Eigen::Ref<const Eigen::MatrixXd> & lower, const Eigen::Ref<const Eigen::MatrixXd> & upper,
+                         long begin, long end, BoxTree & tree){
+        long node = static_cast<long>(tree.begin.size());
+        tree.begin.push_back(begin);
+        tree.end.push_back(end);
+        tree.second_child.push_back(-1);
+        if(end - begin == 1){
+            tree.lower.col(node) = lower.col(begin);
+            tree.upper.col(node) = upper.col(begin);
+            return node;
+        }
+        long middle = begin + (end - begin) / 2;
+        long first = _build_box_tree(lower, upper, begin, middle, tree);
+        long second = _build_box_tree(lower, upper, middle, end, tree);
+        tree.second_child[node] = second;
+        tree.lower.col(node) = tree.lower.col(first).cwiseMin(tree.lower.col(second));
+        tree.upper.col(node) = tree.upper.col(first).cwiseMax(tree.upper.col(second));
+        return node;
+    }
+
+    BoxTree build_box_tree(const Eigen::Ref<const Eigen::MatrixXd> & lower, const Eigen::Ref<const Eigen::MatrixXd> & upper){
+        if(lower.cols() == 0 or lower.rows() != upper.rows() or lower.cols() != upper.cols()){
+            throw std::invalid_argument("Lower and upper bounds must be given for at least one box.");
+        }
+        long number_of_nodes = 2 * lower.cols() - 1;
+        BoxTree tree;
+        tree.lower.resize(lower.rows(), number_of_nodes);
+        tree.upper.resize(lower.rows(), number_of_nodes);
+        tree.begin.reserve(number_of_nodes);
+        tree.end.reserve(number_of_nodes);
+        tree.second_child.reserve(number_of_nodes);
+        _build_box_tree(lower, upper, 0, lower.cols(), tree);
+        return tree;
+    }
+}
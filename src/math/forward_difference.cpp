@@ -0,0 +1,104 @@
+#include <bezier/math/forward_difference.h>
+
+#include <stdexcept>
+
+namespace bezier {
+
+    using Eigen::MatrixXd;
+
+    /**
+     * Set column k of differences to the k-th forward difference of p at t.
+     * The differences are computed from the coefficients of q(s) = p(t + s h) as
+     *
+     * Delta^k q(0) = sum_m k! S(m, k) q_m
+     *
+     * where S(m, k) are Stirling numbers of the second kind. Unlike differencing values of p,
+     * which cancels almost all significant digits for small h, this keeps full precision.
+     * @param differences_of_powers : k! S(m, k) at (m, k)
+     */
+    void _initialize_differences(const Eigen::Ref<const MatrixXd> & power_coefficients,
+                                 const MatrixXd & differences_of_powers,
+                                 double t, double h, MatrixXd & differences){
+        long degree = power_coefficients.cols() - 1;
+
+        // Taylor shift, coefficients of p(t + u) in u
+        differences = power_coefficients;
+        for(long i = 0; i < degree; i++){
+            for(long j = degree - 1; j >= i; j--){
+                differences.col(j) += t * differences.col(j+1);
+            }
+        }
+
+        // scale, coefficients of q(s) = p(t + s h) in s
+        double h_pow = h;
+        for(long j = 1; j < degree+1; j++){
+            differences.col(j) *= h_pow;
+            h_pow *= h;
+        }
+
+        // forward differences, column k only depends on columns m >= k
+        for(long k = 1; k < degree+1; k++){
+            differences.col(k) *= differences_of_powers(k, k);
+            for(long m = k + 1; m < degree+1; m++){
+                differences.col(k) += differences_of_powers(m, k) * differences.col(m);
+            }
+        }
+    }
+
+    template <typename Scalar>
+    void _forward_difference(const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> & power_coefficients,
+                             double t0,
+                             double h,
+                             Eigen::Ref<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> samples,
+                             int reanchor_interval){
+        if(samples.rows() != power_coefficients.rows()){
+            throw std::invalid_argument("Samples must have the same dimension as the curve.");
+        }
+        if(reanchor_interval < 1){
+            throw std::invalid_argument("Re-anchor interval must be positive.");
+        }
+
+        long degree = power_coefficients.cols() - 1;
+        MatrixXd coefficients = power_coefficients.template cast<double>();
+        MatrixXd initial_differences(power_coefficients.rows(), degree + 1);
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> differences(power_coefficients.rows(), degree + 1);
+
+        // k! S(m, k), i.e. the k-th forward difference of s^m at 0
+        MatrixXd differences_of_powers = MatrixXd::Zero(degree + 1, degree + 1);
+        differences_of_powers(0, 0) = 1;
+        for(long m = 1; m < degree+1; m++){
+            for(long k = 1; k <= m; k++){
+                differences_of_powers(m, k) = k * (differences_of_powers(m-1, k) + differences_of_powers(m-1, k-1));
+            }
+        }
+
+        for(long j = 0; j < samples.cols(); j++){
+            if(j % reanchor_interval == 0){
+                _initialize_differences(coefficients, differences_of_powers, t0 + j * h, h, initial_differences);
+                differences = initial_differences.cast<Scalar>();
+            }
+            else{
+                for(long k = 0; k < degree; k++){
+                    differences.col(k) += differences.col(k+1);
+                }
+            }
+            samples.col(j) = differences.col(0);
+        }
+    }
+
+    void forward_difference(const Eigen::Ref<const MatrixXd> & power_coefficients,
+                            double t0,
+                            double h,
+                            Eigen::Ref<MatrixXd> samples,
+                            int reanchor_interval){
+        _forward_difference<double>(power_coefficients, t0, h, samples, reanchor_interval);
+    }
+
+    void forward_difference(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                            float t0,
+                            float h,
+                            Eigen::Ref<Eigen::MatrixXf> samples,
+                            int reanchor_interval){
+        _forward_difference<float>(power_coefficients, t0, h, samples, reanchor_interval);
+    }
+}
@@ -0,0 +1,210 @@
+#include <bezier/math/horner.h>
+
+#if defined(__x86_64__)
+#define BEZIER_X86
+#include <immintrin.h>
+#endif
+
+namespace bezier {
+
+    template <typename Scalar>
+    void _horner(const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> & a, Scalar t,
+                 Eigen::Ref<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> out, unsigned int order){
+        long degree = a.cols() - 1;
+        if(order == 0){
+            out = a.col(degree);
+            for(long j = degree - 1; j >= 0; j--){
+                out = out * t + a.col(j);
+            }
+            return;
+        }
+        if(order > degree){
+            out.setZero();
+            return;
+        }
+        // j! / (j-k)!
+        auto falling_factorial = [order](long j){
+            Scalar value = 1;
+            for(long i = j - order + 1; i <= j; i++){
+                value *= i;
+            }
+            return value;
+        };
+        out = falling_factorial(degree) * a.col(degree);
+        for(long j = degree - 1; j >= order; j--){
+            out = out * t + falling_factorial(j) * a.col(j);
+        }
+    }
+
+    void horner(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, double t,
+                Eigen::Ref<Eigen::VectorXd> out, unsigned int order){
+        _horner<double>(power_coefficients, t, out, order);
+    }
+
+    void horner(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, float t,
+                Eigen::Ref<Eigen::VectorXf> out, unsigned int order){
+        _horner<float>(power_coefficients, t, out, order);
+    }
+
+    typedef void (*HornerBatchKernel)(const double *, int, int, const double *, long, double *, long, long);
+    typedef void (*HornerBatchKernelf)(const float *, int, int, const float *, long, float *, long, long);
+
+    /**
+     * Evaluate the parameters [first, n_params) one at a time
+     */
+    template <typename Scalar>
+    void _horner_batch_scalar(const Scalar * a, int dimension, int degree,
+                              const Scalar * ts, long n_params,
+                              Scalar * out, long out_stride, long first){
+        for(int i = 0; i < dimension; i++){
+            for(long j = first; j < n_params; j++){
+                Scalar t = ts[j];
+                Scalar value = a[degree * dimension + i];
+                for(int k = degree - 1; k >= 0; k--){
+                    value = value * t + a[k * dimension + i];
+                }
+                out[i * out_stride + j] = value;
+            }
+        }
+    }
+
+#ifdef BEZIER_X86
+    void _horner_batch_sse2(const double * a, int dimension, int degree,
+                            const double * ts, long n_params,
+                            double * out, long out_stride, long first){
+        long j = first;
+        for(; j + 2 <= n_params; j += 2){
+            __m128d t = _mm_loadu_pd(ts + j);
+            for(int i = 0; i < dimension; i++){
+                __m128d value = _mm_set1_pd(a[degree * dimension + i]);
+                for(int k = degree - 1; k >= 0; k--){
+                    value = _mm_add_pd(_mm_mul_pd(value, t), _mm_set1_pd(a[k * dimension + i]));
+                }
+                _mm_storeu_pd(out + i * out_stride + j, value);
+            }
+        }
+        _horner_batch_scalar(a, dimension, degree, ts, n_params, out, out_stride, j);
+    }
+
+    void _horner_batch_sse2(const float * a, int dimension, int degree,
+                            const float * ts, long n_params,
+                            float * out, long out_stride, long first){
+        long j = first;
+        for(; j + 4 <= n_params; j += 4){
+            __m128 t = _mm_loadu_ps(ts + j);
+            for(int i = 0; i < dimension; i++){
+                __m128 value = _mm_set1_ps(a[degree * dimension + i]);
+                for(int k = degree - 1; k >= 0; k--){
+                    value = _mm_add_ps(_mm_mul_ps(value, t), _mm_set1_ps(a[k * dimension + i]));
+                }
+                _mm_storeu_ps(out + i * out_stride + j, value);
+            }
+        }
+        _horner_batch_scalar(a, dimension, degree, ts, n_params, out, out_stride, j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void _horner_batch_avx2(const double * a, int dimension, int degree,
+                            const double * ts, long n_params,
+                            double * out, long out_stride, long first){
+        long j = first;
+        // two independent registers per iteration to hide the FMA latency
+        for(; j + 8 <= n_params; j += 8){
+            __m256d t0 = _mm256_loadu_pd(ts + j);
+            __m256d t1 = _mm256_loadu_pd(ts + j + 4);
+            for(int i = 0; i < dimension; i++){
+                __m256d value0 = _mm256_set1_pd(a[degree * dimension + i]);
+                __m256d value1 = value0;
+                for(int k = degree - 1; k >= 0; k--){
+                    __m256d coefficient = _mm256_set1_pd(a[k * dimension + i]);
+                    value0 = _mm256_fmadd_pd(value0, t0, coefficient);
+                    value1 = _mm256_fmadd_pd(value1, t1, coefficient);
+                }
+                _mm256_storeu_pd(out + i * out_stride + j, value0);
+                _mm256_storeu_pd(out + i * out_stride + j + 4, value1);
+            }
+        }
+        for(; j + 4 <= n_params; j += 4){
+            __m256d t = _mm256_loadu_pd(ts + j);
+            for(int i = 0; i < dimension; i++){
+                __m256d value = _mm256_set1_pd(a[degree * dimension + i]);
+                for(int k = degree - 1; k >= 0; k--){
+                    value = _mm256_fmadd_pd(value, t, _mm256_set1_pd(a[k * dimension + i]));
+                }
+                _mm256_storeu_pd(out + i * out_stride + j, value);
+            }
+        }
+        _horner_batch_scalar(a, dimension, degree, ts, n_params, out, out_stride, j);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void _horner_batch_avx2(const float * a, int dimension, int degree,
+                            const float * ts, long n_params,
+                            float * out, long out_stride, long first){
+        long j = first;
+        for(; j + 16 <= n_params; j += 16){
+            __m256 t0 = _mm256_loadu_ps(ts + j);
+            __m256 t1 = _mm256_loadu_ps(ts + j + 8);
+            for(int i = 0; i < dimension; i++){
+                __m256 value0 = _mm256_set1_ps(a[degree * dimension + i]);
+                __m256 value1 = value0;
+                for(int k = degree - 1; k >= 0; k--){
+                    __m256 coefficient = _mm256_set1_ps(a[k * dimension + i]);
+                    value0 = _mm256_fmadd_ps(value0, t0, coefficient);
+                    value1 = _mm256_fmadd_ps(value1, t1, coefficient);
+                }
+                _mm256_storeu_ps(out + i * out_stride + j, value0);
+                _mm256_storeu_ps(out + i * out_stride + j + 8, value1);
+            }
+        }
+        for(; j + 8 <= n_params; j += 8){
+            __m256 t = _mm256_loadu_ps(ts + j);
+            for(int i = 0; i < dimension; i++){
+                __m256 value = _mm256_set1_ps(a[degree * dimension + i]);
+                for(int k = degree - 1; k >= 0; k--){
+                    value = _mm256_fmadd_ps(value, t, _mm256_set1_ps(a[k * dimension + i]));
+                }
+                _mm256_storeu_ps(out + i * out_stride + j, value);
+            }
+        }
+        _horner_batch_scalar(a, dimension, degree, ts, n_params, out, out_stride, j);
+    }
+#endif
+
+    struct _HornerBatchDispatch {
+        HornerBatchKernel kernel;
+        HornerBatchKernelf kernelf;
+        const char * instruction_set;
+    };
+
+    const _HornerBatchDispatch & _horner_batch_dispatch(){
+        static const _HornerBatchDispatch dispatch = [](){
+#ifdef BEZIER_X86
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma")){
+                return _HornerBatchDispatch{_horner_batch_avx2, _horner_batch_avx2, "avx2"};
+            }
+            return _HornerBatchDispatch{_horner_batch_sse2, _horner_batch_sse2, "sse2"};
+#else
+            return _HornerBatchDispatch{_horner_batch_scalar<double>, _horner_batch_scalar<float>, "scalar"};
+#endif
+        }();
+        return dispatch;
+    }
+
+    void horner_batch(const double * power_coefficients, int dimension, int degree,
+                      const double * ts, long n_params,
+                      double * out, long out_stride){
+        _horner_batch_dispatch().kernel(power_coefficients, dimension, degree, ts, n_params, out, out_stride, 0);
+    }
+
+    void horner_batch(const float * power_coefficients, int dimension, int degree,
+                      const float * ts, long n_params,
+                      float * out, long out_stride){
+        _horner_batch_dispatch().kernelf(power_coefficients, dimension, degree, ts, n_params, out, out_stride, 0);
+    }
+
+    const char * horner_batch_instruction_set(){
+        return _horner_batch_dispatch().instruction_set;
+    }
+}
@@ -1,4 +1,7 @@
 #include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <algorithm>
 #include "bezier/math/misc.h"
 
 namespace bezier {
@@ -12,4 +15,38 @@ namespace bezier {
         }
         return n * factorial(n - 1);
     }
+
+    std::vector<double> binomial_coefficients(int n){
+        if (n < 0){
+            throw std::domain_error("Binomial coefficients defined for n >= 0.");
+        }
+        std::vector<double> row(n + 1, 0);
+        row[0] = 1;
+        for(int i = 1; i <= n; i++){
+            for(int k = i; k > 0; k--){
+                row[k] += row[k - 1];
+            }
+        }
+        return row;
+    }
+
+    template <typename Scalar>
+    Scalar _curvature(const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & first,
+                      const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & second){
+        Scalar speed = first.norm();
+        if(speed == 0){
+            return std::numeric_limits<Scalar>::infinity();
+        }
+        Scalar dot = first.dot(second);
+        Scalar area = std::sqrt(std::max(Scalar(0), first.squaredNorm() * second.squaredNorm() - dot * dot));
+        return area / (speed * speed * speed);
+    }
+
+    double curvature(const Eigen::Ref<const Eigen::VectorXd> & first, const Eigen::Ref<const Eigen::VectorXd> & second){
+        return _curvature<double>(first, second);
+    }
+
+    float curvature(const Eigen::Ref<const Eigen::VectorXf> & first, const Eigen::Ref<const Eigen::VectorXf> & second){
+        return _curvature<float>(first, second);
+    }
 }
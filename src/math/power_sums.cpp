@@ -0,0 +1,39 @@
+#include <bezier/math/power_sums.h>
+
+#include <algorithm>
+
+namespace bezier {
+
+    void accumulate_power_sums(const Eigen::Ref<const Eigen::VectorXd> & ts,
+                               const Eigen::Ref<const Eigen::MatrixXd> & points,
+                               Eigen::Ref<Eigen::VectorXd> power_sums,
+                               Eigen::Ref<Eigen::MatrixXd> weighted_sums){
+        long degree = weighted_sums.cols() - 1;
+        for(long i = 0; i < ts.rows(); i++){
+            double t = ts(i);
+            double power = 1;
+            for(long k = 0; k <= degree; k++){
+                power_sums(k) += power;
+                weighted_sums.col(k) += power * points.col(i);
+                power *= t;
+            }
+            for(long k = degree + 1; k < power_sums.rows(); k++){
+                power_sums(k) += power;
+                power *= t;
+            }
+        }
+    }
+
+    void hankel_normal_matrix(const Eigen::Ref<const Eigen::VectorXd> & power_sums, double scale,
+                              Eigen::Ref<Eigen::MatrixXd> normal_matrix){
+        double power = 1;
+        for(long s = 0; s < power_sums.rows(); s++){
+            // anti-diagonal j + k = s
+            double value = power_sums(s) * power;
+            for(long j = std::max(0L, s - normal_matrix.cols() + 1); j <= std::min(s, normal_matrix.rows() - 1); j++){
+                normal_matrix(j, s - j) = value;
+            }
+            power *= scale;
+        }
+    }
+}
@@ -0,0 +1,270 @@
+#include <bezier/math/roots.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace bezier {
+
+    // scratch space on the stack for polynomials up to this degree
+    static const int _stack_degree = 32;
+
+    double _evaluate_polynomial(const double * a, int degree, double t){
+        double value = a[degree];
+        for(int j = degree - 1; j >= 0; j--){
+            value = value * t + a[j];
+        }
+        return value;
+    }
+
+    /**
+     * Find the roots of a_0 + a_1 t + ... + a_n t^n in [t0, t1] in increasing order.
+     * @param a : (a_0, a_1, ..., a_n)
+     * @param degree : n
+     * @param t0 : start of the interval
+     * @param t1 : end of the interval
+     * @param roots : space for at least n roots
+     * @param scratch : space for at least n (n + 1) / 2 coefficients
+     * @return number of roots
+     */
+    int _polynomial_roots(const double * a, int degree, double t0, double t1, double * roots, double * scratch){
+        while(degree > 0 and a[degree] == 0){
+            degree--;
+        }
+        if(degree == 0){
+            return 0;
+        }
+
+        if(degree == 1){
+            double root = -a[0] / a[1];
+            if(root >= t0 and root <= t1){
+                roots[0] = root;
+                return 1;
+            }
+            return 0;
+        }
+
+        if(degree == 2){
+            // avoid cancellation, see Numerical Recipes 5.6
+            double discriminant = a[1] * a[1] - 4 * a[2] * a[0];
+            if(discriminant < 0){
+                return 0;
+            }
+            double q = -0.5 * (a[1] + std::copysign(std::sqrt(discriminant), a[1]));
+            double candidates[2] = {q / a[2], q != 0 ? a[0] / q : q / a[2]};
+            if(candidates[0] > candidates[1]){
+                std::swap(candidates[0], candidates[1]);
+            }
+            int number_of_roots = 0;
+            for(double root : candidates){
+                if(root >= t0 and root <= t1 and (number_of_roots == 0 or root != roots[0])){
+                    roots[number_of_roots++] = root;
+                }
+            }
+            return number_of_roots;
+        }
+
+        // p is monotone between the roots of p'
+        double * derivative = scratch;
+        for(int j = 0; j < degree; j++){
+            derivative[j] = (j + 1) * a[j + 1];
+        }
+        int number_of_critical = _polynomial_roots(derivative, degree - 1, t0, t1, roots, scratch + degree);
+        double critical[_stack_degree + 2];
+        std::vector<double> heap;
+        double * ends = critical;
+        if(number_of_critical > _stack_degree){
+            heap.resize(number_of_critical + 2);
+            ends = heap.data();
+        }
+        ends[0] = t0;
+        std::copy(roots, roots + number_of_critical, ends + 1);
+        ends[number_of_critical + 1] = t1;
+
+        int number_of_roots = 0;
+        double start = ends[0];
+        double start_value = _evaluate_polynomial(a, degree, start);
+        for(int i = 1; i < number_of_critical + 2; i++){
+            double end = ends[i];
+            double end_value = _evaluate_polynomial(a, degree, end);
+            double root;
+            if(start_value == 0){
+                root = start;
+            }
+            else if(end_value == 0 or (start_value < 0) == (end_value < 0)){
+                start = end;
+                start_value = end_value;
+                continue;
+            }
+            else{
+                // Newton's method inside the bracket, bisection takes over when a step leaves it
+                double lower = start, upper = end;
+                bool increasing = start_value < 0;
+                root = lower + (upper - lower) / 2;
+                for(int iteration = 0; iteration < 200; iteration++){
+                    double value = _evaluate_polynomial(a, degree, root);
+                    if(value == 0){
+                        break;
+                    }
+                    if((value < 0) == increasing){
+                        lower = root;
+                    }
+                    else{
+                        upper = root;
+                    }
+                    double slope = _evaluate_polynomial(derivative, degree - 1, root);
+                    double next = slope != 0 ? root - value / slope : lower;
+                    if(!(next > lower and next < upper)){
+                        next = lower + (upper - lower) / 2;
+                        if(next <= lower or next >= upper){
+                            break;
+                        }
+                    }
+                    bool converged = std::abs(next - root) <= std::numeric_limits<double>::epsilon() * std::abs(root);
+                    root = next;
+                    if(converged){
+                        break;
+                    }
+                }
+            }
+            if(number_of_roots == 0 or root != roots[number_of_roots - 1]){
+                roots[number_of_roots++] = root;
+            }
+            start = end;
+            start_value = end_value;
+        }
+        if(start_value == 0 and (number_of_roots == 0 or start != roots[number_of_roots - 1])){
+            roots[number_of_roots++] = start;
+        }
+        return number_of_roots;
+    }
+
+    std::vector<double> polynomial_roots(const Eigen::Ref<const Eigen::VectorXd> & coefficients, double t0, double t1){
+        if(coefficients.rows() == 0){
+            throw std::invalid_argument("A polynomial must have at least one coefficient.");
+        }
+        int degree = static_cast<int>(coefficients.rows() - 1);
+        std::vector<double> a(coefficients.data(), coefficients.data() + coefficients.rows());
+        std::vector<double> roots(degree);
+        std::vector<double> scratch(degree * (degree + 1) / 2);
+        roots.resize(_polynomial_roots(a.data(), degree, t0, t1, roots.data(), scratch.data()));
+        return roots;
+    }
+
+    template <typename Scalar>
+    void _polynomial_bounds(const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> & a,
+                            Scalar t0, Scalar t1,
+                            Eigen::Ref<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> min_bound,
+                            Eigen::Ref<Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> max_bound){
+        int degree = static_cast<int>(a.cols() - 1);
+        double stack[(_stack_degree + 1) * (_stack_degree + 4) / 2 + _stack_degree + 1];
+        std::vector<double> heap;
+        double * coefficients = stack;
+        if(degree > _stack_degree){
+            heap.resize((degree + 1) * (degree + 4) / 2 + degree + 1);
+            coefficients = heap.data();
+        }
+        // (n + 1) coefficients and their derivative, n roots, n (n - 1) / 2 scratch
+        double * derivative = coefficients + degree + 1;
+        double * roots = derivative + std::max(degree, 1);
+        double * scratch = roots + std::max(degree, 1);
+
+        for(long r = 0; r < a.rows(); r++){
+            for(int j = 0; j < degree + 1; j++){
+                coefficients[j] = static_cast<double>(a(r, j));
+            }
+            for(int j = 0; j < degree; j++){
+                derivative[j] = (j + 1) * coefficients[j + 1];
+            }
+            double lower = _evaluate_polynomial(coefficients, degree, t0);
+            double upper = lower;
+            double end = _evaluate_polynomial(coefficients, degree, t1);
+            lower = std::min(lower, end);
+            upper = std::max(upper, end);
+            int number_of_roots = degree > 0 ? _polynomial_roots(derivative, degree - 1, t0, t1, roots, scratch) : 0;
+            for(int i = 0; i < number_of_roots; i++){
+                double value = _evaluate_polynomial(coefficients, degree, roots[i]);
+                lower = std::min(lower, value);
+                upper = std::max(upper, value);
+            }
+            min_bound(r) = static_cast<Scalar>(lower);
+            max_bound(r) = static_cast<Scalar>(upper);
+        }
+    }
+
+    void polynomial_bounds(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients, double t0, double t1,
+                           Eigen::Ref<Eigen::VectorXd> min_bound, Eigen::Ref<Eigen::VectorXd> max_bound){
+        _polynomial_bounds<double>(power_coefficients, t0, t1, min_bound, max_bound);
+    }
+
+    void polynomial_bounds(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients, float t0, float t1,
+                           Eigen::Ref<Eigen::VectorXf> min_bound, Eigen::Ref<Eigen::VectorXf> max_bound){
+        _polynomial_bounds<float>(power_coefficients, t0, t1, min_bound, max_bound);
+    }
+
+    template <typename Scalar>
+    std::pair<double, double> _closest_point(const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>> & a,
+                                             const Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1>> & point){
+        int degree = static_cast<int>(a.cols() - 1);
+        int dimension = static_cast<int>(a.rows());
+        // f(t) = (p(t) - q) . p'(t) has degree 2n - 1
+        int f_degree = std::max(2 * degree - 1, 0);
+        double stack[(_stack_degree + 1) * (_stack_degree + 4) / 2];
+        std::vector<double> heap;
+        double * f = stack;
+        if(f_degree > _stack_degree){
+            heap.resize((f_degree + 1) * (f_degree + 4) / 2);
+            f = heap.data();
+        }
+        double * roots = f + f_degree + 1;
+        double * scratch = roots + std::max(f_degree, 1);
+
+        std::fill(f, f + f_degree + 1, 0.0);
+        for(int r = 0; r < dimension; r++){
+            for(int i = 0; i < degree + 1; i++){
+                double difference = static_cast<double>(a(r, i)) - (i == 0 ? static_cast<double>(point(r)) : 0.0);
+                for(int j = 1; j < degree + 1; j++){
+                    f[i + j - 1] += difference * j * static_cast<double>(a(r, j));
+                }
+            }
+        }
+
+        auto squared_distance = [&](double t){
+            double distance = 0;
+            for(int r = 0; r < dimension; r++){
+                double value = static_cast<double>(a(r, degree));
+                for(int j = degree - 1; j >= 0; j--){
+                    value = value * t + static_cast<double>(a(r, j));
+                }
+                value -= static_cast<double>(point(r));
+                distance += value * value;
+            }
+            return distance;
+        };
+
+        std::pair<double, double> closest(0, squared_distance(0));
+        int number_of_roots = degree > 0 ? _polynomial_roots(f, f_degree, 0, 1, roots, scratch) : 0;
+        for(int i = 0; i < number_of_roots; i++){
+            double distance = squared_distance(roots[i]);
+            if(distance < closest.second){
+                closest = std::make_pair(roots[i], distance);
+            }
+        }
+        double end = squared_distance(1);
+        if(end < closest.second){
+            closest = std::make_pair(1.0, end);
+        }
+        return closest;
+    }
+
+    std::pair<double, double> closest_point(const Eigen::Ref<const Eigen::MatrixXd> & power_coefficients,
+                                            const Eigen::Ref<const Eigen::VectorXd> & point){
+        return _closest_point<double>(power_coefficients, point);
+    }
+
+    std::pair<double, double> closest_point(const Eigen::Ref<const Eigen::MatrixXf> & power_coefficients,
+                                            const Eigen::Ref<const Eigen::VectorXf> & point){
+        return _closest_point<float>(power_coefficients, point);
+    }
+}
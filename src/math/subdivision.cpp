@@ -0,0 +1,171 @@
+#include <bezier/math/subdivision.h>
+#include <bezier/math/misc.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace bezier {
+
+    template <typename Scalar>
+    using _ControlPoints = Eigen::Ref<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>;
+
+    template <typename Scalar>
+    using _Output = Eigen::Ref<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>>;
+
+    template <typename Scalar>
+    void _split_control_points(const _ControlPoints<Scalar> & p, Scalar t, _Output<Scalar> left, _Output<Scalar> right){
+        if(t < 0 or t > 1){
+            throw std::domain_error("Bezier curve only defined on [0,1].");
+        }
+        if(left.rows() != p.rows() or left.cols() != p.cols() or right.rows() != p.rows() or right.cols() != p.cols()){
+            throw std::invalid_argument("Split curves must have the same dimension and degree as the curve.");
+        }
+        // after step r, right.col(i) holds the point of level r of de Casteljau's triangle, the
+        // columns which are no longer updated are the control points of the curve on [t,1]
+        long degree = p.cols() - 1;
+        right = p;
+        left.col(0) = p.col(0);
+        for(long r = 1; r < degree + 1; r++){
+            for(long i = 0; i < degree + 1 - r; i++){
+                right.col(i) = (1 - t) * right.col(i) + t * right.col(i + 1);
+            }
+            left.col(r) = right.col(0);
+        }
+    }
+
+    void split_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points, double t,
+                              Eigen::Ref<Eigen::MatrixXd> left, Eigen::Ref<Eigen::MatrixXd> right){
+        _split_control_points<double>(control_points, t, left, right);
+    }
+
+    void split_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points, float t,
+                              Eigen::Ref<Eigen::MatrixXf> left, Eigen::Ref<Eigen::MatrixXf> right){
+        _split_control_points<float>(control_points, t, left, right);
+    }
+
+    template <typename Scalar>
+    void _elevate_control_points(const _ControlPoints<Scalar> & p, _Output<Scalar> elevated){
+        if(elevated.rows() != p.rows() or elevated.cols() < p.cols()){
+            throw std::invalid_argument("Elevated curve must have the same dimension and at least the same degree.");
+        }
+        // elevate one degree at a time in place, from the back such that P_(i-1) is not yet overwritten
+        elevated.leftCols(p.cols()) = p;
+        for(long m = p.cols() - 1; m < elevated.cols() - 1; m++){
+            elevated.col(m + 1) = elevated.col(m);
+            for(long i = m; i > 0; i--){
+                Scalar a = static_cast<Scalar>(i) / static_cast<Scalar>(m + 1);
+                elevated.col(i) = a * elevated.col(i - 1) + (1 - a) * elevated.col(i);
+            }
+        }
+    }
+
+    void elevate_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points,
+                                Eigen::Ref<Eigen::MatrixXd> elevated){
+        _elevate_control_points<double>(control_points, elevated);
+    }
+
+    void elevate_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points,
+                                Eigen::Ref<Eigen::MatrixXf> elevated){
+        _elevate_control_points<float>(control_points, elevated);
+    }
+
+    /**
+     * Operators of a degree reduction from n to m
+     */
+    struct _DegreeReduction {
+        Eigen::MatrixXd reduction; // (m+1) x (n+1), Q = P reduction^T
+        Eigen::MatrixXd elevation; // (n+1) x (m+1), E
+    };
+
+    _DegreeReduction _degree_reduction(int n, int m){
+        // E(i, j) = (m choose j) (n-m choose i-j) / (n choose i)
+        std::vector<double> binomial_n = binomial_coefficients(n);
+        std::vector<double> binomial_m = binomial_coefficients(m);
+        std::vector<double> binomial_nm = binomial_coefficients(n - m);
+        Eigen::MatrixXd elevation = Eigen::MatrixXd::Zero(n + 1, m + 1);
+        for(int i = 0; i < n + 1; i++){
+            for(int j = std::max(0, i - (n - m)); j < std::min(i, m) + 1; j++){
+                elevation(i, j) = binomial_m[j] * binomial_nm[i - j] / binomial_n[i];
+            }
+        }
+
+        // Q_0 = P_0 and Q_m = P_n, the inner control points solve the least squares problem
+        // E_inner Q_inner = P - E_0 P_0 - E_m P_n
+        Eigen::MatrixXd reduction = Eigen::MatrixXd::Zero(m + 1, n + 1);
+        reduction(0, 0) = 1;
+        reduction(m, n) = 1;
+        if(m > 1){
+            Eigen::MatrixXd inner = elevation.middleCols(1, m - 1);
+            Eigen::MatrixXd pseudo_inverse = inner.colPivHouseholderQr().solve(Eigen::MatrixXd::Identity(n + 1, n + 1));
+            Eigen::MatrixXd fixed = Eigen::MatrixXd::Identity(n + 1, n + 1);
+            fixed.col(0) -= elevation.col(0);
+            fixed.col(n) -= elevation.col(m);
+            reduction.middleRows(1, m - 1) = pseudo_inverse * fixed;
+        }
+        return {reduction, elevation};
+    }
+
+    const _DegreeReduction & _cached_degree_reduction(int n, int m){
+        static std::map<std::pair<int, int>, std::unique_ptr<const _DegreeReduction>> cache;
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<const _DegreeReduction> & entry = cache[std::make_pair(n, m)];
+        if(!entry){
+            entry.reset(new _DegreeReduction(_degree_reduction(n, m)));
+        }
+        return *entry;
+    }
+
+    template <typename Scalar>
+    double _reduce_control_points(const _ControlPoints<Scalar> & p, _Output<Scalar> reduced){
+        long n = p.cols() - 1;
+        long m = reduced.cols() - 1;
+        if(reduced.rows() != p.rows() or m > n or m < 0 or (m == 0 and n > 0)){
+            throw std::invalid_argument("Reduced curve must have the same dimension and a degree in [1, n].");
+        }
+        if(m == n){
+            reduced = p;
+            return 0;
+        }
+        const _DegreeReduction & operators = _cached_degree_reduction(static_cast<int>(n), static_cast<int>(m));
+        // the products are written out since the operands are small, and Eigen could allocate otherwise
+        for(long j = 0; j < m + 1; j++){
+            for(long r = 0; r < p.rows(); r++){
+                double value = 0;
+                for(long i = 0; i < n + 1; i++){
+                    value += operators.reduction(j, i) * static_cast<double>(p(r, i));
+                }
+                reduced(r, j) = static_cast<Scalar>(value);
+            }
+        }
+
+        double error = 0;
+        for(long i = 0; i < n + 1; i++){
+            double squared = 0;
+            for(long r = 0; r < p.rows(); r++){
+                double value = 0;
+                for(long j = 0; j < m + 1; j++){
+                    value += operators.elevation(i, j) * static_cast<double>(reduced(r, j));
+                }
+                squared += (static_cast<double>(p(r, i)) - value) * (static_cast<double>(p(r, i)) - value);
+            }
+            error = std::max(error, std::sqrt(squared));
+        }
+        return error;
+    }
+
+    double reduce_control_points(const Eigen::Ref<const Eigen::MatrixXd> & control_points,
+                                 Eigen::Ref<Eigen::MatrixXd> reduced){
+        return _reduce_control_points<double>(control_points, reduced);
+    }
+
+    double reduce_control_points(const Eigen::Ref<const Eigen::MatrixXf> & control_points,
+                                 Eigen::Ref<Eigen::MatrixXf> reduced){
+        return _reduce_control_points<float>(control_points, reduced);
+    }
+}
@@ -0,0 +1,280 @@
+#include <bezier/online_composite_fitter.h>
+#include <bezier/math/power_sums.h>
+#include <bezier/math/tridiagonal.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bezier {
+
+    using std::vector;
+    using Eigen::MatrixXd;
+    using Eigen::VectorXd;
+
+    template <typename Scalar>
+    BasicOnlineCompositeFitter<Scalar>::BasicOnlineCompositeFitter(unsigned int degree, unsigned int points_per_curve,
+                                                                   unsigned int window_size) :
+            _degree(degree), _points_per_curve(points_per_curve), _window_size(window_size), _dimension(-1),
+            _number_of_points(0), _first_dirty_block(0), _solved(true) {
+        if(degree < 3){
+            throw std::invalid_argument("The Bezier curves must be of degree at least 3.");
+        }
+        if(points_per_curve < degree + 1){
+            throw std::invalid_argument("Not enough data points to fit curve.");
+        }
+        if(window_size == 0){
+            throw std::invalid_argument("The window must contain at least one curve.");
+        }
+
+        Eigen::Matrix2d q;
+        q << 0, 1, -1, 2;
+        const MatrixXd & coefficient_matrix = cached_bezier_coefficients<double>(degree);
+        MatrixXd first_continuity_matrix = MatrixXd::Zero(2, degree + 1);
+        first_continuity_matrix.rightCols(2) = q;
+        MatrixXd continuity_matrix = MatrixXd::Zero(2, degree - 1);
+        continuity_matrix.rightCols(2) = q;
+
+        _first_r = coefficient_matrix;
+        _r = coefficient_matrix.rightCols(degree - 1);
+        _first_q = coefficient_matrix.leftCols(2) * first_continuity_matrix;
+        _q = coefficient_matrix.leftCols(2) * continuity_matrix;
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::add_point(const Vector & point){
+        push_point(point);
+        update();
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::add_points(const vector<Vector> & points){
+        long dimension = _dimension < 0 and !points.empty() ? points[0].rows() : _dimension;
+        for(const Vector & point : points){
+            if(point.rows() != dimension){
+                throw std::invalid_argument("All data points must have the same dimension.");
+            }
+        }
+        for(const Vector & point : points){
+            push_point(point);
+        }
+        if(!_solved){
+            update();
+        }
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> BasicOnlineCompositeFitter<Scalar>::curve() const {
+        if(!_frozen){
+            return window_curve();
+        }
+        unsigned int fitted = number_of_fitted_curves();
+        vector<unsigned int> degrees = _frozen->degrees();
+        degrees.insert(degrees.end(), fitted, _degree);
+        long fitted_columns = static_cast<long>(fitted) * _degree;
+        Matrix control_points(_dimension, _frozen->control_points().cols() + fitted_columns);
+        control_points.leftCols(_frozen->control_points().cols()) = _frozen->control_points();
+        control_points.rightCols(fitted_columns) = _control_points.rightCols(fitted_columns);
+        return BasicCompositeBezierCurve<Scalar>(std::move(control_points), degrees);
+    }
+
+    template <typename Scalar>
+    const BasicCompositeBezierCurve<Scalar> & BasicOnlineCompositeFitter<Scalar>::frozen_curve() const {
+        if(!_frozen){
+            throw std::logic_error("No Bezier curve has been frozen yet.");
+        }
+        return *_frozen;
+    }
+
+    template <typename Scalar>
+    BasicCompositeBezierCurve<Scalar> BasicOnlineCompositeFitter<Scalar>::window_curve() const {
+        unsigned int fitted = number_of_fitted_curves();
+        if(fitted == 0){
+            throw std::logic_error("Not enough data points to fit a Bezier curve yet.");
+        }
+        return BasicCompositeBezierCurve<Scalar>(_control_points, vector<unsigned int>(fitted, _degree));
+    }
+
+    template <typename Scalar>
+    unsigned int BasicOnlineCompositeFitter<Scalar>::number_of_frozen_curves() const {
+        return _frozen ? _frozen->number_of_curves() : 0;
+    }
+
+    template <typename Scalar>
+    unsigned int BasicOnlineCompositeFitter<Scalar>::number_of_fitted_curves() const {
+        return fitted_curves();
+    }
+
+    template <typename Scalar>
+    unsigned long BasicOnlineCompositeFitter<Scalar>::number_of_points() const {
+        return _number_of_points;
+    }
+
+    template <typename Scalar>
+    bool BasicOnlineCompositeFitter<Scalar>::first_is_free() const {
+        return !_frozen;
+    }
+
+    template <typename Scalar>
+    unsigned int BasicOnlineCompositeFitter<Scalar>::fitted_curves() const {
+        unsigned int fitted = static_cast<unsigned int>(_window.size());
+        if(fitted > 0){
+            unsigned int minimum = fitted == 1 and first_is_free() ? _degree + 1 : _degree - 1;
+            if(_window.back().number_of_points < minimum){
+                fitted--;
+            }
+        }
+        return fitted;
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::push_point(const Vector & point){
+        if(_dimension < 0){
+            if(point.rows() == 0){
+                throw std::invalid_argument("All data points must have the same dimension.");
+            }
+            _dimension = point.rows();
+        }
+        else if(point.rows() != _dimension){
+            throw std::invalid_argument("All data points must have the same dimension.");
+        }
+
+        if(_window.empty() or _window.back().number_of_points == _points_per_curve){
+            if(_window.size() == _window_size){
+                freeze();
+            }
+            _window.emplace_back();
+            _window.back().power_sums = VectorXd::Zero(2 * _degree + 1);
+            _window.back().weighted_sums = MatrixXd::Zero(_dimension, _degree + 1);
+        }
+
+        // accumulate the power sums of the chord length
+        WindowCurve & curve = _window.back();
+        VectorXd p = point.template cast<double>();
+        if(_number_of_points > 0){
+            curve.length += (p - _last_point).norm();
+        }
+        accumulate_power_sums(Eigen::Matrix<double, 1, 1>(curve.length), p, curve.power_sums, curve.weighted_sums);
+        curve.number_of_points++;
+        _last_point = p;
+        _number_of_points++;
+
+        // the blocks of the last curve and the one before it change
+        unsigned int last = static_cast<unsigned int>(_window.size()) - 1;
+        _first_dirty_block = std::min(_first_dirty_block, last == 0 ? 0 : last - 1);
+        _solved = false;
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::freeze(){
+        if(!_solved){
+            update();
+        }
+
+        vector<Vector> control_points;
+        for(unsigned int i = 0; i < _degree + 1; i++){
+            control_points.push_back(_control_points.col(i));
+        }
+        if(!_frozen){
+            _frozen.reset(new BasicCompositeBezierCurve<Scalar>(vector<vector<Vector>>(1, control_points)));
+        }
+        else{
+            _frozen->append_segment(control_points);
+        }
+        _window.pop_front();
+
+        // the first two control points of the window continue the frozen curve
+        VectorXd end = control_points[_degree].template cast<double>();
+        VectorXd before = control_points[_degree - 1].template cast<double>();
+        _first_control_points.resize(2, _dimension);
+        _first_control_points.row(0) = end.transpose();
+        _first_control_points.row(1) = (2 * end - before).transpose();
+        _fixed = cached_bezier_coefficients<double>(_degree).leftCols(2) * _first_control_points;
+
+        _first_dirty_block = 0;
+        _solved = false;
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::assemble(unsigned int block, unsigned int fitted_curves){
+        bool first_curve = block == 0 and first_is_free();
+        const MatrixXd & r = first_curve ? _first_r : _r;
+        const WindowCurve & curve = _window[block];
+
+        _diagonal[block] = r.transpose() * curve.normal_matrix * r;
+        if(block == 0 and !first_is_free()){
+            // move the frozen part of the first curve to the right hand side
+            _rhs[block] = r.transpose() * (curve.projection - curve.normal_matrix * _fixed);
+        }
+        else{
+            _rhs[block] = r.transpose() * curve.projection;
+        }
+
+        if(block + 1 < fitted_curves){
+            const MatrixXd & q = first_curve ? _first_q : _q;
+            const WindowCurve & next = _window[block + 1];
+            _diagonal[block] += q.transpose() * next.normal_matrix * q;
+            _rhs[block] += q.transpose() * next.projection;
+            _lower_diagonal[block] = _r.transpose() * next.normal_matrix * q;
+            _upper_diagonal[block] = q.transpose() * next.normal_matrix * _r;
+        }
+    }
+
+    template <typename Scalar>
+    void BasicOnlineCompositeFitter<Scalar>::update(){
+        unsigned int fitted = fitted_curves();
+        _solved = true;
+        if(fitted == 0){
+            _control_points.resize(_dimension, 0);
+            return;
+        }
+
+        // normal equations of the chord length parameterization t = s / length of the changed curves
+        for(unsigned int c = _first_dirty_block; c < fitted; c++){
+            WindowCurve & curve = _window[c];
+            double scale = curve.length > 0 ? 1 / curve.length : 0;
+            curve.normal_matrix.resize(_degree + 1, _degree + 1);
+            hankel_normal_matrix(curve.power_sums, scale, curve.normal_matrix);
+            curve.projection = curve.weighted_sums.transpose();
+            double power = 1;
+            for(unsigned int k = 0; k < _degree + 1; k++){
+                curve.projection.row(k) *= power;
+                power *= scale;
+            }
+        }
+
+        _diagonal.resize(fitted);
+        _rhs.resize(fitted);
+        _lower_diagonal.resize(fitted - 1);
+        _upper_diagonal.resize(fitted - 1);
+        for(unsigned int block = _first_dirty_block; block < fitted; block++){
+            assemble(block, fitted);
+        }
+        _first_dirty_block = fitted;
+
+        vector<MatrixXd> solution = solve_tridiagonal(_lower_diagonal, _diagonal, _upper_diagonal, _rhs);
+
+        // the first two control points of each curve continue the previous curve
+        _control_points.resize(_dimension, 1 + static_cast<long>(fitted) * _degree);
+        for(unsigned int c = 0; c < fitted; c++){
+            long column = static_cast<long>(c) * _degree;
+            if(c == 0 and first_is_free()){
+                _control_points.middleCols(column, _degree + 1) = solution[c].transpose().template cast<Scalar>();
+                continue;
+            }
+            if(c == 0){
+                _control_points.middleCols(column, 2) = _first_control_points.transpose().template cast<Scalar>();
+            }
+            else{
+                const MatrixXd & previous = solution[c - 1];
+                long last = previous.rows() - 1;
+                _control_points.col(column) = previous.row(last).transpose().template cast<Scalar>();
+                _control_points.col(column + 1) = (2 * previous.row(last) - previous.row(last - 1))
+                        .transpose().template cast<Scalar>();
+            }
+            _control_points.middleCols(column + 2, _degree - 1) = solution[c].transpose().template cast<Scalar>();
+        }
+    }
+
+    template class BasicOnlineCompositeFitter<double>;
+    template class BasicOnlineCompositeFitter<float>;
+}
@@ -5,12 +5,14 @@
 #include <bezier/curve.h>
 #include <bezier/bezier_curve.h>
 #include <bezier/composite_bezier_curve.h>
+#include <bezier/math/forward_difference.h>
 
 #include <bezier/postscript/postscript.h>
 
 using std::vector;
 using std::array;
 using Eigen::Vector2d;
+using Eigen::MatrixXd;
 
 namespace bezier {
     static const int n_samples = 50;
@@ -32,35 +34,55 @@ namespace bezier {
         auto bezier = dynamic_cast<const BezierCurve*>(curve);
         if(bezier != nullptr){
             _write_bezier_curve(ps_writer, show_control_points, *bezier);
+            return;
         }
 
         auto composite_bezier = dynamic_cast<const CompositeBezierCurve*>(curve);
         if(composite_bezier != nullptr){
-            for(const BezierCurve & b : composite_bezier->bezier_curves()){
-                _write_bezier_curve(ps_writer, show_control_points, b);
+            // write directly from the contiguous storage of the composite curve
+            for(const CompositeBezierCurve::Segment & segment : composite_bezier->segments()){
+                _write_bezier_curve(ps_writer, show_control_points, segment.control_points(),
+                                    segment.power_coefficients());
             }
+            return;
         }
+
+        // any other curve, e.g. a fixed size Bezier curve passed as a Curve
+        _write_with_samples(ps_writer, curve, n_samples);
     }
 
     void _write_bezier_curve(PostScriptWriter & ps_writer, bool show_control_points, const BezierCurve & bezier){
-        if(bezier.degree() == 1){
-            _write_line(ps_writer, bezier);
+        MatrixXd control_points(bezier.dimension(), bezier.degree() + 1);
+        for(int i = 0; i < bezier.degree() + 1; i++){
+            control_points.col(i) = bezier.control_points()[i];
+        }
+        _write_bezier_curve(ps_writer, show_control_points, control_points, bezier.power_coefficients());
+    }
+
+    void _write_bezier_curve(PostScriptWriter & ps_writer, bool show_control_points,
+                             const Eigen::Ref<const MatrixXd> & control_points,
+                             const Eigen::Ref<const MatrixXd> & power_coefficients){
+        long degree = control_points.cols() - 1;
+        if(degree == 1){
+            _write_line(ps_writer, control_points);
         }
-        else if(bezier.degree() == 3){
-            _write_cubic(ps_writer, bezier);
+        else if(degree == 3){
+            _write_cubic(ps_writer, control_points);
         }
         else {
-            _write_with_samples(ps_writer, &bezier, n_samples);
+            _write_polynomial(ps_writer, power_coefficients, n_samples);
         }
 
         if(show_control_points){
-            _write_control_points(ps_writer, bezier.control_points());
+            _write_control_points(ps_writer, control_points);
         }
     }
 
-    void _write_control_points(PostScriptWriter & ps_writer, const vector<VectorXd> & points){
-        vector<Vector2d> p(points.size());
-        std::copy(points.begin(), points.end(), p.begin());
+    void _write_control_points(PostScriptWriter & ps_writer, const Eigen::Ref<const MatrixXd> & points){
+        vector<Vector2d> p(points.cols());
+        for(long i = 0; i < points.cols(); i++){
+            p[i] = points.col(i);
+        }
         ps_writer.filled(true);
         ps_writer.circles(p, circle_radius);
         ps_writer.filled(false);
@@ -76,22 +98,33 @@ namespace bezier {
         ps_writer.polyline(p);
     }
 
-    void _write_line(PostScriptWriter & ps_writer, const BezierCurve & line){
-        if(line.degree() != 1){
+    void _write_polynomial(PostScriptWriter & ps_writer, const Eigen::Ref<const MatrixXd> & power_coefficients,
+                           int n_samples){
+        MatrixXd points(power_coefficients.rows(), n_samples);
+        forward_difference(power_coefficients, 0.0, 1.0 / (n_samples - 1), points);
+        vector<Vector2d> p(n_samples);
+        for(int i = 0; i < n_samples; i++){
+            p[i] = points.col(i);
+        }
+        ps_writer.polyline(p);
+    }
+
+    void _write_line(PostScriptWriter & ps_writer, const Eigen::Ref<const MatrixXd> & control_points){
+        if(control_points.cols() != 2){
             throw std::invalid_argument("Not a line!");
         }
-        ps_writer.line(line.control_points()[0], line.control_points()[1]);
+        ps_writer.line(control_points.col(0), control_points.col(1));
     }
 
-    void _write_cubic(PostScriptWriter & ps_writer, const BezierCurve & cubic){
-        if(cubic.degree() != 3){
+    void _write_cubic(PostScriptWriter & ps_writer, const Eigen::Ref<const MatrixXd> & control_points){
+        if(control_points.cols() != 4){
             throw std::invalid_argument("Not a cubic Bezier !");
         }
         array<Vector2d, 4> p;
-        p[0] = cubic.control_points()[0];
-        p[1] = cubic.control_points()[1];
-        p[2] = cubic.control_points()[2];
-        p[3] = cubic.control_points()[3];
+        p[0] = control_points.col(0);
+        p[1] = control_points.col(1);
+        p[2] = control_points.col(2);
+        p[3] = control_points.col(3);
 
         ps_writer.cubic(p);
     }
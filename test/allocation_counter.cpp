@@ -0,0 +1,15 @@
+#include "allocation_counter.h"
+
+#ifdef __GLIBC__
+bool count_allocations = false;
+long number_of_allocations = 0;
+
+extern "C" void * __libc_malloc(size_t size);
+
+extern "C" void * malloc(size_t size){
+    if(count_allocations){
+        number_of_allocations++;
+    }
+    return __libc_malloc(size);
+}
+#endif
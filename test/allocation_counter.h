@@ -0,0 +1,22 @@
+#ifndef BEZIER_TEST_ALLOCATION_COUNTER_H
+#define BEZIER_TEST_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+#ifdef __GLIBC__
+// count the heap allocations of the whole test binary, Eigen and operator new both end up in malloc,
+// see allocation_counter.cpp
+extern bool count_allocations;
+extern long number_of_allocations;
+
+template <typename F>
+long count_heap_allocations(F f){
+    number_of_allocations = 0;
+    count_allocations = true;
+    f();
+    count_allocations = false;
+    return number_of_allocations;
+}
+#endif
+
+#endif //BEZIER_TEST_ALLOCATION_COUNTER_H
@@ -1,6 +1,8 @@
 #include <catch/catch.hpp>
 
 
+#include <thread>
+
 #include <bezier/bezier_curve.h>
 
 using std::vector;
@@ -17,6 +19,51 @@ TEST_CASE("Bezier coefficients", "[coefficients]"){
                     3, -6,  3,  0,
                     -1,  3, -3,  1;
     REQUIRE(bezier::bezier_coefficients(3) == cubic_coeff);
+
+    SECTION("test domain"){
+        REQUIRE_THROWS_AS(bezier::bezier_coefficients(-1), std::domain_error);
+        REQUIRE_THROWS_AS(bezier::cached_bezier_coefficients(-1), std::domain_error);
+    }
+
+    SECTION("high degree"){
+        // the Bernstein polynomials sum to one, i.e. C * (1 1 ... 1)^T = (1 0 ... 0)^T
+        for(int degree : {12, 13, 20, 30}){
+            Eigen::VectorXd unit = Eigen::VectorXd::Zero(degree + 1);
+            unit(0) = 1;
+            REQUIRE(bezier::bezier_coefficients(degree) * Eigen::VectorXd::Ones(degree + 1) == unit);
+        }
+        REQUIRE(bezier::bezier_coefficients(20)(20, 10) == 184756);
+        REQUIRE(bezier::bezier_coefficients(20)(10, 0) == 184756);
+    }
+
+    SECTION("cache"){
+        const Eigen::MatrixXd & cached = bezier::cached_bezier_coefficients(3);
+        REQUIRE(cached == cubic_coeff);
+        REQUIRE(&cached == &bezier::cached_bezier_coefficients(3));
+        REQUIRE(bezier::cached_bezier_coefficients(70) == bezier::bezier_coefficients(70));
+        REQUIRE(&bezier::cached_bezier_coefficients(70) == &bezier::cached_bezier_coefficients(70));
+    }
+
+    SECTION("concurrent cache access"){
+        const int n_threads = 4;
+        vector<const Eigen::MatrixXd *> cached(n_threads * 32);
+        vector<std::thread> threads;
+        for (int i = 0; i < n_threads; ++i) {
+            threads.emplace_back([i, &cached](){
+                for (int degree = 0; degree < 32; ++degree) {
+                    cached[i * 32 + degree] = &bezier::cached_bezier_coefficients(degree + 32);
+                }
+            });
+        }
+        for(auto & thread : threads){
+            thread.join();
+        }
+        for (int i = 1; i < n_threads; ++i) {
+            for (int degree = 0; degree < 32; ++degree) {
+                REQUIRE(cached[i * 32 + degree] == cached[degree]);
+            }
+        }
+    }
 }
 
 TEST_CASE("Bezier curve construction", "[construction]"){
@@ -89,15 +136,376 @@ TEST_CASE("Bezier curve evaluation", "[evaluation]"){
         REQUIRE(curve(0.5) == Vector2d(-4, 7)/8);
         REQUIRE(curve(0.25) == Vector2d(34, 35)/64);
     }
+
+    SECTION("agrees with Bernstein form"){
+        vector<VectorXd> quintic_control_points = { Vector3d(1, -1, 2), Vector3d(1, 2, 0), Vector3d(-2, 1, 3),
+                                                    Vector3d(-2, -1, 1), Vector3d(4, 0, -3), Vector3d(0, 5, 1) };
+        bezier::BezierCurve quintic(quintic_control_points);
+        for(double t : {0.0, 0.1, 0.37, 0.5, 0.9, 1.0}){
+            VectorXd expected = VectorXd::Zero(3);
+            for (int i = 0; i < 6; ++i) {
+                double binomial = bezier::factorial(5) / (bezier::factorial(i) * bezier::factorial(5 - i));
+                expected += binomial * std::pow(t, i) * std::pow(1 - t, 5 - i) * quintic_control_points[i];
+            }
+            REQUIRE(quintic(t).isApprox(expected));
+        }
+        REQUIRE(quintic(1) == quintic_control_points[5]);
+    }
+}
+
+TEST_CASE("Bezier curve evaluation methods", "[evaluation]"){
+
+    vector<VectorXd> control_points = { Vector3d(1, -1, 2), Vector3d(1, 2, 0), Vector3d(-2, 1, 3),
+                                        Vector3d(-2, -1, 1), Vector3d(4, 0, -3), Vector3d(0, 5, 1) };
+    bezier::BezierCurve horner(control_points);
+    bezier::BezierCurve de_casteljau(control_points, bezier::EvaluationMethod::DeCasteljau);
+    bezier::BezierCurve bernstein(control_points, bezier::EvaluationMethod::Bernstein);
+
+    SECTION("selected method"){
+        REQUIRE(horner.evaluation_method() == bezier::EvaluationMethod::Horner);
+        REQUIRE(de_casteljau.evaluation_method() == bezier::EvaluationMethod::DeCasteljau);
+        bezier::BezierCurve curve(control_points);
+        curve.set_evaluation_method(bezier::EvaluationMethod::Bernstein);
+        REQUIRE(curve.evaluation_method() == bezier::EvaluationMethod::Bernstein);
+    }
+
+    SECTION("methods agree"){
+        for(double t : {0.0, 0.1, 0.37, 0.5, 0.9, 1.0}){
+            REQUIRE(de_casteljau(t).isApprox(horner(t)));
+            REQUIRE(bernstein(t).isApprox(horner(t)));
+        }
+        VectorXd ts = VectorXd::LinSpaced(11, 0, 1);
+        REQUIRE(de_casteljau.evaluate(ts).isApprox(horner.evaluate(ts)));
+        REQUIRE(bernstein.evaluate(ts).isApprox(horner.evaluate(ts)));
+        REQUIRE_THROWS_AS(de_casteljau(1.5), std::domain_error);
+        REQUIRE_THROWS_AS(bernstein(-0.5), std::domain_error);
+    }
+
+    SECTION("end points"){
+        REQUIRE(de_casteljau(0) == control_points[0]);
+        REQUIRE(de_casteljau(1) == control_points[5]);
+        REQUIRE(bernstein(0) == control_points[0]);
+        REQUIRE(bernstein(1) == control_points[5]);
+    }
+
+    SECTION("high degree"){
+        // a degree 20 curve with identical control points is constant
+        vector<VectorXd> constant(21, Vector2d(0.3, -0.7));
+        bezier::BezierCurve stable(constant, bezier::EvaluationMethod::DeCasteljau);
+        bezier::BezierCurve binomial(constant, bezier::EvaluationMethod::Bernstein);
+        for(double t : {0.1, 0.37, 0.5, 0.9}){
+            REQUIRE(stable(t).isApprox(Vector2d(0.3, -0.7), 1e-14));
+            REQUIRE(binomial(t).isApprox(Vector2d(0.3, -0.7), 1e-14));
+        }
+    }
+}
+
+TEST_CASE("Bezier curve batch evaluation", "[evaluation]"){
+
+    vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
+    bezier::BezierCurve cubic2d(control_points);
+
+    SECTION("test domain range"){
+        REQUIRE_THROWS_AS(cubic2d.evaluate(Eigen::Vector3d(0, -1, 0.5)), std::domain_error);
+        REQUIRE_THROWS_AS(cubic2d.evaluate(Eigen::Vector3d(0, 2, 0.5)), std::domain_error);
+        REQUIRE_NOTHROW(cubic2d.evaluate(VectorXd(0)));
+    }
+
+    SECTION("agrees with point evaluation"){
+        VectorXd ts = VectorXd::LinSpaced(11, 0, 1);
+        Eigen::MatrixXd points = cubic2d.evaluate(ts);
+        REQUIRE(points.rows() == 2);
+        REQUIRE(points.cols() == 11);
+        for (int j = 0; j < ts.rows(); ++j) {
+            REQUIRE(points.col(j).isApprox(cubic2d(ts(j))));
+        }
+        REQUIRE(points.col(5) == Vector2d(-4, 7)/8);
+    }
+}
+
+TEST_CASE("Bezier curve vectorized evaluation", "[evaluation]"){
+
+    vector<VectorXd> control_points = { Vector3d(1, -1, 2), Vector3d(1, 2, 0), Vector3d(-2, 1, 3), Vector3d(-2, -1, 1) };
+    bezier::BezierCurve cubic3d(control_points);
+
+    SECTION("invalid arguments"){
+        Eigen::MatrixXd points(3, 3);
+        REQUIRE_THROWS_AS(cubic3d.evaluate_vectorized(Vector3d(0, 0.5, 1), points.leftCols(2)), std::invalid_argument);
+        REQUIRE_THROWS_AS(cubic3d.evaluate_vectorized(Vector3d(0, 1.5, 1), points), std::domain_error);
+    }
+
+    SECTION("agrees with point evaluation"){
+        for(int n : {0, 1, 3, 4, 7, 8, 9, 17, 1001}){
+            VectorXd ts = VectorXd::LinSpaced(n, 0, 1);
+            Eigen::MatrixXd points(n, 3);
+            cubic3d.evaluate_vectorized(ts, points);
+            for (int j = 0; j < n; ++j) {
+                REQUIRE((points.row(j).transpose() - cubic3d(ts(j))).norm() < 1e-14);
+            }
+            if(n > 1){
+                REQUIRE(points.row(n-1).transpose() == control_points[3]);
+            }
+        }
+    }
+
+    SECTION("output into a block"){
+        VectorXd ts = VectorXd::LinSpaced(9, 0, 1);
+        Eigen::MatrixXd storage = Eigen::MatrixXd::Zero(12, 3);
+        cubic3d.evaluate_vectorized(ts, storage.middleRows(2, 9));
+        REQUIRE(storage.row(0) == Eigen::RowVector3d::Zero());
+        REQUIRE(storage.row(11) == Eigen::RowVector3d::Zero());
+        REQUIRE(storage.row(2).transpose() == control_points[0]);
+        REQUIRE(storage.row(10).transpose() == control_points[3]);
+    }
+}
+
+TEST_CASE("Bezier curve derivatives", "[derivative]"){
+
+    vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
+    bezier::BezierCurve cubic2d(control_points);
+
+    // parabola y = x^2 for x in [-1, 1]
+    bezier::BezierCurve parabola = { Vector2d(-1, 1), Vector2d(0, -1), Vector2d(1, 1) };
+
+    SECTION("test domain range"){
+        REQUIRE_THROWS_AS(cubic2d.derivative(-1), std::domain_error);
+        REQUIRE_THROWS_AS(cubic2d.derivative(Vector2d(0.5, 2)), std::domain_error);
+        REQUIRE_THROWS_AS(cubic2d.tangent(2), std::domain_error);
+        REQUIRE_THROWS_AS(cubic2d.curvature(-0.5), std::domain_error);
+    }
+
+    SECTION("end points"){
+        REQUIRE(cubic2d.derivative(0) == 3 * (control_points[1] - control_points[0]));
+        REQUIRE(cubic2d.derivative(1).isApprox(3 * (control_points[3] - control_points[2])));
+        REQUIRE(cubic2d.derivative(0, 2) == 6 * (control_points[2] - 2 * control_points[1] + control_points[0]));
+        REQUIRE(cubic2d.derivative(0.3, 0) == cubic2d(0.3));
+        REQUIRE(cubic2d.derivative(0.3, 4) == Vector2d(0, 0));
+    }
+
+    SECTION("finite differences"){
+        double h = 1e-6;
+        for(double t : {0.1, 0.5, 0.8}){
+            VectorXd central = (cubic2d(t + h) - cubic2d(t - h)) / (2 * h);
+            REQUIRE((cubic2d.derivative(t) - central).norm() < 1e-6);
+            VectorXd central2 = (cubic2d.derivative(t + h) - cubic2d.derivative(t - h)) / (2 * h);
+            REQUIRE((cubic2d.derivative(t, 2) - central2).norm() < 1e-6);
+        }
+    }
+
+    SECTION("tangent"){
+        REQUIRE(cubic2d.tangent(0).isApprox(Vector2d(0, 1)));
+        REQUIRE(parabola.tangent(0.5).isApprox(Vector2d(1, 0)));
+        REQUIRE(parabola.tangent(1).isApprox(Vector2d(1, 2).normalized()));
+
+        // vanishing first derivative at t = 0
+        bezier::BezierCurve cusp = { Vector2d(0, 0), Vector2d(0, 0), Vector2d(1, 1), Vector2d(2, 0) };
+        REQUIRE(cusp.tangent(0).isApprox(Vector2d(1, 1).normalized()));
+        bezier::BezierCurve constant = { Vector2d(1, 1), Vector2d(1, 1) };
+        REQUIRE(constant.tangent(0.5) == Vector2d(0, 0));
+    }
+
+    SECTION("curvature"){
+        for(double t : {0.0, 0.25, 0.5, 0.9}){
+            double x = 2 * t - 1;
+            REQUIRE(parabola.curvature(t) == Approx(2 / std::pow(1 + 4 * x * x, 1.5)));
+        }
+        bezier::BezierCurve line = { Vector3d(0, 0, 0), Vector3d(1, 2, 3) };
+        REQUIRE(line.curvature(0.5) == 0);
+        bezier::BezierCurve cusp = { Vector2d(0, 0), Vector2d(0, 0), Vector2d(1, 1), Vector2d(2, 0) };
+        REQUIRE(std::isinf(cusp.curvature(0)));
+    }
+
+    SECTION("batch"){
+        VectorXd ts = VectorXd::LinSpaced(9, 0, 1);
+        Eigen::MatrixXd first = cubic2d.derivative(ts);
+        Eigen::MatrixXd second = cubic2d.derivative(ts, 2);
+        Eigen::MatrixXd tangents = cubic2d.tangent(ts);
+        VectorXd curvatures = cubic2d.curvature(ts);
+        REQUIRE(cubic2d.derivative(ts, 0).isApprox(cubic2d.evaluate(ts)));
+        REQUIRE(cubic2d.derivative(ts, 5) == Eigen::MatrixXd::Zero(2, 9));
+        for (int j = 0; j < ts.rows(); ++j) {
+            REQUIRE(first.col(j).isApprox(cubic2d.derivative(ts(j))));
+            REQUIRE(second.col(j).isApprox(cubic2d.derivative(ts(j), 2)));
+            REQUIRE(tangents.col(j).isApprox(cubic2d.tangent(ts(j))));
+            REQUIRE(curvatures(j) == Approx(cubic2d.curvature(ts(j))));
+        }
+    }
 }
 
 TEST_CASE("Bezier curve bounds", "[bounds]"){
     vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
     bezier::BezierCurve cubic2d(control_points);
     std::array<VectorXd, 2> bounds = cubic2d.bounds();
+    // x is monotone, y has a maximum below the control point (1, 2)
     REQUIRE(bounds[0] == Vector2d(-2, -1));
-    REQUIRE(bounds[1] == Vector2d(1, 2));
+    REQUIRE(bounds[1](0) == 1);
+    REQUIRE(bounds[1](1) < 2);
+
+    SECTION("sub interval"){
+        REQUIRE_THROWS_AS(cubic2d.bounds(-0.1, 0.5), std::domain_error);
+        REQUIRE_THROWS_AS(cubic2d.bounds(0.6, 0.5), std::invalid_argument);
+        for(double t0 : {0.0, 0.1, 0.4, 0.9}){
+            for(double t1 : {t0, t0 + 0.05, 1.0}){
+                std::array<VectorXd, 2> sub_bounds = cubic2d.bounds(t0, t1);
+                VectorXd lower = cubic2d(t0), upper = cubic2d(t0);
+                for(int j = 0; j <= 1000; j++){
+                    VectorXd point = cubic2d(t0 + (t1 - t0) * j / 1000.0);
+                    lower = lower.cwiseMin(point);
+                    upper = upper.cwiseMax(point);
+                }
+                REQUIRE((sub_bounds[0].array() <= lower.array() + 1e-12).all());
+                REQUIRE((sub_bounds[1].array() >= upper.array() - 1e-12).all());
+                REQUIRE((sub_bounds[0] - lower).norm() < 1e-5);
+                REQUIRE((sub_bounds[1] - upper).norm() < 1e-5);
+            }
+        }
+    }
 }
 
+TEST_CASE("Bezier curve arc length", "[length]"){
+    // straight line with a non-constant speed
+    bezier::BezierCurve line = { Vector2d(0, 0), Vector2d(3, 4), Vector2d(3, 4), Vector2d(6, 8) };
+    REQUIRE(line.length() == Approx(10).epsilon(1e-12));
+    REQUIRE(line.length(0, 0.5) == Approx(5).epsilon(1e-12));
+    REQUIRE(line.param_at_length(5) == Approx(0.5).epsilon(1e-10));
 
+    SECTION("invalid arguments"){
+        REQUIRE_THROWS_AS(line.length(-0.1, 0.5), std::domain_error);
+        REQUIRE_THROWS_AS(line.length(0.5, 0.4), std::invalid_argument);
+        REQUIRE_THROWS_AS(line.param_at_length(-1), std::domain_error);
+        REQUIRE_THROWS_AS(line.param_at_length(10.1), std::domain_error);
+    }
 
+    SECTION("against a polyline"){
+        // the cusp at t = 0.5 has zero speed
+        for(const bezier::BezierCurve & curve : {bezier::BezierCurve({ Vector2d(1, -1), Vector2d(1, 2),
+                                                                       Vector2d(-2, 1), Vector2d(-2, -1) }),
+                                                 bezier::BezierCurve({ Vector2d(0, 0), Vector2d(1, 1),
+                                                                       Vector2d(0, 1), Vector2d(1, 0) })}){
+            double polyline = 0;
+            for(int j = 0; j < 100000; j++){
+                polyline += (curve((j + 1) / 100000.0) - curve(j / 100000.0)).norm();
+            }
+            REQUIRE(curve.length() == Approx(polyline).epsilon(1e-8));
+            double polygon = 0;
+            for(int j = 1; j < 4; j++){
+                polygon += (curve.control_points()[j] - curve.control_points()[j - 1]).norm();
+            }
+            REQUIRE(curve.length_error() > 0);
+            REQUIRE(curve.length_error() <= bezier::arc_length_tolerance * polygon);
+            REQUIRE(curve.length(0, 1) == Approx(curve.length()).epsilon(1e-14));
+            REQUIRE(curve.param_at_length(0) == 0);
+            REQUIRE(curve.param_at_length(curve.length()) == 1);
+
+            // param_at_length inverts length(0, t)
+            VectorXd ts = VectorXd::LinSpaced(101, 0, 1);
+            VectorXd lengths(ts.rows());
+            for(long j = 0; j < ts.rows(); j++){
+                lengths(j) = curve.length(0, ts(j));
+                REQUIRE(curve.param_at_length(lengths(j)) == Approx(ts(j)).margin(1e-9));
+            }
+            REQUIRE((curve.param_at_length(lengths) - ts).norm() < 1e-8);
+            REQUIRE(curve.length(0.2, 0.7) == Approx(lengths(70) - lengths(20)).epsilon(1e-12));
+        }
+    }
+
+    SECTION("copies share the table"){
+        bezier::BezierCurve copy = line;
+        REQUIRE(copy.length() == line.length());
+        bezier::BezierCurvef linef = { Eigen::Vector2f(0, 0), Eigen::Vector2f(3, 4), Eigen::Vector2f(3, 4),
+                                       Eigen::Vector2f(6, 8) };
+        REQUIRE(linef.length() == Approx(10.0f));
+        REQUIRE(linef.param_at_length(5.0f) == Approx(0.5f));
+    }
+}
+
+TEST_CASE("Bezier curve subdivision and degree change", "[subdivision]"){
+    bezier::BezierCurve cubic = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    VectorXd ts = VectorXd::LinSpaced(51, 0, 1);
+
+    SECTION("split"){
+        REQUIRE_THROWS_AS(cubic.split(1.5), std::domain_error);
+        std::array<bezier::BezierCurve, 2> parts = cubic.split(0.3);
+        REQUIRE(parts[0].degree() == 3);
+        REQUIRE(parts[0].control_points().front() == cubic.control_points().front());
+        REQUIRE(parts[0].control_points().back() == parts[1].control_points().front());
+        REQUIRE(parts[1].control_points().back() == cubic.control_points().back());
+        for(long j = 0; j < ts.rows(); j++){
+            REQUIRE((parts[0](ts(j)) - cubic(0.3 * ts(j))).norm() < 1e-14);
+            REQUIRE((parts[1](ts(j)) - cubic(0.3 + 0.7 * ts(j))).norm() < 1e-14);
+        }
+        REQUIRE(cubic.split(0)[1].control_points() == cubic.control_points());
+    }
+
+    SECTION("elevation"){
+        REQUIRE_THROWS_AS(cubic.elevate_degree(2), std::invalid_argument);
+        REQUIRE(cubic.elevate_degree(3).control_points() == cubic.control_points());
+        bezier::BezierCurve elevated = cubic.elevate_degree(7);
+        REQUIRE(elevated.degree() == 7);
+        REQUIRE(elevated.control_points().back() == cubic.control_points().back());
+        REQUIRE((elevated.evaluate(ts) - cubic.evaluate(ts)).norm() < 1e-13);
+        // a line elevated to a cubic has evenly spaced control points
+        bezier::BezierCurve line = bezier::BezierCurve({Vector2d(0, 0), Vector2d(3, 6)}).elevate_degree(3);
+        REQUIRE((line.control_points()[1] - Vector2d(1, 2)).norm() < 1e-15);
+        REQUIRE((line.control_points()[2] - Vector2d(2, 4)).norm() < 1e-15);
+    }
+
+    SECTION("reduction"){
+        REQUIRE_THROWS_AS(cubic.reduce_degree(-1), std::invalid_argument);
+        // an elevated curve is reduced back exactly
+        bezier::BezierCurve reduced = cubic.elevate_degree(6).reduce_degree(1e-10);
+        REQUIRE(reduced.degree() == 3);
+        REQUIRE((reduced.evaluate(ts) - cubic.evaluate(ts)).norm() < 1e-10);
+        // the cubic can not be reduced exactly, the error stays within the tolerance
+        REQUIRE(cubic.reduce_degree(1e-3).degree() == 3);
+        for(double tolerance : {1.5, 4.0}){
+            bezier::BezierCurve approximation = cubic.reduce_degree(tolerance);
+            REQUIRE(approximation.degree() < 3);
+            REQUIRE(approximation.control_points().front() == cubic.control_points().front());
+            REQUIRE(approximation.control_points().back() == cubic.control_points().back());
+            REQUIRE(((approximation.evaluate(ts) - cubic.evaluate(ts)).colwise().norm().array() <= tolerance).all());
+        }
+    }
+}
+
+TEST_CASE("Single precision Bezier curve", "[float]"){
+
+    vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
+    bezier::BezierCurve cubic2d(control_points);
+    bezier::BezierCurvef cubic2f = { Eigen::Vector2f(1, -1), Eigen::Vector2f(1, 2), Eigen::Vector2f(-2, 1),
+                                     Eigen::Vector2f(-2, -1) };
+
+    SECTION("properties"){
+        REQUIRE(cubic2f.degree() == 3);
+        REQUIRE(cubic2f.dimension() == 2);
+        REQUIRE(cubic2f.coefficient_matrix() == cubic2d.coefficient_matrix().cast<float>());
+        REQUIRE(&bezier::cached_bezier_coefficients<float>(3) == &bezier::cached_bezier_coefficients<float>(3));
+        REQUIRE_THROWS_AS(cubic2f(1.5f), std::domain_error);
+    }
+
+    SECTION("agrees with double precision"){
+        REQUIRE(cubic2f(0) == Eigen::Vector2f(1, -1));
+        REQUIRE(cubic2f(1) == Eigen::Vector2f(-2, -1));
+        for(bezier::EvaluationMethod method : {bezier::EvaluationMethod::Horner, bezier::EvaluationMethod::DeCasteljau,
+                                               bezier::EvaluationMethod::Bernstein}){
+            cubic2f.set_evaluation_method(method);
+            for(double t : {0.1, 0.25, 0.5, 0.9}){
+                REQUIRE((cubic2f(static_cast<float>(t)).cast<double>() - cubic2d(t)).norm() < 1e-5);
+            }
+        }
+        REQUIRE((cubic2f.derivative(0.3f, 2).cast<double>() - cubic2d.derivative(0.3, 2)).norm() < 1e-4);
+        REQUIRE(cubic2f.curvature(0.3f) == Approx(cubic2d.curvature(0.3)).epsilon(1e-5));
+    }
+
+    SECTION("batch"){
+        Eigen::VectorXf ts = Eigen::VectorXf::LinSpaced(37, 0, 1);
+        Eigen::MatrixXf points = cubic2f.evaluate(ts);
+        Eigen::MatrixXf soa_points(37, 2);
+        cubic2f.evaluate_vectorized(ts, soa_points);
+        for(long j = 0; j < ts.rows(); j++){
+            REQUIRE((points.col(j) - cubic2f(ts(j))).norm() < 1e-5);
+            REQUIRE((soa_points.row(j).transpose() - cubic2f(ts(j))).norm() < 1e-5);
+        }
+        REQUIRE(soa_points.row(36).transpose() == Eigen::Vector2f(-2, -1));
+    }
+}
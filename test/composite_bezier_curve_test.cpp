@@ -2,6 +2,9 @@
 
 
 #include <bezier/composite_bezier_curve.h>
+#include <bezier/math/roots.h>
+
+#include "allocation_counter.h"
 
 using Eigen::Vector2d;
 
@@ -28,6 +31,66 @@ TEST_CASE("Composite Bezier curve construction", "[construction]"){
     SECTION("dimension"){
         bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
         REQUIRE(composite.dimension() == 2);
+        REQUIRE_THROWS_AS(bezier::CompositeBezierCurve({cubic1.control_points(),
+                                                        {Vector2d(2, 3), Eigen::Vector3d(1, 1, 1)}}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::CompositeBezierCurve({cubic1.control_points(), {}}), std::invalid_argument);
+    }
+
+    SECTION("contiguous storage"){
+        bezier::BezierCurve quadratic = { Vector2d(1, 0), Vector2d(0, 0), Vector2d(1, 1) };
+        bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3, quadratic};
+        REQUIRE(composite.number_of_curves() == 4);
+        REQUIRE(composite.control_points().rows() == 2);
+        REQUIRE(composite.control_points().cols() == 12);
+        REQUIRE((composite.offsets() == std::vector<long>{0, 3, 6, 9}));
+        REQUIRE((composite.degrees() == std::vector<unsigned int>{3, 3, 3, 2}));
+        for(unsigned int i = 0; i < 4; i++){
+            REQUIRE(composite.offset(i) == composite.offsets()[i]);
+            REQUIRE(composite.degree(i) == composite.degrees()[i]);
+        }
+
+        std::vector<bezier::BezierCurve> bezier_curves = composite.bezier_curves();
+        std::vector<bezier::BezierCurve> expected = {cubic1, cubic2, cubic3, quadratic};
+        REQUIRE(bezier_curves.size() == 4);
+        for(unsigned int i = 0; i < 4; i++){
+            REQUIRE((bezier_curves[i].control_points() == expected[i].control_points()));
+            REQUIRE(composite.power_coefficients(i) == expected[i].power_coefficients());
+            for(unsigned int j = 0; j < expected[i].degree() + 1; j++){
+                REQUIRE(composite.control_points().col(composite.offsets()[i] + j) == expected[i].control_points()[j]);
+            }
+        }
+    }
+
+    SECTION("segment views"){
+        bezier::BezierCurve quadratic = { Vector2d(1, 0), Vector2d(0, 0), Vector2d(1, 1) };
+        bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3, quadratic};
+        std::vector<bezier::BezierCurve> expected = {cubic1, cubic2, cubic3, quadratic};
+
+        REQUIRE_THROWS_AS(composite.segment(4), std::out_of_range);
+        REQUIRE(composite.segments().size() == 4);
+
+        unsigned int i = 0;
+        for(const bezier::CompositeBezierCurve::Segment & segment : composite.segments()){
+            REQUIRE(segment.index() == i);
+            REQUIRE(segment.degree() == expected[i].degree());
+            REQUIRE(segment.dimension() == 2);
+            // the views refer to the storage of the composite curve
+            REQUIRE(segment.control_points().data() == composite.control_points().data() + 2 * composite.offsets()[i]);
+            REQUIRE(segment.power_coefficients() == expected[i].power_coefficients());
+            REQUIRE(&segment.coefficient_matrix() == &expected[i].coefficient_matrix());
+            for(unsigned int j = 0; j < segment.degree() + 1; j++){
+                REQUIRE(segment.control_points().col(j) == expected[i].control_points()[j]);
+            }
+            for(double t : {0.0, 0.3, 1.0}){
+                REQUIRE(segment(t).isApprox(expected[i](t)));
+            }
+            REQUIRE((segment.to_bezier_curve().control_points() == expected[i].control_points()));
+            i++;
+        }
+        REQUIRE(i == 4);
+        REQUIRE(composite.segments()[2].control_points() == composite.segment(2).control_points());
+        REQUIRE(&cubic1.control_points() == &cubic1.control_points());
     }
 }
 
@@ -62,17 +125,596 @@ TEST_CASE("Composite Bezier curve evaluation", "[evaluation]"){
     }
 }
 
+TEST_CASE("Composite Bezier curve sorted evaluation", "[evaluation]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve quadratic = { Vector2d(2, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve cubic3 = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0) };
+    Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(1001, 0, 1);
+
+    SECTION("invalid arguments"){
+        bezier::CompositeBezierCurve composite = {cubic1, quadratic, cubic3};
+        Eigen::MatrixXd points(3, 2), transposed(2, 3);
+        REQUIRE_THROWS_AS(composite.evaluate_sorted(Eigen::Vector3d(0, 0.5, 1), transposed), std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.evaluate_sorted(Eigen::Vector3d(0, 0.6, 0.5), points), std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.evaluate_sorted(Eigen::Vector3d(-0.1, 0.5, 1), points), std::domain_error);
+        REQUIRE_THROWS_AS(composite.evaluate_sorted(Eigen::Vector3d(0, 0.5, 1.1), points), std::domain_error);
+    }
+
+    SECTION("agrees with operator()"){
+        for(const std::vector<double> & knots : {std::vector<double>(), std::vector<double>({0, 0.1, 0.7, 1})}){
+            bezier::CompositeBezierCurve composite({cubic1, quadratic, cubic3}, knots);
+            Eigen::MatrixXd points(ts.rows(), 2);
+            composite.evaluate_sorted(ts, points);
+            for(long j = 0; j < ts.rows(); j++){
+                REQUIRE((points.row(j).transpose() - composite(ts(j))).norm() < 1e-12);
+            }
+            REQUIRE(points.row(ts.rows() - 1).transpose() == composite(1));
+        }
+    }
+
+    SECTION("repeated parameters and single precision"){
+        std::vector<std::vector<Eigen::VectorXf>> control_points;
+        for(const bezier::BezierCurve & curve : {cubic1, quadratic, cubic3}){
+            std::vector<Eigen::VectorXf> points;
+            for(const Eigen::VectorXd & point : curve.control_points()){
+                points.push_back(point.cast<float>());
+            }
+            control_points.push_back(points);
+        }
+        bezier::CompositeBezierCurvef compositef(control_points);
+        Eigen::VectorXf tsf(600);
+        tsf << Eigen::VectorXf::Zero(300), Eigen::VectorXf::LinSpaced(299, 0, 1), 1;
+        Eigen::MatrixXf points(600, 2);
+        compositef.evaluate_sorted(tsf, points);
+        for(long j = 0; j < tsf.rows(); j++){
+            REQUIRE((points.row(j).transpose() - compositef(tsf(j))).norm() < 1e-5);
+        }
+        REQUIRE(points.row(599).transpose() == Eigen::Vector2f(1, 0));
+    }
+}
+
+TEST_CASE("Composite Bezier curve derivatives", "[derivative]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve cubic3 = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0) };
+    bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
+
+    SECTION("test domain range"){
+        REQUIRE_THROWS_AS(composite.derivative(-1), std::domain_error);
+        REQUIRE_THROWS_AS(composite.tangent(2), std::domain_error);
+        REQUIRE_THROWS_AS(composite.curvature(2), std::domain_error);
+    }
+
+    SECTION("chain rule"){
+        REQUIRE(composite.derivative(0).isApprox(3 * cubic1.derivative(0)));
+        REQUIRE(composite.derivative(0.5).isApprox(3 * cubic2.derivative(0.5)));
+        REQUIRE(composite.derivative(0.5, 2).isApprox(9 * cubic2.derivative(0.5, 2)));
+        REQUIRE(composite.derivative(1).isApprox(3 * cubic3.derivative(1)));
+        REQUIRE(composite.derivative(0.5, 0) == composite(0.5));
+    }
+
+    SECTION("tangent and curvature"){
+        REQUIRE(composite.tangent(0.5).isApprox(cubic2.tangent(0.5)));
+        REQUIRE(composite.curvature(0.5) == Approx(cubic2.curvature(0.5)));
+        REQUIRE(composite.tangent(1).isApprox(cubic3.tangent(1)));
+    }
+
+    SECTION("batch"){
+        Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(10, 0, 1);
+        Eigen::MatrixXd derivatives = composite.derivative(ts, 2);
+        Eigen::MatrixXd tangents = composite.tangent(ts);
+        Eigen::VectorXd curvatures = composite.curvature(ts);
+        for (int j = 0; j < ts.rows(); ++j) {
+            REQUIRE(derivatives.col(j) == composite.derivative(ts(j), 2));
+            REQUIRE(tangents.col(j) == composite.tangent(ts(j)));
+            REQUIRE(curvatures(j) == composite.curvature(ts(j)));
+        }
+    }
+}
+
 TEST_CASE("Composite Bezier curve bounds", "[bounds]") {
     bezier::BezierCurve cubic1 = {Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3)};
     bezier::BezierCurve cubic2 = {Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1)};
     bezier::BezierCurve cubic3 = {Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0)};
     bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
-    std::array<Eigen::VectorXd, 2> bounds = composite.bounds();
 
-    REQUIRE(bounds[0] == Vector2d(-2, -3));
-    REQUIRE(bounds[1] == Vector2d(4, 10));
+    // sampled bounds on [t0, t1], the joints are sampled since the curve has corners there
+    auto sampled_bounds = [&composite](double t0, double t1){
+        std::vector<double> ts = {1 / 3.0, 2 / 3.0};
+        for(int j = 0; j <= 3000; j++){
+            ts.push_back(t0 + (t1 - t0) * j / 3000.0);
+        }
+        std::array<Eigen::VectorXd, 2> bounds = {composite(t0), composite(t0)};
+        for(double t : ts){
+            if(t >= t0 and t <= t1){
+                bounds[0] = bounds[0].cwiseMin(composite(t));
+                bounds[1] = bounds[1].cwiseMax(composite(t));
+            }
+        }
+        return bounds;
+    };
+
+    SECTION("whole curve"){
+        std::array<Eigen::VectorXd, 2> bounds = composite.bounds();
+        std::array<Eigen::VectorXd, 2> expected = sampled_bounds(0, 1);
+        REQUIRE((bounds[0] - expected[0]).norm() < 1e-5);
+        REQUIRE((bounds[1] - expected[1]).norm() < 1e-5);
+        // tighter than the control points
+        REQUIRE((bounds[0].array() > Eigen::Array2d(-2, -3)).all());
+        REQUIRE((bounds[1].array() < Eigen::Array2d(4, 10)).all());
+
+        for(const bezier::CompositeBezierCurve::Segment & segment : composite.segments()){
+            std::array<Eigen::VectorXd, 2> segment_bounds = segment.bounds();
+            std::array<Eigen::VectorXd, 2> curve_bounds = segment.to_bezier_curve().bounds();
+            REQUIRE(segment_bounds[0].isApprox(curve_bounds[0]));
+            REQUIRE(segment_bounds[1].isApprox(curve_bounds[1]));
+        }
+    }
+
+    SECTION("sub interval"){
+        REQUIRE_THROWS_AS(composite.bounds(0.5, 1.1), std::domain_error);
+        REQUIRE_THROWS_AS(composite.bounds(0.5, 0.4), std::invalid_argument);
+        for(double t0 : {0.0, 0.2, 1 / 3.0, 0.5}){
+            for(double t1 : {t0, t0 + 0.1, 2 / 3.0 + 0.01, 1.0}){
+                std::array<Eigen::VectorXd, 2> bounds = composite.bounds(t0, t1);
+                std::array<Eigen::VectorXd, 2> expected = sampled_bounds(t0, t1);
+                REQUIRE((bounds[0].array() <= expected[0].array() + 1e-12).all());
+                REQUIRE((bounds[1].array() >= expected[1].array() - 1e-12).all());
+                REQUIRE((bounds[0] - expected[0]).norm() < 1e-5);
+                REQUIRE((bounds[1] - expected[1]).norm() < 1e-5);
+            }
+        }
+        REQUIRE(composite.bounds(0, 1) == composite.bounds());
+    }
+}
+
+TEST_CASE("Composite Bezier curve arc length", "[length]"){
+    bezier::BezierCurve cubic1 = {Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3)};
+    bezier::BezierCurve cubic2 = {Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1)};
+    bezier::BezierCurve cubic3 = {Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0)};
+    double length = cubic1.length() + cubic2.length() + cubic3.length();
+
+    SECTION("invalid arguments"){
+        bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
+        REQUIRE_THROWS_AS(composite.length(0, 1.5), std::domain_error);
+        REQUIRE_THROWS_AS(composite.length(0.6, 0.5), std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.param_at_length(-1), std::domain_error);
+        REQUIRE_THROWS_AS(composite.param_at_length(2 * length), std::domain_error);
+    }
+
+    for(const std::vector<double> & knots : {std::vector<double>(), std::vector<double>({0, 1, 3, 3.5})}){
+        bezier::CompositeBezierCurve composite({cubic1, cubic2, cubic3}, knots);
+        REQUIRE(composite.length() == Approx(length).epsilon(1e-12));
+        REQUIRE(composite.length_error() == Approx(cubic1.length_error() + cubic2.length_error() +
+                                                   cubic3.length_error()));
+        REQUIRE(composite.length(0, composite.knots()[1]) == Approx(cubic1.length()).epsilon(1e-12));
+        REQUIRE(composite.length(composite.knots()[1], composite.knots()[2]) == Approx(cubic2.length()).epsilon(1e-12));
+        REQUIRE(composite.param_at_length(cubic1.length()) == Approx(composite.knots()[1]).epsilon(1e-12));
+        REQUIRE(composite.param_at_length(0) == 0);
+        REQUIRE(composite.param_at_length(composite.length()) == 1);
+
+        Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(301, 0, 1);
+        Eigen::VectorXd lengths(ts.rows());
+        for(long j = 0; j < ts.rows(); j++){
+            lengths(j) = composite.length(0, ts(j));
+        }
+        REQUIRE((composite.param_at_length(lengths) - ts).norm() < 1e-8);
+        // constant speed traversal
+        Eigen::VectorXd params = composite.param_at_length(Eigen::VectorXd::LinSpaced(101, 0, composite.length()));
+        for(long j = 0; j < 100; j++){
+            REQUIRE(composite.length(params(j), params(j + 1)) == Approx(composite.length() / 100).epsilon(1e-8));
+        }
+    }
+
+    SECTION("streaming"){
+        bezier::CompositeBezierCurve composite = {cubic1};
+        REQUIRE(composite.length() == Approx(cubic1.length()));
+        bezier::CompositeBezierCurve copy = composite;
+        composite.set_max_number_of_curves(2);
+        composite.append_segment(cubic2.control_points());
+        REQUIRE(composite.length() == Approx(cubic1.length() + cubic2.length()).epsilon(1e-12));
+        composite.append_segment(cubic3.control_points());
+        REQUIRE(composite.length() == Approx(cubic2.length() + cubic3.length()).epsilon(1e-12));
+        REQUIRE(composite.length_error() == Approx(cubic2.length_error() + cubic3.length_error()));
+        REQUIRE(composite.param_at_length(cubic2.length()) == Approx(0.5).epsilon(1e-12));
+        // the copy is unaffected
+        REQUIRE(copy.length() == Approx(cubic1.length()));
+        for(int i = 0; i < 100; i++){
+            composite.append_segment(i % 2 == 0 ? std::vector<Eigen::VectorXd>({Vector2d(1, 0), Vector2d(-1, -1)})
+                                                : std::vector<Eigen::VectorXd>({Vector2d(-1, -1), Vector2d(1, 0)}));
+        }
+        REQUIRE(composite.length() == Approx(2 * std::sqrt(5)).epsilon(1e-12));
+        REQUIRE(composite.param_at_length(std::sqrt(5) / 2) == Approx(0.25).epsilon(1e-12));
+    }
+}
+
+TEST_CASE("Composite Bezier curve projection", "[project]"){
+    bezier::BezierCurve cubic1 = {Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3)};
+    bezier::BezierCurve cubic2 = {Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1)};
+    bezier::BezierCurve cubic3 = {Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0)};
+    bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
+
+    REQUIRE_THROWS_AS(composite.project(Eigen::MatrixXd::Zero(3, 2)), std::invalid_argument);
+    REQUIRE(composite.project(Eigen::MatrixXd(2, 0)).empty());
+
+    // grid of points around the curve
+    Eigen::MatrixXd points(2, 41 * 41);
+    for(int i = 0; i < 41; i++){
+        for(int j = 0; j < 41; j++){
+            points.col(41 * i + j) = Vector2d(-4 + 0.25 * i, -5 + 0.4 * j);
+        }
+    }
+
+    SECTION("closest point"){
+        std::vector<bezier::CompositeBezierCurve::Projection> projections = composite.project(points, 4);
+        REQUIRE(projections.size() == points.cols());
+        Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(3001, 0, 1);
+        Eigen::MatrixXd samples(2, ts.rows());
+        composite.evaluate_into(ts, samples);
+        for(long j = 0; j < points.cols(); j++){
+            const bezier::CompositeBezierCurve::Projection & projection = projections[j];
+            REQUIRE(projection.segment < 3);
+            REQUIRE(projection.t >= 0);
+            REQUIRE(projection.t <= 1);
+            REQUIRE((composite.segment(projection.segment)(projection.t) - points.col(j)).norm()
+                    == Approx(projection.distance).margin(1e-12));
+            // no sampled point is closer
+            double sampled = (samples.colwise() - points.col(j)).colwise().norm().minCoeff();
+            REQUIRE(projection.distance <= sampled + 1e-12);
+            REQUIRE(projection.distance >= sampled - 1e-2);
+        }
+    }
+
+    SECTION("points on the curve"){
+        Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(31, 0, 1);
+        Eigen::MatrixXd samples(2, ts.rows());
+        composite.evaluate_into(ts, samples);
+        std::vector<bezier::CompositeBezierCurve::Projection> projections = composite.project(samples);
+        for(long j = 0; j < ts.rows(); j++){
+            REQUIRE(projections[j].distance == Approx(0).margin(1e-6));
+        }
+        REQUIRE(projections[15].segment == 1);
+        REQUIRE(projections[15].t == Approx(0.5).epsilon(1e-8));
+    }
+
+    SECTION("threads"){
+        std::vector<bezier::CompositeBezierCurve::Projection> serial = composite.project(points, 1);
+        std::vector<bezier::CompositeBezierCurve::Projection> parallel = composite.project(points, 8);
+        for(long j = 0; j < points.cols(); j++){
+            REQUIRE(serial[j].segment == parallel[j].segment);
+            REQUIRE(serial[j].t == parallel[j].t);
+            REQUIRE(serial[j].distance == parallel[j].distance);
+        }
+    }
+
+    SECTION("streaming"){
+        // the hierarchy is rebuilt after segments are removed or added
+        composite.project(points);
+        composite.pop_front_segment();
+        composite.append_segment({Vector2d(1, 0), Vector2d(3, 2), Vector2d(4, -2)});
+        std::vector<bezier::CompositeBezierCurve::Projection> projections = composite.project(points);
+        for(long j = 0; j < points.cols(); j++){
+            double expected = std::numeric_limits<double>::infinity();
+            for(auto segment : composite.segments()){
+                expected = std::min(expected, bezier::closest_point(segment.power_coefficients(), points.col(j)).second);
+            }
+            REQUIRE(projections[j].distance == Approx(std::sqrt(expected)).epsilon(1e-12));
+        }
+    }
+
+    SECTION("single precision"){
+        bezier::CompositeBezierCurvef compositef(Eigen::MatrixXf(composite.control_points().cast<float>()),
+                                                 std::vector<unsigned int>({3, 3, 3}));
+        std::vector<bezier::CompositeBezierCurvef::Projection> projections = compositef.project(points.cast<float>());
+        std::vector<bezier::CompositeBezierCurve::Projection> expected = composite.project(points);
+        for(long j = 0; j < points.cols(); j++){
+            REQUIRE(projections[j].distance == Approx(expected[j].distance).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Composite Bezier curve subdivision and degree change", "[subdivision]"){
+    bezier::BezierCurve cubic1 = {Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3)};
+    bezier::BezierCurve line = {Vector2d(2, 3), Vector2d(-1, -1)};
+    bezier::BezierCurve quadratic = {Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(1, 0)};
+    Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(101, 0, 1);
+
+    for(const std::vector<double> & knots : {std::vector<double>(), std::vector<double>({0, 1, 3, 3.5})}){
+        bezier::CompositeBezierCurve composite({cubic1, line, quadratic}, knots);
+
+        SECTION("split"){
+            REQUIRE_THROWS_AS(composite.split(0), std::domain_error);
+            REQUIRE_THROWS_AS(composite.split(1), std::domain_error);
+            std::vector<double> ks = composite.knots();
+            // inside a Bezier curve and at a joint
+            for(double t : {0.5 * (ks[1] + ks[2]), ks[2], 0.1}){
+                std::array<bezier::CompositeBezierCurve, 2> parts = composite.split(t);
+                REQUIRE(parts[0].control_points().rightCols(1) == parts[1].control_points().leftCols(1));
+                REQUIRE(parts[0].number_of_curves() + parts[1].number_of_curves()
+                        == composite.number_of_curves() + (t == ks[2] ? 0 : 1));
+                for(long j = 0; j < ts.rows(); j++){
+                    REQUIRE((parts[0](ts(j)) - composite(t * ts(j))).norm() < 1e-12);
+                    REQUIRE((parts[1](ts(j)) - composite(t + (1 - t) * ts(j))).norm() < 1e-12);
+                }
+            }
+        }
+
+        SECTION("elevation"){
+            REQUIRE_THROWS_AS(composite.elevate_degree(2), std::invalid_argument);
+            bezier::CompositeBezierCurve elevated = composite.elevate_degree(3);
+            REQUIRE(elevated.degrees() == std::vector<unsigned int>({3, 3, 3}));
+            REQUIRE(elevated.knots() == composite.knots());
+            for(long j = 0; j < ts.rows(); j++){
+                REQUIRE((elevated(ts(j)) - composite(ts(j))).norm() < 1e-13);
+            }
+        }
+
+        SECTION("reduction"){
+            bezier::CompositeBezierCurve reduced = composite.elevate_degree(5).reduce_degree(1e-10);
+            REQUIRE(reduced.degrees() == std::vector<unsigned int>({3, 1, 2}));
+            REQUIRE(reduced.knots() == composite.knots());
+            for(long j = 0; j < ts.rows(); j++){
+                REQUIRE((reduced(ts(j)) - composite(ts(j))).norm() < 1e-10);
+            }
+            bezier::CompositeBezierCurve lines = composite.reduce_degree(100);
+            REQUIRE(lines.degrees() == std::vector<unsigned int>({1, 1, 1}));
+            REQUIRE(lines(composite.knots()[2]) == composite(composite.knots()[2]));
+        }
+    }
+
+    SECTION("streaming"){
+        bezier::CompositeBezierCurve composite = {cubic1, line, quadratic};
+        composite.pop_front_segment();
+        bezier::CompositeBezierCurve elevated = composite.elevate_degree(2);
+        REQUIRE(elevated.number_of_curves() == 2);
+        REQUIRE((elevated(0.25) - composite(0.25)).norm() < 1e-14);
+        std::array<bezier::CompositeBezierCurve, 2> parts = composite.split(0.5);
+        REQUIRE(parts[0].number_of_curves() == 1);
+        REQUIRE(parts[1].degrees() == std::vector<unsigned int>({2}));
+        for(int j = 0; j < 3; j++){
+            REQUIRE(parts[1].control_points().col(j) == quadratic.control_points()[j]);
+        }
+    }
+}
+
+TEST_CASE("Single precision composite Bezier curve", "[float]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::CompositeBezierCurve composite = {cubic1, cubic2};
+
+    bezier::BezierCurvef cubic1f = { Eigen::Vector2f(1, -1), Eigen::Vector2f(-1, 3), Eigen::Vector2f(1, 2),
+                                     Eigen::Vector2f(2, 3) };
+    bezier::BezierCurvef cubic2f = { Eigen::Vector2f(2, 3), Eigen::Vector2f(-1, 3), Eigen::Vector2f(4, 10),
+                                     Eigen::Vector2f(-1, -1) };
+    bezier::CompositeBezierCurvef compositef = {cubic1f, cubic2f};
+
+    REQUIRE(compositef.dimension() == 2);
+    REQUIRE(compositef(0) == Eigen::Vector2f(1, -1));
+    REQUIRE(compositef(1) == Eigen::Vector2f(-1, -1));
+    for(double t : {0.1, 0.3, 0.5, 0.75}){
+        REQUIRE((compositef(static_cast<float>(t)).cast<double>() - composite(t)).norm() < 1e-5);
+        REQUIRE((compositef.derivative(static_cast<float>(t)).cast<double>() - composite.derivative(t)).norm() < 1e-4);
+    }
+    std::array<Eigen::VectorXf, 2> bounds = compositef.bounds();
+    std::array<Eigen::VectorXd, 2> expected = composite.bounds();
+    REQUIRE((bounds[0].cast<double>() - expected[0]).norm() < 1e-5);
+    REQUIRE((bounds[1].cast<double>() - expected[1]).norm() < 1e-5);
+}
+
+TEST_CASE("Composite Bezier curve knots", "[knots]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve cubic3 = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0) };
+
+    SECTION("invalid knots"){
+        REQUIRE_THROWS_AS(bezier::CompositeBezierCurve({cubic1, cubic2, cubic3}, {0, 0.5, 1}), std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::CompositeBezierCurve({cubic1, cubic2, cubic3}, {0, 0.5, 0.5, 1}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::CompositeBezierCurve({cubic1, cubic2, cubic3}, {0, 0.75, 0.5, 1}),
+                          std::invalid_argument);
+    }
+
+    SECTION("uniform knots"){
+        bezier::CompositeBezierCurve composite = {cubic1, cubic2, cubic3};
+        REQUIRE(composite.has_uniform_knots());
+        REQUIRE(composite.knots() == std::vector<double>({0, 1 / 3.0, 2 / 3.0, 1}));
+    }
+
+    SECTION("non-uniform knots"){
+        // the knots are rescaled to [0, 1]
+        bezier::CompositeBezierCurve composite({cubic1, cubic2, cubic3}, {2, 4, 5, 6});
+        REQUIRE(!composite.has_uniform_knots());
+        REQUIRE(composite.knots() == std::vector<double>({0, 0.5, 0.75, 1}));
+        for(unsigned int i = 0; i < 4; i++){
+            REQUIRE(composite.knot(i) == composite.knots()[i]);
+        }
+
+        REQUIRE(composite.local_param(0.25) == std::make_pair(0, 0.5));
+        REQUIRE(composite.local_param(0.5) == std::make_pair(1, 0.0));
+        REQUIRE(composite.local_param(1) == std::make_pair(2, 1.0));
+
+        REQUIRE(composite(0) == cubic1(0));
+        REQUIRE(composite(0.25).isApprox(cubic1(0.5)));
+        REQUIRE(composite(0.625).isApprox(cubic2(0.5)));
+        REQUIRE(composite(1) == cubic3(1));
+
+        // chain rule, the local parameter is (t - k_i) / (k_(i+1) - k_i)
+        REQUIRE(composite.derivative(0.25).isApprox(2 * cubic1.derivative(0.5)));
+        REQUIRE(composite.derivative(0.625).isApprox(4 * cubic2.derivative(0.5)));
+        REQUIRE(composite.derivative(0.875, 2).isApprox(16 * cubic3.derivative(0.5, 2)));
+    }
+
+    SECTION("segment lookup"){
+        // enough curves to use the bucketed lookup
+        std::vector<std::vector<Eigen::VectorXd>> control_points;
+        std::vector<double> knots = {0};
+        Eigen::VectorXd point = Vector2d(0, 0);
+        srand(1);
+        for(int i = 0; i < 200; i++){
+            std::vector<Eigen::VectorXd> curve = {point, point + Vector2d::Random(), point + Vector2d::Random()};
+            point = curve.back();
+            control_points.push_back(curve);
+            knots.push_back(knots.back() + 0.01 + std::pow(rand() / (double) RAND_MAX, 4));
+        }
+        bezier::CompositeBezierCurve composite(control_points, knots);
+
+        for(int j = 0; j < 2000; j++){
+            double t = j / 1999.0;
+            int expected = 0;
+            while(expected < 199 and composite.knots()[expected + 1] <= t){
+                expected++;
+            }
+            REQUIRE(composite.local_param(t).first == expected);
+            REQUIRE(composite.local_param(t).second >= 0);
+            REQUIRE(composite.local_param(t).second <= 1);
+        }
+
+        std::vector<Eigen::VectorXd> samples = bezier::sample(&composite, 501);
+        for(int j = 0; j < 501; j++){
+            REQUIRE(samples[j].isApprox(composite(j / 500.0), 1e-9));
+        }
+    }
+}
+
+TEST_CASE("Composite Bezier curve streaming", "[streaming]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve cubic3 = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0) };
+
+    // compares against a composite curve constructed from the same curves
+    auto require_equal = [](const bezier::CompositeBezierCurve & composite,
+                            const bezier::CompositeBezierCurve & expected){
+        REQUIRE(composite.number_of_curves() == expected.number_of_curves());
+        REQUIRE(composite.control_points() == expected.control_points());
+        REQUIRE(composite.degrees() == expected.degrees());
+        REQUIRE(composite.offsets() == expected.offsets());
+        REQUIRE(composite.bounds() == expected.bounds());
+        std::vector<double> knots = composite.knots();
+        std::vector<double> expected_knots = expected.knots();
+        for(int i = 0; i < knots.size(); i++){
+            REQUIRE(knots[i] == Approx(expected_knots[i]));
+            REQUIRE(composite.knot(i) == knots[i]);
+        }
+        for(unsigned int i = 0; i < composite.number_of_curves(); i++){
+            REQUIRE(composite.offset(i) == expected.offset(i));
+            REQUIRE(composite.degree(i) == expected.degree(i));
+        }
+        for(int j = 0; j < 101; j++){
+            REQUIRE(composite(j / 100.0).isApprox(expected(j / 100.0), 1e-12));
+        }
+    };
+
+    SECTION("invalid arguments"){
+        bezier::CompositeBezierCurve composite = {cubic1, cubic2};
+        // not continuous
+        REQUIRE_THROWS_AS(composite.append_segment(cubic2.control_points()), std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.append_segment({Eigen::Vector3d(-1, -1, 0), Eigen::Vector3d(0, 0, 0)}),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.append_segment({}), std::invalid_argument);
+        // the knot span is only given for non-uniform knots
+        REQUIRE_THROWS_AS(composite.append_segment(cubic3.control_points(), 1), std::invalid_argument);
+        bezier::CompositeBezierCurve non_uniform({cubic1, cubic2}, std::vector<double>({0, 1, 3}));
+        REQUIRE_THROWS_AS(non_uniform.append_segment(cubic3.control_points()), std::invalid_argument);
+        REQUIRE_THROWS_AS(non_uniform.append_segment(cubic3.control_points(), 0), std::invalid_argument);
+        // the composite curve is unchanged
+        require_equal(composite, {cubic1, cubic2});
+        require_equal(non_uniform, bezier::CompositeBezierCurve({cubic1, cubic2}, std::vector<double>({0, 1, 3})));
+
+        composite.pop_front_segment();
+        REQUIRE_THROWS_AS(composite.pop_front_segment(), std::invalid_argument);
+    }
+
+    SECTION("append and remove"){
+        bezier::CompositeBezierCurve composite = {cubic1};
+        composite.append_segment(cubic2.control_points());
+        composite.append_segment(cubic3.control_points());
+        require_equal(composite, {cubic1, cubic2, cubic3});
+        composite.pop_front_segment();
+        require_equal(composite, {cubic2, cubic3});
+        composite.pop_front_segment();
+        require_equal(composite, {cubic3});
+
+        bezier::CompositeBezierCurve non_uniform({cubic1}, {1, 3});
+        non_uniform.append_segment(cubic2.control_points(), 1);
+        non_uniform.append_segment(cubic3.control_points(), 4);
+        require_equal(non_uniform, bezier::CompositeBezierCurve({cubic1, cubic2, cubic3}, {0, 2, 3, 7}));
+        non_uniform.pop_front_segment();
+        require_equal(non_uniform, bezier::CompositeBezierCurve({cubic2, cubic3}, std::vector<double>({0, 1, 5})));
+    }
+
+    SECTION("sliding window"){
+        // random curves of varying degree appended to a window of at most 100 curves
+        std::vector<std::vector<Eigen::VectorXd>> curves;
+        std::vector<double> knots = {0};
+        Eigen::VectorXd point = Vector2d(0, 0);
+        srand(2);
+        for(int i = 0; i < 1000; i++){
+            std::vector<Eigen::VectorXd> curve = {point};
+            for(int j = 0; j < 1 + i % 4; j++){
+                curve.push_back(curve.back() + Vector2d::Random());
+            }
+            point = curve.back();
+            curves.push_back(curve);
+            knots.push_back(knots.back() + 0.01 + rand() / (double) RAND_MAX);
+        }
+
+        bezier::CompositeBezierCurve composite({curves[0]}, {knots[0], knots[1]});
+        composite.set_max_number_of_curves(100);
+        REQUIRE(composite.max_number_of_curves() == 100);
+        for(int i = 1; i < 1000; i++){
+            composite.append_segment(curves[i], knots[i + 1] - knots[i]);
+            if(i % 97 == 0 or i == 999){
+                int first = std::max(0, i - 99);
+                std::vector<std::vector<Eigen::VectorXd>> window(curves.begin() + first, curves.begin() + i + 1);
+                std::vector<double> window_knots(knots.begin() + first, knots.begin() + i + 2);
+                bezier::CompositeBezierCurve expected(window, window_knots);
+                require_equal(composite, expected);
+                for(int j = 0; j < 1000; j++){
+                    double t = j / 999.0;
+                    REQUIRE(composite.local_param(t).first == expected.local_param(t).first);
+                }
+            }
+        }
+
+        // lowering the limit removes the first curves
+        composite.set_max_number_of_curves(10);
+        std::vector<std::vector<Eigen::VectorXd>> window(curves.end() - 10, curves.end());
+        std::vector<double> window_knots(knots.end() - 11, knots.end());
+        require_equal(composite, bezier::CompositeBezierCurve(window, window_knots));
+    }
 }
 
+#ifdef __GLIBC__
+TEST_CASE("Composite Bezier curve construction without copies", "[allocation]"){
+    std::vector<Eigen::VectorXd> control_points = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    // fill the cache of coefficient matrices
+    bezier::CompositeBezierCurve({control_points});
 
+    SECTION("Bezier curve"){
+        std::vector<Eigen::VectorXd> copy = control_points;
+        long copied = count_heap_allocations([&](){ bezier::BezierCurve cubic(control_points); });
+        long moved = count_heap_allocations([&](){ bezier::BezierCurve cubic(std::move(copy)); });
+        // the vector and its four control points are not copied
+        REQUIRE(copied - moved == 5);
 
+        bezier::BezierCurve cubic(control_points);
+        REQUIRE(count_heap_allocations([&](){ bezier::BezierCurve other(std::move(cubic)); }) == 0);
+    }
 
+    SECTION("contiguous storage"){
+        for(int number_of_curves : {10, 1000}){
+            Eigen::MatrixXd points = Eigen::MatrixXd::Random(2, 3 * number_of_curves + 1);
+            std::vector<unsigned int> degrees(number_of_curves, 3);
+            bezier::CompositeBezierCurve * composite = nullptr;
+            // independent of the number of curves
+            long allocations = count_heap_allocations([&](){
+                composite = new bezier::CompositeBezierCurve(std::move(points), degrees);
+            });
+            REQUIRE(allocations <= 8);
+            REQUIRE(composite->number_of_curves() == number_of_curves);
+            REQUIRE(count_heap_allocations([&](){ bezier::CompositeBezierCurve other(std::move(*composite)); }) == 0);
+            delete composite;
+        }
+    }
+}
+#endif
@@ -2,6 +2,10 @@
 
 #include <bezier/curve.h>
 #include <bezier/bezier_curve.h>
+#include <bezier/composite_bezier_curve.h>
+#include <bezier/fixed_bezier_curve.h>
+
+#include "allocation_counter.h"
 
 using Eigen::Vector2d;
 using Eigen::VectorXd;
@@ -11,3 +15,136 @@ TEST_CASE("Test curve sampling", "[sample]"){
     std::vector<VectorXd> samples = bezier::sample(&curve, 100);
     REQUIRE(samples.size() == 100);
 }
+
+TEST_CASE("Test curve sampling into matrix", "[sample]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve quartic = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0), Vector2d(5, 1) };
+    bezier::CompositeBezierCurve composite = {cubic1, cubic2, quartic};
+    bezier::CubicBezierCurve2d fixed(cubic1);
+
+    SECTION("invalid dimension"){
+        Eigen::MatrixXd samples(3, 10);
+        REQUIRE_THROWS_AS(bezier::sample(&cubic1, samples), std::invalid_argument);
+    }
+
+    SECTION("agrees with evaluation"){
+        for(const bezier::Curve * curve : std::vector<const bezier::Curve *>{&cubic1, &quartic, &composite, &fixed}){
+            for(int n : {1, 2, 3, 10, 1000}){
+                Eigen::MatrixXd samples(2, n);
+                bezier::sample(curve, samples);
+                Eigen::VectorXd params = Eigen::VectorXd::LinSpaced(n, 0, 1);
+                for (int j = 0; j < n; ++j) {
+                    REQUIRE((samples.col(j) - curve->operator()(params(j))).norm() < 1e-12);
+                }
+                REQUIRE(samples.col(n-1) == curve->operator()(1));
+            }
+        }
+    }
+
+    SECTION("evaluation method"){
+        bezier::BezierCurve de_casteljau(quartic.control_points(), bezier::EvaluationMethod::DeCasteljau);
+        Eigen::MatrixXd samples(2, 50);
+        bezier::sample(&de_casteljau, samples);
+        Eigen::VectorXd params = Eigen::VectorXd::LinSpaced(50, 0, 1);
+        for (int j = 0; j < 50; ++j) {
+            REQUIRE(samples.col(j) == de_casteljau(params(j)));
+        }
+    }
+
+    SECTION("sampling into a block"){
+        Eigen::MatrixXd storage = Eigen::MatrixXd::Zero(2, 20);
+        bezier::sample(&composite, storage.middleCols(5, 10));
+        REQUIRE(storage.col(5) == composite(0));
+        REQUIRE(storage.col(14) == composite(1));
+        REQUIRE(storage.col(4) == Vector2d(0, 0));
+        REQUIRE(storage.col(15) == Vector2d(0, 0));
+    }
+}
+
+TEST_CASE("Test curve evaluation into preallocated storage", "[evaluate_into]"){
+    bezier::BezierCurve cubic1 = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurve cubic2 = { Vector2d(2, 3), Vector2d(-1, 3), Vector2d(4, 10), Vector2d(-1, -1) };
+    bezier::BezierCurve quartic = { Vector2d(-1, -1), Vector2d(-1, -3), Vector2d(-2, -2), Vector2d(1, 0), Vector2d(5, 1) };
+    bezier::CompositeBezierCurve composite = {cubic1, cubic2, quartic};
+    bezier::CubicBezierCurve2d fixed(cubic1);
+    std::vector<const bezier::Curve *> curves = {&cubic1, &quartic, &composite, &fixed};
+    Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(11, 0, 1);
+
+    SECTION("invalid arguments"){
+        Eigen::VectorXd point(3);
+        REQUIRE_THROWS_AS(cubic1.evaluate_into(0.5, point), std::invalid_argument);
+        REQUIRE_THROWS_AS(composite.evaluate_into(0.5, point), std::invalid_argument);
+        REQUIRE_THROWS_AS(fixed.evaluate_into(0.5, point), std::invalid_argument);
+        Eigen::MatrixXd points(2, 10);
+        REQUIRE_THROWS_AS(cubic1.evaluate_into(ts, points), std::invalid_argument);
+        Vector2d out;
+        REQUIRE_THROWS_AS(cubic1.evaluate_into(1.5, out), std::domain_error);
+        REQUIRE_THROWS_AS(composite.evaluate_into(-0.5, out), std::domain_error);
+    }
+
+    SECTION("agrees with evaluation"){
+        for(const bezier::Curve * curve : curves){
+            Eigen::MatrixXd points(2, ts.rows());
+            curve->evaluate_into(ts, points);
+            for(long j = 0; j < ts.rows(); j++){
+                Vector2d point;
+                curve->evaluate_into(ts(j), point);
+                REQUIRE(point == curve->operator()(ts(j)));
+                REQUIRE(points.col(j) == curve->operator()(ts(j)));
+            }
+        }
+        for(bezier::EvaluationMethod method : {bezier::EvaluationMethod::DeCasteljau, bezier::EvaluationMethod::Bernstein}){
+            bezier::BezierCurve curve({ Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) }, method);
+            Vector2d point;
+            curve.evaluate_into(0.3, point);
+            REQUIRE(point.isApprox(cubic1(0.3)));
+        }
+    }
+
+#ifdef __GLIBC__
+    SECTION("no heap allocation"){
+        bezier::BezierCurve de_casteljau({ Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) },
+                                         bezier::EvaluationMethod::DeCasteljau);
+        bezier::BezierCurve bernstein({ Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) },
+                                      bezier::EvaluationMethod::Bernstein);
+        curves.push_back(&de_casteljau);
+        curves.push_back(&bernstein);
+
+        Vector2d point;
+        Eigen::MatrixXd points(2, ts.rows());
+        REQUIRE(count_heap_allocations([&](){ VectorXd allocated = cubic1(0.5); }) > 0);
+        for(const bezier::Curve * curve : curves){
+            long allocations = count_heap_allocations([&](){
+                for(long j = 0; j < ts.rows(); j++){
+                    curve->evaluate_into(ts(j), point);
+                }
+                curve->evaluate_into(ts, points);
+            });
+            REQUIRE(allocations == 0);
+        }
+    }
+#endif
+}
+
+TEST_CASE("Test single precision curve sampling", "[sample]"){
+    bezier::BezierCurve cubic = { Vector2d(1, -1), Vector2d(-1, 3), Vector2d(1, 2), Vector2d(2, 3) };
+    bezier::BezierCurvef cubicf = { Eigen::Vector2f(1, -1), Eigen::Vector2f(-1, 3), Eigen::Vector2f(1, 2),
+                                    Eigen::Vector2f(2, 3) };
+    bezier::BezierCurvef cubic2f = { Eigen::Vector2f(2, 3), Eigen::Vector2f(-1, 3), Eigen::Vector2f(4, 10),
+                                     Eigen::Vector2f(-1, -1) };
+    bezier::CompositeBezierCurvef compositef = {cubicf, cubic2f};
+
+    std::vector<Eigen::VectorXf> samples = bezier::sample(&cubicf, 101);
+    std::vector<VectorXd> reference = bezier::sample(&cubic, 101);
+    REQUIRE(samples.size() == 101);
+    for(int j = 0; j < 101; j++){
+        REQUIRE((samples[j].cast<double>() - reference[j]).norm() < 1e-5);
+    }
+
+    Eigen::MatrixXf composite_samples(2, 57);
+    bezier::sample(&compositef, composite_samples);
+    for(long j = 0; j < composite_samples.cols(); j++){
+        REQUIRE((composite_samples.col(j) - compositef(j / 56.0f)).norm() < 1e-5);
+    }
+}
@@ -1,6 +1,13 @@
 #include <catch/catch.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 #include <bezier/fit_composite_bezier_curve.h>
+#include <bezier/math/roots.h>
+#include <bezier/utilities.h>
+
+#include "allocation_counter.h"
 
 using std::vector;
 using Eigen::Vector2d;
@@ -316,8 +323,475 @@ TEST_CASE("Fit with parameterization tests", "[with parameterization]"){
                                                            parameterization,
                                                            curve_degrees,
                                                            closed_curve));
+
+        // same solution as the least squares problem with explicit parameterization matrices T
+        // and the control points of each curve given by the unknowns through the continuity conditions
+        vector<Eigen::MatrixXd> selections(3);
+        selections[0] = Eigen::MatrixXd::Identity(4, 9);
+        selections[1] = Eigen::MatrixXd::Zero(4, 9);
+        selections[1](0, 3) = 1;
+        selections[1](1, 2) = -1;
+        selections[1](1, 3) = 2;
+        selections[1].block(2, 4, 2, 2).setIdentity();
+        selections[2] = Eigen::MatrixXd::Zero(5, 9);
+        selections[2](0, 5) = 1;
+        selections[2](1, 4) = -1;
+        selections[2](1, 5) = 2;
+        selections[2].block(2, 6, 3, 3).setIdentity();
+        Eigen::MatrixXd a(11, 9), d(11, 3);
+        long row = 0;
+        for(int i = 0; i < 3; i++){
+            Eigen::MatrixXd t(data_points[i].size(), curve_degrees[i] + 1);
+            for(int j = 0; j < data_points[i].size(); j++){
+                for(int k = 0; k < curve_degrees[i] + 1; k++){
+                    t(j, k) = std::pow(parameterization[i][j], k);
+                }
+                d.row(row + j) = data_points[i][j].transpose();
+            }
+            a.middleRows(row, t.rows()) = t * bezier::bezier_coefficients(curve_degrees[i]) * selections[i];
+            row += t.rows();
+        }
+        Eigen::MatrixXd unknowns = a.colPivHouseholderQr().solve(d);
+        bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points,
+                                                                                parameterization,
+                                                                                curve_degrees,
+                                                                                closed_curve);
+        long column = 0;
+        for(int i = 0; i < 3; i++){
+            Eigen::MatrixXd expected = (selections[i] * unknowns).transpose();
+            REQUIRE(curve.control_points().middleCols(column, curve_degrees[i] + 1).isApprox(expected, 1e-10));
+            column += curve_degrees[i];
+        }
+    }
+
+
+}
+
+TEST_CASE("Single precision fit", "[float]"){
+    vector<VectorXd> data_points;
+    vector<Eigen::VectorXf> data_pointsf;
+    for(int i = 0; i < 40; i++){
+        double x = i / 39.0 * 6;
+        data_points.push_back(Vector2d(x, std::sin(x)));
+        data_pointsf.push_back(data_points.back().cast<float>());
+    }
+
+    bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, {13, 26}, 3, false);
+    bezier::CompositeBezierCurvef curvef = bezier::fit_composite_bezier_curve(data_pointsf, {13, 26}, 3, false);
+
+    vector<double> parameterization = bezier::chordlength_parameterization(data_pointsf);
+    REQUIRE(parameterization.back() == 1);
+
+    REQUIRE(curvef.bezier_curves().size() == 3);
+    for(double t : {0.0, 0.2, 0.5, 0.8, 1.0}){
+        REQUIRE((curvef(static_cast<float>(t)).cast<double>() - curve(t)).norm() < 1e-4);
+    }
+}
+
+TEST_CASE("Fit with chord length knots", "[knots]"){
+    // the data points are denser in the first curve
+    vector<VectorXd> data_points;
+    for(int i = 0; i < 10; i++){
+        data_points.push_back(Vector2d(i / 9.0, 0));
+    }
+    for(int i = 1; i < 10; i++){
+        data_points.push_back(Vector2d(1 + 3 * i / 9.0, 0));
+    }
+
+    vector<vector<VectorXd>> partitions = {vector<VectorXd>(data_points.begin(), data_points.begin() + 10),
+                                           vector<VectorXd>(data_points.begin() + 10, data_points.end())};
+    vector<double> knots = bezier::chordlength_knots(partitions, false);
+    REQUIRE(knots.size() == 3);
+    REQUIRE(knots[0] == 0);
+    REQUIRE(knots[1] == Approx(1));
+    REQUIRE(knots[2] == Approx(4));
+
+    bezier::CompositeBezierCurve uniform = bezier::fit_composite_bezier_curve(data_points, {9}, 3, false);
+    bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, {9}, 3, false,
+                                                                            bezier::Knots::ChordLength);
+    REQUIRE(uniform.has_uniform_knots());
+    REQUIRE(!curve.has_uniform_knots());
+    REQUIRE(curve.knots()[1] == Approx(0.25));
+
+    // same control points, only the global parameter of the joint moves
+    REQUIRE(curve.control_points().isApprox(uniform.control_points()));
+    for(double s : {0.0, 0.1, 0.5, 0.9}){
+        REQUIRE(curve(0.25 * s).isApprox(uniform(0.5 * s)));
+        REQUIRE(curve(0.25 + 0.75 * s).isApprox(uniform(0.5 + 0.5 * s)));
+    }
+}
+
+// sum of squared distances between the data points and the curve at their parameters
+double squared_error(const bezier::CompositeBezierCurve & curve, const vector<vector<VectorXd>> & data_points,
+                     const vector<vector<double>> & parameterization){
+    double error = 0;
+    for(unsigned int i = 0; i < data_points.size(); i++){
+        for(unsigned int j = 0; j < data_points[i].size(); j++){
+            error += (curve.segment(i)(parameterization[i][j]) - data_points[i][j]).squaredNorm();
+        }
+    }
+    return error;
+}
+
+TEST_CASE("Fit with parameter correction", "[correction]"){
+    // unevenly spaced samples, such that the chord length parameterization is poor
+    vector<vector<VectorXd>> data_points(4);
+    for(int i = 0; i < 4; i++){
+        for(int j = i == 0 ? 0 : 1; j < 30; j++){
+            double s = (j / 29.0) * (j / 29.0);
+            double x = (i + s) * 1.5;
+            data_points[i].push_back(Vector2d(x, std::sin(x)));
+        }
+    }
+    vector<int> degrees(4, 3);
+    vector<vector<double>> initial = bezier::initialize_parameterization(data_points, false);
+    bezier::CompositeBezierCurve plain = bezier::fit_composite_bezier_curve(data_points, initial, degrees, false);
+
+    SECTION("no iterations"){
+        bezier::ParameterCorrection correction;
+        correction.max_iterations = 0;
+        vector<vector<double>> parameterization = initial;
+        bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, parameterization, degrees,
+                                                                                false, bezier::Knots::Uniform,
+                                                                                correction);
+        REQUIRE(parameterization == initial);
+        REQUIRE(curve.control_points() == plain.control_points());
+    }
+
+    SECTION("error decreases"){
+        double previous = squared_error(plain, data_points, initial);
+        for(unsigned int iterations : {1, 3, 10}){
+            bezier::ParameterCorrection correction;
+            correction.max_iterations = iterations;
+            correction.tolerance = 0;
+            vector<vector<double>> parameterization = initial;
+            bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(
+                    data_points, parameterization, degrees, false, bezier::Knots::Uniform, correction);
+            double error = squared_error(curve, data_points, parameterization);
+            REQUIRE(error < previous);
+            previous = error;
+            for(unsigned int i = 0; i < parameterization.size(); i++){
+                for(double t : parameterization[i]){
+                    REQUIRE(t >= 0);
+                    REQUIRE(t <= 1);
+                    REQUIRE((t > 0 or i == 0));
+                }
+            }
+        }
+        REQUIRE(previous < 0.1 * squared_error(plain, data_points, initial));
+    }
+
+    SECTION("tolerance"){
+        bezier::ParameterCorrection correction;
+        correction.max_iterations = 1000;
+        correction.tolerance = 1e-3;
+        bezier::CompositeBezierCurve loose = bezier::fit_composite_bezier_curve(data_points, degrees, false,
+                                                                                bezier::Knots::Uniform, correction);
+        correction.tolerance = 1e-6;
+        bezier::CompositeBezierCurve tight = bezier::fit_composite_bezier_curve(data_points, degrees, false,
+                                                                                bezier::Knots::Uniform, correction);
+        REQUIRE(!loose.control_points().isApprox(tight.control_points(), 1e-12));
+    }
+
+    SECTION("threads"){
+        bezier::ParameterCorrection correction;
+        correction.number_of_threads = 1;
+        vector<vector<double>> serial_parameterization = initial;
+        bezier::CompositeBezierCurve serial = bezier::fit_composite_bezier_curve(
+                data_points, serial_parameterization, degrees, false, bezier::Knots::Uniform, correction);
+        correction.number_of_threads = 4;
+        vector<vector<double>> parallel_parameterization = initial;
+        bezier::CompositeBezierCurve parallel = bezier::fit_composite_bezier_curve(
+                data_points, parallel_parameterization, degrees, false, bezier::Knots::Uniform, correction);
+        REQUIRE(serial_parameterization == parallel_parameterization);
+        REQUIRE(serial.control_points() == parallel.control_points());
+    }
+
+    SECTION("closed curve"){
+        vector<vector<VectorXd>> circle(3);
+        for(int i = 0; i < 3; i++){
+            for(int j = 1; j < 20; j++){
+                double angle = 2 * M_PI * (i + (j / 19.0) * (j / 19.0)) / 3;
+                circle[i].push_back(Vector2d(std::cos(angle), std::sin(angle)));
+            }
+        }
+        vector<vector<double>> parameterization = bezier::initialize_parameterization(circle, true);
+        bezier::CompositeBezierCurve closed = bezier::fit_composite_bezier_curve(circle, parameterization,
+                                                                                 {3, 3, 3}, true);
+        double error = squared_error(closed, circle, parameterization);
+        bezier::CompositeBezierCurve corrected = bezier::fit_composite_bezier_curve(
+                circle, parameterization, {3, 3, 3}, true, bezier::Knots::Uniform, bezier::ParameterCorrection());
+        REQUIRE(squared_error(corrected, circle, parameterization) < 0.5 * error);
+        REQUIRE(corrected(0) == corrected(1));
+    }
+
+    SECTION("single precision"){
+        vector<vector<Eigen::VectorXf>> data_pointsf;
+        for(const vector<VectorXd> & points : data_points){
+            data_pointsf.push_back(vector<Eigen::VectorXf>());
+            for(const VectorXd & point : points){
+                data_pointsf.back().push_back(point.cast<float>());
+            }
+        }
+        bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(
+                data_points, degrees, false, bezier::Knots::Uniform, bezier::ParameterCorrection());
+        bezier::CompositeBezierCurvef curvef = bezier::fit_composite_bezier_curve(
+                data_pointsf, degrees, false, bezier::Knots::Uniform, bezier::ParameterCorrection());
+        for(double t : {0.0, 0.2, 0.5, 0.8, 1.0}){
+            REQUIRE((curvef(static_cast<float>(t)).cast<double>() - curve(t)).norm() < 1e-3);
+        }
+    }
+}
+
+TEST_CASE("Batch fit", "[batch]"){
+    // noisy circles of different sizes, fitted by curves of different degrees
+    vector<bezier::FitDataset> batch;
+    for(int i = 0; i < 40; i++){
+        bezier::FitDataset dataset;
+        int n = 20 + 7 * (i % 13);
+        for(int j = 0; j < n; j++){
+            double angle = 2 * M_PI * j / n;
+            dataset.data_points.push_back(Vector2d(std::cos(angle) + 3 * i, std::sin(angle))
+                                          + 0.05 * Eigen::Vector2d::Random());
+        }
+        dataset.joints = {n / 2};
+        dataset.curve_degrees = {3 + i % 3};
+        dataset.closed_curve = i % 2 == 0;
+        batch.push_back(dataset);
+    }
+
+    vector<bezier::CompositeBezierCurve> expected;
+    for(const bezier::FitDataset & dataset : batch){
+        expected.push_back(bezier::fit_composite_bezier_curve(dataset.data_points, dataset.joints,
+                                                              dataset.curve_degrees[0], dataset.closed_curve));
+    }
+
+    for(unsigned int threads : {1, 4}){
+        bezier::FitOptions options;
+        options.number_of_threads = threads;
+        vector<bezier::CompositeBezierCurve> curves = bezier::fit_composite_bezier_curves(batch, options);
+        REQUIRE(curves.size() == batch.size());
+        for(int i = 0; i < batch.size(); i++){
+            REQUIRE(curves[i].control_points() == expected[i].control_points());
+        }
+    }
+
+    SECTION("options"){
+        bezier::FitOptions options;
+        options.knots = bezier::Knots::ChordLength;
+        options.correction.max_iterations = 5;
+        vector<bezier::CompositeBezierCurve> curves = bezier::fit_composite_bezier_curves(batch, options);
+        for(int i = 0; i < batch.size(); i += 7){
+            vector<vector<VectorXd>> data_points = bezier::partition_data(batch[i].data_points, batch[i].joints);
+            bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(
+                    data_points, {batch[i].curve_degrees[0], batch[i].curve_degrees[0]}, batch[i].closed_curve,
+                    bezier::Knots::ChordLength, options.correction);
+            REQUIRE(curves[i].control_points() == curve.control_points());
+            REQUIRE(curves[i].knots() == curve.knots());
+        }
+    }
+
+    SECTION("invalid datasets"){
+        REQUIRE(bezier::fit_composite_bezier_curves(vector<bezier::FitDataset>()).empty());
+        batch[17].curve_degrees = {3, 3, 3};
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curves(batch), std::invalid_argument);
+        batch[17].curve_degrees = {3};
+        batch[17].joints = {1000};
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curves(batch), std::invalid_argument);
+        batch[17].joints = {1};
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curves(batch), std::invalid_argument);
+    }
+
+    SECTION("single precision"){
+        vector<bezier::FitDatasetf> batchf(2);
+        for(int i = 0; i < 2; i++){
+            for(const VectorXd & point : batch[i].data_points){
+                batchf[i].data_points.push_back(point.cast<float>());
+            }
+            batchf[i].joints = batch[i].joints;
+            batchf[i].curve_degrees = batch[i].curve_degrees;
+            batchf[i].closed_curve = batch[i].closed_curve;
+        }
+        vector<bezier::CompositeBezierCurvef> curves = bezier::fit_composite_bezier_curves(batchf);
+        for(int i = 0; i < 2; i++){
+            REQUIRE((curves[i].control_points().cast<double>() - expected[i].control_points()).norm() < 1e-3);
+        }
+    }
+}
+
+TEST_CASE("Adaptive fit", "[adaptive]"){
+    vector<VectorXd> data_points;
+    Eigen::MatrixXd points(2, 200);
+    for(int i = 0; i < 200; i++){
+        double x = i / 20.0;
+        data_points.push_back(Vector2d(x, std::sin(x)));
+        points.col(i) = data_points.back();
+    }
+    double tolerance = 1e-2;
+
+    bezier::AdaptiveFit fit = bezier::fit_composite_bezier_curve_adaptive(data_points, tolerance, 3);
+    REQUIRE(!fit.joints.empty());
+    REQUIRE(fit.curve.number_of_curves() == fit.joints.size() + 1);
+    REQUIRE(fit.errors.size() == fit.joints.size() + 1);
+    REQUIRE(std::is_sorted(fit.joints.begin(), fit.joints.end()));
+
+    bezier::CompositeBezierCurve expected = bezier::fit_composite_bezier_curve(data_points, fit.joints, 3, false);
+    REQUIRE(fit.curve.control_points() == expected.control_points());
+
+    long first_point = 0;
+    for(const bezier::SegmentError & error : fit.errors){
+        REQUIRE(error.first_point == first_point);
+        REQUIRE(error.number_of_points >= 4);
+        REQUIRE(error.worst_point >= error.first_point);
+        REQUIRE(error.worst_point < error.first_point + error.number_of_points);
+        REQUIRE(error.max_error <= tolerance);
+        REQUIRE(error.rms_error <= error.max_error);
+        first_point += error.number_of_points;
+    }
+    REQUIRE(first_point == data_points.size());
+    for(const bezier::CompositeBezierCurve::Projection & projection : fit.curve.project(points)){
+        REQUIRE(projection.distance <= tolerance + 1e-12);
+    }
+
+    SECTION("no more curves than evenly spaced joints"){
+        // fewest evenly spaced curves within the tolerance, with the error of a data point measured to its own curve
+        unsigned int evenly_spaced = 1;
+        for(; evenly_spaced < 50; evenly_spaced++){
+            vector<int> joints;
+            for(unsigned int k = 1; k < evenly_spaced; k++){
+                joints.push_back(k * 200 / evenly_spaced - 1);
+            }
+            bezier::CompositeBezierCurve curve = bezier::fit_composite_bezier_curve(data_points, joints, 3, false);
+            double largest = 0;
+            for(unsigned int i = 0; i < evenly_spaced; i++){
+                int first = i == 0 ? 0 : joints[i - 1] + 1;
+                int last = i + 1 < evenly_spaced ? joints[i] : 199;
+                for(int j = first; j <= last; j++){
+                    largest = std::max(largest, std::sqrt(bezier::closest_point(curve.power_coefficients(i),
+                                                                                points.col(j)).second));
+                }
+            }
+            if(largest <= tolerance){
+                break;
+            }
+        }
+        REQUIRE(fit.curve.number_of_curves() <= evenly_spaced);
+        REQUIRE(fit.searched_curves <= evenly_spaced);
+    }
+
+    SECTION("threads"){
+        for(unsigned int threads : {1, 3}){
+            bezier::FitOptions options;
+            options.number_of_threads = threads;
+            bezier::AdaptiveFit threaded = bezier::fit_composite_bezier_curve_adaptive(data_points, tolerance, 3,
+                                                                                        false, options);
+            REQUIRE(threaded.joints == fit.joints);
+        }
+    }
+
+    SECTION("large tolerance"){
+        bezier::AdaptiveFit single = bezier::fit_composite_bezier_curve_adaptive(data_points, 10.0, 3);
+        REQUIRE(single.joints.empty());
+        REQUIRE(single.curve.number_of_curves() == 1);
+    }
+
+    SECTION("unreachable tolerance"){
+        vector<VectorXd> few(data_points.begin(), data_points.begin() + 60);
+        bezier::AdaptiveFit best = bezier::fit_composite_bezier_curve_adaptive(few, 0.0, 3);
+        double largest = 0;
+        for(const bezier::SegmentError & error : best.errors){
+            REQUIRE(error.number_of_points >= 4);
+            largest = std::max(largest, error.max_error);
+        }
+        REQUIRE(largest > 0);
+        REQUIRE(best.curve.number_of_curves() == best.joints.size() + 1);
+        // no curve can be added once every curve has fewer than twice degree + 1 data points
+        REQUIRE(best.searched_curves <= 15);
     }
 
+    SECTION("gives up at the curves beyond the best fit"){
+        // the data points of a line are fitted up to rounding errors by any number of curves, such that the
+        // best fit is found early and the search gives up at the limit
+        vector<VectorXd> line;
+        for(int i = 0; i < 400; i++){
+            line.push_back(Vector2d(0.01 * i, 0.02 * i));
+        }
+        for(unsigned int max_extra_curves : {0u, 3u, 8u}){
+            bezier::FitOptions options;
+            options.max_extra_curves = max_extra_curves;
+            bezier::AdaptiveFit best = bezier::fit_composite_bezier_curve_adaptive(line, 0.0, 3, false, options);
+            REQUIRE(best.errors[0].max_error > 0);
+            REQUIRE(best.searched_curves == best.curve.number_of_curves() + max_extra_curves + 1);
+        }
+    }
+
+    SECTION("closed curve"){
+        vector<VectorXd> loop;
+        for(int i = 0; i < 120; i++){
+            double angle = 2 * M_PI * i / 120;
+            loop.push_back(Vector2d(std::cos(angle), std::sin(angle) * (1.5 + std::cos(3 * angle))));
+        }
+        bezier::AdaptiveFit closed = bezier::fit_composite_bezier_curve_adaptive(loop, 0.05, 3, true);
+        REQUIRE(closed.joints.size() > 1);
+        for(const bezier::SegmentError & error : closed.errors){
+            REQUIRE(error.max_error <= 0.05);
+        }
+        REQUIRE(closed.curve(0).isApprox(closed.curve(1)));
+    }
 
+    SECTION("options"){
+        bezier::FitOptions options;
+        options.knots = bezier::Knots::ChordLength;
+        options.correction.max_iterations = 3;
+        bezier::AdaptiveFit corrected = bezier::fit_composite_bezier_curve_adaptive(data_points, tolerance, 3,
+                                                                                     false, options);
+        REQUIRE(corrected.curve.knots().size() == corrected.joints.size() + 2);
+        for(const bezier::SegmentError & error : corrected.errors){
+            REQUIRE(error.max_error <= tolerance);
+        }
+    }
+
+    SECTION("single precision"){
+        vector<Eigen::VectorXf> data_pointsf;
+        for(const VectorXd & point : data_points){
+            data_pointsf.push_back(point.cast<float>());
+        }
+        bezier::AdaptiveFitf fitf = bezier::fit_composite_bezier_curve_adaptive(data_pointsf, tolerance, 3);
+        for(const bezier::SegmentError & error : fitf.errors){
+            REQUIRE(error.max_error <= tolerance);
+        }
+    }
+
+    SECTION("invalid arguments"){
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curve_adaptive(data_points, -1.0, 3), std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curve_adaptive(data_points, tolerance, 2), std::invalid_argument);
+        vector<VectorXd> few(data_points.begin(), data_points.begin() + 3);
+        REQUIRE_THROWS_AS(bezier::fit_composite_bezier_curve_adaptive(few, tolerance, 3), std::invalid_argument);
+    }
 }
 
+#ifdef __GLIBC__
+TEST_CASE("Fit without copying the result", "[allocation]"){
+    vector<VectorXd> data_points;
+    vector<int> joints;
+    for(int i = 0; i < 1000; i++){
+        double x = i / 10.0;
+        data_points.push_back(Vector2d(x, std::sin(x)));
+        if(i % 10 == 9 and i != 999){
+            joints.push_back(i);
+        }
+    }
+
+    bezier::CompositeBezierCurve expected = bezier::fit_composite_bezier_curve(data_points, joints, 3, false);
+    bezier::CompositeBezierCurve * curve = nullptr;
+    long allocations = count_heap_allocations([&](){
+        curve = new bezier::CompositeBezierCurve(bezier::fit_composite_bezier_curve(data_points, joints, 3, false));
+    });
+    REQUIRE(curve->control_points() == expected.control_points());
+    delete curve;
+
+    // the normal equations still allocate per curve, but the solution is written into the contiguous storage
+    // of the composite curve and moved out; copying each curve through BezierCurve took about 100
+    REQUIRE(allocations / 100.0 < 75);
+}
+#endif
@@ -0,0 +1,84 @@
+#include <catch/catch.hpp>
+
+#include <bezier/fixed_bezier_curve.h>
+
+using std::vector;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+
+TEST_CASE("Fixed size Bezier curve construction", "[construction]"){
+
+    vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
+    bezier::BezierCurve cubic2d(control_points);
+
+    SECTION("invalid conversion"){
+        REQUIRE_THROWS_AS((bezier::FixedBezierCurve<2, 2>(cubic2d)), std::invalid_argument);
+        REQUIRE_THROWS_AS((bezier::FixedBezierCurve<3, 3>(cubic2d)), std::invalid_argument);
+    }
+
+    SECTION("conversion from Bezier curve"){
+        bezier::CubicBezierCurve2d fixed(cubic2d);
+        REQUIRE(fixed.degree() == 3);
+        REQUIRE(fixed.dimension() == 2);
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(fixed.control_points().col(i) == control_points[i]);
+        }
+        REQUIRE((fixed.to_bezier_curve().control_points() == control_points));
+    }
+
+    SECTION("construction from control points"){
+        REQUIRE_THROWS_AS((bezier::CubicBezierCurve2d{Vector2d(1, -1), Vector2d(1, 2)}), std::invalid_argument);
+        bezier::CubicBezierCurve2d fixed = {Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1)};
+        for (int i = 0; i < 4; ++i) {
+            REQUIRE(fixed.control_points().col(i) == control_points[i]);
+        }
+    }
+}
+
+
+TEST_CASE("Fixed size Bezier curve evaluation", "[evaluation]"){
+
+    vector<VectorXd> control_points = { Vector2d(1, -1), Vector2d(1, 2), Vector2d(-2, 1), Vector2d(-2, -1) };
+    bezier::BezierCurve cubic2d(control_points);
+    bezier::CubicBezierCurve2d fixed(cubic2d);
+
+    SECTION("test domain range"){
+        REQUIRE_THROWS_AS(fixed.evaluate(-1), std::domain_error);
+        REQUIRE_THROWS_AS(fixed.evaluate(2), std::domain_error);
+        REQUIRE_NOTHROW(fixed.evaluate(0.5));
+    }
+
+    SECTION("end points"){
+        REQUIRE(fixed.evaluate(0) == Vector2d(1, -1));
+        REQUIRE(fixed.evaluate(1) == Vector2d(-2, -1));
+    }
+
+    SECTION("agrees with Bezier curve"){
+        for(double t : {0.0, 0.1, 0.25, 0.5, 0.75, 1.0}){
+            REQUIRE(fixed.evaluate(t) == cubic2d(t));
+        }
+        Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(7, 0, 1);
+        REQUIRE(fixed.evaluate(ts).isApprox(cubic2d.evaluate(ts)));
+    }
+
+    SECTION("curve inheritance"){
+        const bezier::Curve & curve = fixed;
+        REQUIRE(curve(0.5) == Vector2d(-4, 7)/8);
+        REQUIRE(curve(0.25) == Vector2d(34, 35)/64);
+    }
+
+    SECTION("single precision"){
+        bezier::FixedBezierCurve<3, 2, float> fixedf(cubic2d);
+        REQUIRE(fixedf.evaluate(0.5f) == Eigen::Vector2f(-4, 7)/8);
+        REQUIRE(fixedf(0.25).isApprox(cubic2d(0.25), 1e-6));
+    }
+}
+
+TEST_CASE("Fixed size Bezier curve bounds", "[bounds]"){
+    bezier::FixedBezierCurve<2, 3> quadratic3d = {Vector3d(1, -1, 0), Vector3d(-2, 2, 5), Vector3d(0, 1, -3)};
+    std::array<VectorXd, 2> bounds = quadratic3d.bounds();
+    REQUIRE(bounds[0] == Vector3d(-2, -1, -3));
+    REQUIRE(bounds[1] == Vector3d(1, 2, 5));
+}
@@ -6,6 +6,13 @@
 
 #include <bezier/math/misc.h>
 #include <bezier/math/tridiagonal.h>
+#include <bezier/math/forward_difference.h>
+#include <bezier/math/horner.h>
+#include <bezier/math/roots.h>
+#include <bezier/math/arc_length.h>
+#include <bezier/math/box_tree.h>
+#include <bezier/math/subdivision.h>
+#include <bezier/math/power_sums.h>
 
 using Eigen::MatrixXd;
 using Eigen::Matrix2d;
@@ -28,6 +35,390 @@ TEST_CASE("Factorial tests", "[factorial]"){
 
 
 
+TEST_CASE("Binomial coefficient tests", "[binomial]"){
+
+    SECTION("test domain"){
+        REQUIRE_NOTHROW(bezier::binomial_coefficients(0));
+        REQUIRE_THROWS_AS(bezier::binomial_coefficients(-1), std::domain_error);
+    }
+
+    SECTION("test evaluation"){
+        REQUIRE((bezier::binomial_coefficients(0) == std::vector<double>{1}));
+        REQUIRE((bezier::binomial_coefficients(4) == std::vector<double>{1, 4, 6, 4, 1}));
+        std::vector<double> row = bezier::binomial_coefficients(30);
+        REQUIRE(row[15] == 155117520);
+        REQUIRE(row[1] == 30);
+    }
+}
+
+
+TEST_CASE("Forward difference tests", "[forwarddifference]"){
+
+    // p(t) = (1 - 2t + 3t^2 - t^3, 4t - t^2)
+    MatrixXd power_coefficients(2, 4);
+    power_coefficients << 1, -2, 3, -1,
+                          0,  4, -1, 0;
+    auto p = [](double t){ return Eigen::Vector2d(1 - 2*t + 3*t*t - t*t*t, 4*t - t*t); };
+
+    SECTION("test invalid arguments"){
+        MatrixXd samples(3, 10);
+        REQUIRE_THROWS_AS(bezier::forward_difference(power_coefficients, 0, 0.1, samples), std::invalid_argument);
+        samples.resize(2, 10);
+        REQUIRE_THROWS_AS(bezier::forward_difference(power_coefficients, 0, 0.1, samples, 0), std::invalid_argument);
+    }
+
+    SECTION("test evaluation"){
+        for(int reanchor_interval : {1, 3, 32}){
+            MatrixXd samples(2, 1001);
+            bezier::forward_difference(power_coefficients, -0.5, 0.002, samples, reanchor_interval);
+            for (int j = 0; j < samples.cols(); ++j) {
+                REQUIRE((samples.col(j) - p(-0.5 + j * 0.002)).norm() < 1e-13);
+            }
+        }
+    }
+
+    SECTION("test drift without re-anchoring"){
+        MatrixXd samples(2, 1001);
+        bezier::forward_difference(power_coefficients, -0.5, 0.002, samples, 100000);
+        REQUIRE((samples.col(1000) - p(1.5)).norm() < 1e-11);
+    }
+
+    SECTION("single precision"){
+        Eigen::MatrixXf samples(2, 1001);
+        bezier::forward_difference(power_coefficients.cast<float>(), -0.5f, 0.002f, samples);
+        for (int j = 0; j < samples.cols(); ++j) {
+            REQUIRE((samples.col(j).cast<double>() - p(-0.5 + j * 0.002)).norm() < 1e-4);
+        }
+    }
+
+    SECTION("constant"){
+        MatrixXd samples(2, 5);
+        bezier::forward_difference(Eigen::Vector2d(3, 4), 0, 0.25, samples);
+        for (int j = 0; j < samples.cols(); ++j) {
+            REQUIRE(samples.col(j) == Eigen::Vector2d(3, 4));
+        }
+    }
+}
+
+
+TEST_CASE("Horner tests", "[horner]"){
+
+    // p(t) = (1 - 2t + 3t^2 - t^3, 4t - t^2)
+    MatrixXd power_coefficients(2, 4);
+    power_coefficients << 1, -2, 3, -1,
+                          0,  4, -1, 0;
+    Eigen::VectorXd out(2);
+    for(double t : {-1.0, 0.0, 0.3, 1.0, 2.5}){
+        bezier::horner(power_coefficients, t, out);
+        REQUIRE(out.isApprox(Eigen::Vector2d(1 - 2*t + 3*t*t - t*t*t, 4*t - t*t)));
+        bezier::horner(power_coefficients, t, out, 1);
+        REQUIRE((out - Eigen::Vector2d(-2 + 6*t - 3*t*t, 4 - 2*t)).norm() < 1e-12);
+        bezier::horner(power_coefficients, t, out, 2);
+        REQUIRE((out - Eigen::Vector2d(6 - 6*t, -2)).norm() < 1e-12);
+        bezier::horner(power_coefficients, t, out, 3);
+        REQUIRE(out == Eigen::Vector2d(-6, 0));
+        bezier::horner(power_coefficients, t, out, 4);
+        REQUIRE(out == Eigen::Vector2d(0, 0));
+    }
+}
+
+TEST_CASE("Curvature tests", "[curvature]"){
+    // circle of radius 2
+    REQUIRE(bezier::curvature(Eigen::Vector2d(0, 2), Eigen::Vector2d(-2, 0)) == Approx(0.5));
+    REQUIRE(bezier::curvature(Eigen::Vector3d(1, 1, 0), Eigen::Vector3d(2, 2, 0)) == 0);
+    REQUIRE(std::isinf(bezier::curvature(Eigen::Vector2d(0, 0), Eigen::Vector2d(1, 0))));
+    REQUIRE(bezier::curvature(Eigen::Vector2f(0, 2), Eigen::Vector2f(-2, 0)) == Approx(0.5f));
+}
+
+TEST_CASE("Batch Horner tests", "[horner]"){
+
+    std::string instruction_set = bezier::horner_batch_instruction_set();
+    REQUIRE((instruction_set == "avx2" or instruction_set == "sse2" or instruction_set == "scalar"));
+
+    // p(t) = (1 - 2t + 3t^2 - t^3, 4t - t^2)
+    MatrixXd power_coefficients(2, 4);
+    power_coefficients << 1, -2, 3, -1,
+                          0,  4, -1, 0;
+    Eigen::VectorXd ts = Eigen::VectorXd::LinSpaced(13, -1, 2);
+    MatrixXd out = MatrixXd::Zero(15, 2);
+    bezier::horner_batch(power_coefficients.data(), 2, 3, ts.data(), ts.rows(), out.data(), out.rows());
+    for (int j = 0; j < ts.rows(); ++j) {
+        double t = ts(j);
+        REQUIRE(out(j, 0) == Approx(1 - 2*t + 3*t*t - t*t*t));
+        REQUIRE(out(j, 1) == Approx(4*t - t*t));
+    }
+    REQUIRE(out(13, 0) == 0);
+    REQUIRE(out(14, 1) == 0);
+
+    // enough parameters for all of the single precision kernel's loops
+    Eigen::MatrixXf power_coefficientsf = power_coefficients.cast<float>();
+    Eigen::VectorXf tsf = Eigen::VectorXf::LinSpaced(29, -1, 2);
+    Eigen::MatrixXf outf(29, 2);
+    bezier::horner_batch(power_coefficientsf.data(), 2, 3, tsf.data(), tsf.rows(), outf.data(), outf.rows());
+    for (int j = 0; j < tsf.rows(); ++j) {
+        float t = tsf(j);
+        REQUIRE(outf(j, 0) == Approx(1 - 2*t + 3*t*t - t*t*t).epsilon(1e-5).margin(1e-5));
+        REQUIRE(outf(j, 1) == Approx(4*t - t*t).epsilon(1e-5).margin(1e-5));
+    }
+}
+
+
+TEST_CASE("Polynomial root tests", "[roots]"){
+
+    REQUIRE_THROWS_AS(bezier::polynomial_roots(Eigen::VectorXd(0), 0, 1), std::invalid_argument);
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector2d(1, 0), -10, 10).empty());
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector2d(0, 0), -10, 10).empty());
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector2d(-1, 2), 0, 1) == std::vector<double>({0.5}));
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector2d(-1, 2), 0.6, 1).empty());
+
+    // (t - 0.25)(t - 0.5), the leading zero is ignored
+    std::vector<double> roots = bezier::polynomial_roots(Eigen::Vector4d(0.125, -0.75, 1, 0), 0, 1);
+    REQUIRE(roots.size() == 2);
+    REQUIRE(roots[0] == Approx(0.25));
+    REQUIRE(roots[1] == Approx(0.5));
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector3d(0.125, -0.75, 1), 0.3, 1).size() == 1);
+    REQUIRE(bezier::polynomial_roots(Eigen::Vector3d(1, 0, 1), -10, 10).empty());
+
+    // (t + 0.5)(t - 0.1)(t - 0.2)(t - 0.7)(t - 0.9), roots at the ends of the interval are included
+    Eigen::VectorXd coefficients = Eigen::VectorXd::Zero(6);
+    coefficients(0) = 1;
+    for(double root : {-0.5, 0.1, 0.2, 0.7, 0.9}){
+        Eigen::VectorXd shifted = Eigen::VectorXd::Zero(6);
+        shifted.tail(5) = coefficients.head(5);
+        coefficients = shifted - root * coefficients;
+    }
+    roots = bezier::polynomial_roots(coefficients, 0.1, 1);
+    REQUIRE(roots.size() == 4);
+    std::vector<double> expected = {0.1, 0.2, 0.7, 0.9};
+    for(int i = 0; i < 4; i++){
+        REQUIRE(roots[i] == Approx(expected[i]).margin(1e-12));
+    }
+    REQUIRE(bezier::polynomial_roots(coefficients, -1, 1).size() == 5);
+}
+
+TEST_CASE("Polynomial bounds tests", "[roots]"){
+
+    // p(t) = (1 - 2t + 3t^2 - t^3, 4t - t^2)
+    MatrixXd power_coefficients(2, 4);
+    power_coefficients << 1, -2, 3, -1,
+                          0,  4, -1, 0;
+    Eigen::VectorXd lower(2), upper(2);
+    // the first coordinate has a minimum at 1 - sqrt(1/3), the second one a maximum at 2
+    bezier::polynomial_bounds(power_coefficients, 0, 1, lower, upper);
+    double t_min = 1 - std::sqrt(1 / 3.0);
+    REQUIRE(lower(0) == Approx(1 - 2*t_min + 3*t_min*t_min - t_min*t_min*t_min));
+    REQUIRE(upper(0) == Approx(1));
+    bezier::polynomial_bounds(power_coefficients, 0, 3, lower, upper);
+    REQUIRE(lower(1) == Approx(0));
+    REQUIRE(upper(1) == Approx(4));
+    bezier::polynomial_bounds(power_coefficients, 0, 0.5, lower, upper);
+    REQUIRE(lower(1) == Approx(0));
+    REQUIRE(upper(1) == Approx(1.75));
+
+    Eigen::MatrixXf power_coefficientsf = power_coefficients.cast<float>();
+    Eigen::VectorXf lowerf(2), upperf(2);
+    bezier::polynomial_bounds(power_coefficientsf, 0.0f, 3.0f, lowerf, upperf);
+    REQUIRE(upperf(1) == Approx(4));
+
+    // constant curve
+    bezier::polynomial_bounds(Eigen::Vector2d(1, 2), 0, 1, lower, upper);
+    REQUIRE(lower == Eigen::Vector2d(1, 2));
+    REQUIRE(upper == Eigen::Vector2d(1, 2));
+}
+
+TEST_CASE("Closest point tests", "[roots]"){
+
+    // p(t) = (t, t^2), the closest point to (0, 1) is at t = 1 / sqrt(2)
+    MatrixXd parabola(2, 3);
+    parabola << 0, 1, 0,
+                0, 0, 1;
+    std::pair<double, double> closest = bezier::closest_point(parabola, Eigen::Vector2d(0, 1));
+    REQUIRE(closest.first == Approx(1 / std::sqrt(2)).epsilon(1e-12));
+    REQUIRE(closest.second == Approx(0.75).epsilon(1e-12));
+    // closest at the ends
+    closest = bezier::closest_point(parabola, Eigen::Vector2d(-1, -1));
+    REQUIRE(closest.first == 0);
+    REQUIRE(closest.second == Approx(2));
+    closest = bezier::closest_point(parabola, Eigen::Vector2d(2, 2));
+    REQUIRE(closest.first == 1);
+    REQUIRE(closest.second == Approx(2));
+    // on the curve
+    closest = bezier::closest_point(parabola, Eigen::Vector2d(0.3, 0.09));
+    REQUIRE(closest.first == Approx(0.3).epsilon(1e-12));
+    REQUIRE(closest.second == Approx(0).margin(1e-20));
+
+    Eigen::MatrixXf parabolaf = parabola.cast<float>();
+    closest = bezier::closest_point(parabolaf, Eigen::Vector2f(0, 1));
+    REQUIRE(closest.first == Approx(1 / std::sqrt(2)).epsilon(1e-5));
+}
+
+TEST_CASE("Box tree tests", "[boxtree]"){
+
+    REQUIRE_THROWS_AS(bezier::build_box_tree(MatrixXd(2, 0), MatrixXd(2, 0)), std::invalid_argument);
+    REQUIRE_THROWS_AS(bezier::build_box_tree(MatrixXd::Zero(2, 3), MatrixXd::Zero(3, 3)), std::invalid_argument);
+
+    // unit boxes along the diagonal
+    const long n = 37;
+    MatrixXd lower(2, n), upper(2, n);
+    for(long i = 0; i < n; i++){
+        lower.col(i) = Eigen::Vector2d(i, i);
+        upper.col(i) = Eigen::Vector2d(i + 1, i + 1);
+    }
+    bezier::BoxTree tree = bezier::build_box_tree(lower, upper);
+    REQUIRE(tree.begin.size() == 2 * n - 1);
+    REQUIRE(tree.lower.col(0) == Eigen::Vector2d(0, 0));
+    REQUIRE(tree.upper.col(0) == Eigen::Vector2d(n, n));
+    REQUIRE(bezier::squared_box_distance(tree, 0, Eigen::Vector2d(-1, 2)) == 1);
+    REQUIRE(bezier::squared_box_distance(tree, 0, Eigen::Vector2d(1, 2)) == 0);
+
+    // the distance to a box is the distance to its center minus one half, only boxes which may be
+    // closer than the closest one are visited
+    for(const Eigen::Vector2d & point : {Eigen::Vector2d(10.5, 12.5), Eigen::Vector2d(-3, 40)}){
+        std::vector<long> visited;
+        double best = bezier::nearest_boxes(tree, point, [&](long i){
+            visited.push_back(i);
+            Eigen::Vector2d outside = (lower.col(i) - point).cwiseMax(point - upper.col(i)).cwiseMax(0);
+            return outside.squaredNorm();
+        });
+        double expected = std::numeric_limits<double>::infinity();
+        for(long i = 0; i < n; i++){
+            Eigen::Vector2d outside = (lower.col(i) - point).cwiseMax(point - upper.col(i)).cwiseMax(0);
+            expected = std::min(expected, outside.squaredNorm());
+        }
+        REQUIRE(best == expected);
+        REQUIRE(visited.size() < n / 2);
+    }
+}
+
+TEST_CASE("Subdivision tests", "[subdivision]"){
+
+    // quadratic (0,0), (1,2), (2,0), split at 1/2 is (0,0), (0.5,1), (1,1) and (1,1), (1.5,1), (2,0)
+    MatrixXd points(2, 3);
+    points << 0, 1, 2,
+              0, 2, 0;
+    MatrixXd left(2, 3), right(2, 3);
+    bezier::split_control_points(points, 0.5, left, right);
+    MatrixXd expected_left(2, 3), expected_right(2, 3);
+    expected_left << 0, 0.5, 1,
+                     0, 1,   1;
+    expected_right << 1, 1.5, 2,
+                      1, 1,   0;
+    REQUIRE(left == expected_left);
+    REQUIRE(right == expected_right);
+    MatrixXd wrong_size(2, 2);
+    REQUIRE_THROWS_AS(bezier::split_control_points(points, 0.5, left, wrong_size), std::invalid_argument);
+
+    // degree 2 to 3, Q_1 = 1/3 P_0 + 2/3 P_1 and Q_2 = 2/3 P_1 + 1/3 P_2
+    MatrixXd elevated(2, 4);
+    bezier::elevate_control_points(points, elevated);
+    MatrixXd expected_elevated(2, 4);
+    expected_elevated << 0, 2 / 3.0, 4 / 3.0, 2,
+                         0, 4 / 3.0, 4 / 3.0, 0;
+    REQUIRE((elevated - expected_elevated).norm() < 1e-15);
+    REQUIRE_THROWS_AS(bezier::elevate_control_points(points, wrong_size), std::invalid_argument);
+
+    // reduction inverts elevation, the quadratic is not a line
+    MatrixXd reduced(2, 3);
+    REQUIRE(bezier::reduce_control_points(elevated, reduced) < 1e-14);
+    REQUIRE((reduced - points).norm() < 1e-14);
+    MatrixXd line(2, 2);
+    double error = bezier::reduce_control_points(points, line);
+    REQUIRE(line.col(0) == points.col(0));
+    REQUIRE(line.col(1) == points.col(2));
+    REQUIRE(error == Approx(2));
+    MatrixXd constant(2, 1);
+    REQUIRE_THROWS_AS(bezier::reduce_control_points(points, elevated), std::invalid_argument);
+    REQUIRE_THROWS_AS(bezier::reduce_control_points(points, constant), std::invalid_argument);
+
+    Eigen::MatrixXf leftf(2, 3), rightf(2, 3);
+    bezier::split_control_points(points.cast<float>(), 0.5f, leftf, rightf);
+    REQUIRE(leftf == expected_left.cast<float>());
+}
+
+TEST_CASE("Power sums tests", "[powersums]"){
+
+    // parameterization matrix T with rows (1 t t^2 t^3) and data points D with one row per data point
+    Eigen::VectorXd ts(5);
+    ts << 0, 0.1, 0.4, 0.75, 1;
+    MatrixXd points(2, 5);
+    points << 1, -2, 3, 0.5, 4,
+              2, 1, -1, 3, 0;
+    MatrixXd t(5, 4);
+    for(int i = 0; i < 5; i++){
+        for(int k = 0; k < 4; k++){
+            t(i, k) = std::pow(ts(i), k);
+        }
+    }
+
+    Eigen::VectorXd power_sums = Eigen::VectorXd::Zero(7);
+    MatrixXd weighted_sums = MatrixXd::Zero(2, 4);
+    bezier::accumulate_power_sums(ts.head(2), points.leftCols(2), power_sums, weighted_sums);
+    bezier::accumulate_power_sums(ts.tail(3), points.rightCols(3), power_sums, weighted_sums);
+    REQUIRE(weighted_sums.isApprox((t.transpose() * points.transpose()).transpose(), 1e-14));
+
+    MatrixXd normal_matrix(4, 4);
+    bezier::hankel_normal_matrix(power_sums, 1, normal_matrix);
+    REQUIRE(normal_matrix.isApprox(t.transpose() * t, 1e-14));
+
+    // the parameters 2 t
+    bezier::hankel_normal_matrix(power_sums, 2, normal_matrix);
+    Eigen::DiagonalMatrix<double, 4> scales(1, 2, 4, 8);
+    REQUIRE(normal_matrix.isApprox(scales * t.transpose() * t * scales, 1e-14));
+}
+
+TEST_CASE("Arc length tests", "[length]"){
+
+    // p(t) = (t, t^2) and q(t) = (1 + t, 1 + 2t)
+    MatrixXd parabola(2, 3), line(2, 2);
+    parabola << 0, 1, 0,
+                0, 0, 1;
+    line << 1, 1,
+            1, 2;
+    bezier::ArcLengthTable table;
+    bezier::append_arc_length(parabola, table);
+    bezier::append_arc_length(line, table);
+    double parabola_length = std::sqrt(5) / 2 + std::asinh(2) / 4;
+    REQUIRE(table.offsets.size() == 2);
+    REQUIRE(table.length == Approx(parabola_length + std::sqrt(5)).epsilon(1e-14));
+
+    REQUIRE(bezier::arc_length_at(parabola, table, 0, 0) == 0);
+    REQUIRE(bezier::arc_length_at(parabola, table, 0, 0.5) == Approx(std::sqrt(2) / 4 + std::asinh(1) / 4));
+    REQUIRE(bezier::arc_length_at(line, table, 1, 0.5) == Approx(parabola_length + std::sqrt(5) / 2));
+
+    REQUIRE(bezier::curve_at_arc_length(table, 0) == 0);
+    REQUIRE(bezier::curve_at_arc_length(table, parabola_length + 0.1) == 1);
+    REQUIRE(bezier::curve_at_arc_length(table, 10) == 1);
+    REQUIRE(bezier::curve_at_arc_length(table, 0, 1) == 1);
+    REQUIRE(bezier::param_at_arc_length(parabola, table, 0, std::sqrt(2) / 4 + std::asinh(1) / 4)
+            == Approx(0.5).epsilon(1e-12));
+    REQUIRE(bezier::param_at_arc_length(line, table, 1, parabola_length + std::sqrt(5) / 4)
+            == Approx(0.25).epsilon(1e-12));
+    REQUIRE(bezier::param_at_arc_length(line, table, 1, 10) == 1);
+
+    // the brackets of both curves bound their errors within the tolerance times the length of the control polygon
+    REQUIRE(table.errors.size() == 2);
+    REQUIRE(table.errors[0] > 0);
+    REQUIRE(table.errors[0] <= bezier::arc_length_tolerance * (0.5 + std::sqrt(1.25)));
+    REQUIRE(std::abs(table.lengths[table.offsets[1]] - parabola_length) <= table.errors[0]);
+    REQUIRE(table.errors[1] == Approx(0).margin(1e-15));
+    REQUIRE(table.unconverged == std::vector<unsigned long>({0, 0}));
+
+    // p(t) = (t - 1/3)^2, the speed 2 |t - 1/3| has a kink which is never at the end of a piece
+    MatrixXd kink(1, 3);
+    kink << 1.0 / 9, -2.0 / 3, 1;
+    bezier::ArcLengthTable kink_table;
+    bezier::append_arc_length(kink, kink_table);
+    REQUIRE(kink_table.unconverged[0] == 0);
+    REQUIRE(kink_table.errors[0] <= bezier::arc_length_tolerance);
+    REQUIRE(std::abs(kink_table.length - 5.0 / 9) <= kink_table.errors[0]);
+    REQUIRE(kink_table.length == Approx(5.0 / 9).epsilon(1e-12));
+
+    Eigen::MatrixXf parabolaf = parabola.cast<float>();
+    bezier::ArcLengthTable tablef;
+    bezier::append_arc_length(parabolaf, tablef);
+    REQUIRE(tablef.length == Approx(parabola_length).epsilon(1e-6));
+}
+
 TEST_CASE("Tridiagonal solver tests", "[tridiagonal]"){
 
 
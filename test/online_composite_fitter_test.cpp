@@ -0,0 +1,129 @@
+#include <catch/catch.hpp>
+
+#include <bezier/fit_composite_bezier_curve.h>
+#include <bezier/online_composite_fitter.h>
+
+#include <cmath>
+
+using std::vector;
+using Eigen::Vector2d;
+using Eigen::Vector3d;
+using Eigen::VectorXd;
+
+// samples of a smooth planar curve with a small deterministic perturbation
+vector<VectorXd> online_data_points(int n){
+    vector<VectorXd> data_points;
+    for(int i = 0; i < n; i++){
+        double t = 0.1 * i;
+        data_points.push_back(Vector2d(t + 0.01 * std::sin(37.0 * i), std::sin(t) + 0.01 * std::cos(53.0 * i)));
+    }
+    return data_points;
+}
+
+TEST_CASE("Online fit", "[online]"){
+
+    vector<VectorXd> data_points = online_data_points(203);
+
+    SECTION("without frozen curves"){
+        bezier::OnlineCompositeFitter fitter(3, 10, 100);
+        for(int i = 0; i < 53; i++){
+            if(i < 4){
+                REQUIRE_THROWS_AS(fitter.curve(), std::logic_error);
+            }
+            fitter.add_point(data_points[i]);
+        }
+        REQUIRE(fitter.number_of_points() == 53);
+        REQUIRE(fitter.number_of_frozen_curves() == 0);
+        REQUIRE(fitter.number_of_fitted_curves() == 6);
+        REQUIRE_THROWS_AS(fitter.frozen_curve(), std::logic_error);
+
+        vector<VectorXd> batch_points(data_points.begin(), data_points.begin() + 53);
+        bezier::CompositeBezierCurve batch = bezier::fit_composite_bezier_curve(batch_points, {9, 19, 29, 39, 49}, 3,
+                                                                                false);
+        bezier::CompositeBezierCurve online = fitter.curve();
+        REQUIRE(online.number_of_curves() == batch.number_of_curves());
+        REQUIRE((online.control_points() - batch.control_points()).cwiseAbs().maxCoeff() < 1e-9);
+    }
+
+    SECTION("the last curve is fitted once it has enough data points"){
+        bezier::OnlineCompositeFitter fitter(5, 8, 4);
+        for(int i = 0; i < 11; i++){
+            fitter.add_point(data_points[i]);
+        }
+        REQUIRE(fitter.number_of_fitted_curves() == 1);
+        fitter.add_point(data_points[11]);
+        REQUIRE(fitter.number_of_fitted_curves() == 2);
+        REQUIRE((fitter.window_curve()(1) - data_points[11]).norm() < 0.1);
+    }
+
+    SECTION("frozen curves"){
+        bezier::OnlineCompositeFitter fitter(3, 10, 2);
+        for(int i = 0; i < 100; i++){
+            fitter.add_point(data_points[i]);
+        }
+        REQUIRE(fitter.number_of_frozen_curves() == 8);
+        REQUIRE(fitter.number_of_fitted_curves() == 2);
+        Eigen::MatrixXd frozen = fitter.frozen_curve().control_points();
+        for(int i = 100; i < 203; i++){
+            fitter.add_point(data_points[i]);
+        }
+        REQUIRE(fitter.number_of_frozen_curves() == 19);
+        REQUIRE(fitter.frozen_curve().control_points().leftCols(frozen.cols()) == frozen);
+
+        // the window continues the frozen curves with C^1 continuity
+        Eigen::MatrixXd window = fitter.window_curve().control_points();
+        Eigen::MatrixXd all_frozen = fitter.frozen_curve().control_points();
+        long last = all_frozen.cols() - 1;
+        REQUIRE(window.col(0) == all_frozen.col(last));
+        REQUIRE((window.col(1) - window.col(0) - (all_frozen.col(last) - all_frozen.col(last - 1))).norm() < 1e-12);
+
+        bezier::CompositeBezierCurve curve = fitter.curve();
+        REQUIRE(curve.number_of_curves() == 21);
+        Eigen::MatrixXd points(2, data_points.size());
+        for(int i = 0; i < data_points.size(); i++){
+            points.col(i) = data_points[i];
+        }
+        for(const bezier::CompositeBezierCurve::Projection & projection : curve.project(points)){
+            REQUIRE(projection.distance < 0.05);
+        }
+    }
+
+    SECTION("chunks"){
+        bezier::OnlineCompositeFitter single(4, 12, 3);
+        bezier::OnlineCompositeFitter chunked(4, 12, 3);
+        for(int i = 0; i < data_points.size(); i++){
+            single.add_point(data_points[i]);
+        }
+        for(int i = 0; i < data_points.size(); i += 7){
+            long end = std::min<long>(i + 7, data_points.size());
+            chunked.add_points(vector<VectorXd>(data_points.begin() + i, data_points.begin() + end));
+        }
+        chunked.add_points({});
+        REQUIRE(chunked.number_of_frozen_curves() == single.number_of_frozen_curves());
+        REQUIRE(chunked.curve().control_points() == single.curve().control_points());
+    }
+
+    SECTION("single precision"){
+        bezier::OnlineCompositeFitter fitter(3, 10, 3);
+        bezier::OnlineCompositeFitterf fitterf(3, 10, 3);
+        for(const VectorXd & point : data_points){
+            fitter.add_point(point);
+            fitterf.add_point(point.cast<float>());
+        }
+        REQUIRE(fitterf.number_of_frozen_curves() == fitter.number_of_frozen_curves());
+        REQUIRE((fitterf.curve().control_points().cast<double>() - fitter.curve().control_points())
+                        .cwiseAbs().maxCoeff() < 1e-3);
+    }
+
+    SECTION("invalid arguments"){
+        REQUIRE_THROWS_AS(bezier::OnlineCompositeFitter(2, 10, 3), std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::OnlineCompositeFitter(3, 3, 3), std::invalid_argument);
+        REQUIRE_THROWS_AS(bezier::OnlineCompositeFitter(3, 4, 0), std::invalid_argument);
+
+        bezier::OnlineCompositeFitter fitter(3, 10, 3);
+        fitter.add_point(Vector2d(0, 0));
+        REQUIRE_THROWS_AS(fitter.add_point(Vector3d(1, 0, 0)), std::invalid_argument);
+        REQUIRE_THROWS_AS(fitter.add_points({Vector2d(1, 0), Vector3d(1, 0, 0)}), std::invalid_argument);
+        REQUIRE(fitter.number_of_points() == 1);
+    }
+}